@@ -0,0 +1,126 @@
+#pragma once
+
+#include <vector>
+
+// Nivel de detalle de la IA de un agente, segn su distancia y relevancia para el jugador.
+enum class AiTier {
+    Near, // Se oye o puede ver al jugador: se actualiza en cada paso.
+    Mid, // Cerca pero fuera de alcance: cada 'mid_interval' pasos.
+    Far // Lejos: cada 'far_interval' pasos.
+};
+
+// AiScheduler decide en qu pasos de simulacin se actualiza la IA de cada agente. Los agentes cercanos al
+// jugador se actualizan siempre, as su comportamiento no cambia; los lejanos, cada varios pasos, y reciben
+// entonces todo el tiempo acumulado desde su ltima actualizacin (integracin de recuperacin). Cada agente
+// tiene una fase propia dentro de su intervalo, de modo que las actualizaciones reducidas se reparten entre
+// pasos, y a lo sumo 'budget' de ellas se hacen en un mismo paso; las que no entran se postergan, salvo que
+// el agente ya lleve el doble de su intervalo esperando.
+class AiScheduler {
+    public:
+        float near_distance = 9.0f; // Hasta esta distancia al jugador el agente es Near.
+        float mid_distance = 18.0f; // Hasta esta distancia es Mid; ms lejos, Far.
+        int mid_interval = 4;
+        int far_interval = 16;
+        int budget = 8; // Actualizaciones reducidas (Mid y Far) por paso.
+
+        // Registra un agente y devuelve su identificador.
+        int add()
+        {
+            int id;
+            if (!free_ids.empty())
+            {
+                id = free_ids.back();
+                free_ids.pop_back();
+                agents[id] = Agent();
+            }
+            else
+            {
+                id = (int)agents.size();
+                agents.push_back(Agent());
+            }
+            agents[id].phase = next_phase++;
+            agents[id].active = true;
+            return id;
+        }
+
+        void remove(int id)
+        {
+            if (id < 0 || id >= (int)agents.size() || !agents[id].active)
+                return;
+            agents[id].active = false;
+            free_ids.push_back(id);
+        }
+
+        void clear()
+        {
+            agents.clear();
+            free_ids.clear();
+        }
+
+        // Comienza un paso de simulacin: renueva el presupuesto.
+        void begin_step()
+        {
+            step++;
+            budget_left = budget;
+            last_updates = 0;
+            last_deferred = 0;
+        }
+
+        // Acumula 'delta_time' para el agente y decide si se actualiza en este paso. Devuelve el tiempo a integrar
+        // (todo lo acumulado desde su ltima actualizacin) o 0 si debe esperar. 'relevant' fuerza el nivel Near
+        // (por ejemplo, si el agente ve al jugador o lo est atacando).
+        float due(int id, float distance_to_player, bool relevant, float delta_time)
+        {
+            Agent &agent = agents[id];
+            agent.pending += delta_time;
+            agent.waited++;
+
+            AiTier tier = relevant || distance_to_player <= near_distance ? AiTier::Near
+                : distance_to_player <= mid_distance ? AiTier::Mid : AiTier::Far;
+            // Al cambiar de nivel se actualiza enseguida, para que sus indicadores (cerca, ve al jugador) no queden viejos.
+            bool changed = tier != agent.tier;
+            agent.tier = tier;
+
+            if (tier != AiTier::Near && !changed)
+            {
+                int interval = tier == AiTier::Mid ? mid_interval : far_interval;
+                if (agent.waited < interval && (step + agent.phase) % interval != 0)
+                    return 0.0f;
+                if (budget_left <= 0 && agent.waited < 2 * interval)
+                {
+                    last_deferred++;
+                    return 0.0f;
+                }
+                budget_left--;
+            }
+
+            float elapsed = agent.pending;
+            agent.pending = 0.0f;
+            agent.waited = 0;
+            last_updates++;
+            return elapsed;
+        }
+
+        AiTier tier(int id) const { return agents[id].tier; }
+
+        // Actualizaciones hechas y postergadas por falta de presupuesto en el paso en curso.
+        int updates() const { return last_updates; }
+        int deferred() const { return last_deferred; }
+
+    private:
+        struct Agent {
+            AiTier tier = AiTier::Near;
+            float pending = 0.0f; // Tiempo acumulado sin actualizar.
+            int waited = 0; // Pasos desde la ltima actualizacin.
+            unsigned int phase = 0; // Desfase dentro del intervalo, para repartir las actualizaciones.
+            bool active = false;
+        };
+
+        std::vector<Agent> agents;
+        std::vector<int> free_ids;
+        unsigned int step = 0;
+        unsigned int next_phase = 0;
+        int budget_left = 0;
+        int last_updates = 0;
+        int last_deferred = 0;
+};
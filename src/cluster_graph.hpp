@@ -0,0 +1,613 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "grid_search.hpp"
+#include "mygl/profiler.hpp"
+
+// Rectngulo de la grilla que forma un cluster, con los nodos de entrada que hay en su permetro.
+struct Cluster {
+    int row0 = 0, col0 = 0; // Primera casilla (fila, columna).
+    int rows = 0, cols = 0;
+    std::vector<int> nodes; // Nodos del grafo abstracto dentro del cluster.
+};
+
+// Bsqueda en anchura limitada a un cluster. Guarda la distancia y el padre de cada casilla del rectngulo
+// desde una casilla origen, que puede no ser transitable (como en GridSearch). Los arreglos locales tienen
+// un borde de una casilla que se marca como visitado al empezar, as los vecinos se obtienen sumando un
+// desplazamiento, igual que en la Grid, sin comprobar lmites.
+class ClusterBreadth {
+    public:
+        // Recorre el cluster desde 'source' (ndice de la grilla). Si 'target' es mayor o igual a 0, se detiene al alcanzarlo.
+        void run(const Grid &grid, const Cluster &cluster, int source, int target = -1)
+        {
+            grid_stride = grid.stride();
+            local_stride = cluster.cols + 2;
+            corner = grid.index(cluster.row0 - 1, cluster.col0 - 1);
+            origin = source;
+            size_t size = (size_t)local_stride * (cluster.rows + 2);
+            if (stamps.size() < size)
+            {
+                stamps.assign(size, 0);
+                distances.assign(size, 0);
+                parents.assign(size, 0);
+                frontier.assign(size, 0);
+                cells.assign(size, 0);
+                generation = 0;
+            }
+            if (++generation == 0)
+            {
+                std::fill(stamps.begin(), stamps.end(), 0);
+                generation = 1;
+            }
+
+            // El borde local se marca como visitado para que la bsqueda no salga del cluster.
+            int last_row = (cluster.rows + 1) * local_stride;
+            for (int col = 0; col < local_stride; col++)
+            {
+                stamps[col] = generation;
+                stamps[last_row + col] = generation;
+            }
+            for (int row = local_stride; row < last_row; row += local_stride)
+            {
+                stamps[row] = generation;
+                stamps[row + local_stride - 1] = generation;
+            }
+
+            const int local_offsets[4] = { -local_stride, local_stride, -1, 1 };
+            int grid_offsets[4];
+            grid.neighbour_offsets(grid_offsets);
+
+            int start = local(source);
+            int goal = target >= 0 ? local(target) : -1;
+            int head = 0, tail = 0;
+            frontier[tail] = start;
+            cells[tail++] = source;
+            reach(start, start, 0);
+
+            while (head < tail)
+            {
+                int current = frontier[head];
+                int cell = cells[head++];
+                if (current == goal)
+                    break;
+                for (int i = 0; i < 4; i++)
+                {
+                    int next = current + local_offsets[i];
+                    if (stamps[next] == generation || !grid.walkable_at(cell + grid_offsets[i]))
+                        continue;
+                    reach(next, current, distances[current] + 1);
+                    frontier[tail] = next;
+                    cells[tail++] = cell + grid_offsets[i];
+                }
+            }
+        }
+
+        // Distancia desde el origen hasta 'cell' (ndice de la grilla dentro del cluster), o -1 si no se alcanz.
+        int distance(int cell) const
+        {
+            int i = local(cell);
+            return stamps[i] == generation ? distances[i] : -1;
+        }
+
+        // Agrega a 'path' las casillas desde el origen (excluido) hasta 'cell' (incluida), en orden.
+        void append_path_to(const Grid &grid, int cell, std::vector<glm::ivec2> &path) const
+        {
+            size_t first = path.size();
+            for (int i = local(cell); i != local(origin); i = parents[i])
+                path.push_back(grid.cell(global(i)));
+            std::reverse(path.begin() + first, path.end());
+        }
+
+        // Agrega a 'path' las casillas desde 'cell' (excluida) hasta el origen (incluido), en orden.
+        void append_path_from(const Grid &grid, int cell, std::vector<glm::ivec2> &path) const
+        {
+            for (int i = local(cell); i != local(origin); )
+            {
+                i = parents[i];
+                path.push_back(grid.cell(global(i)));
+            }
+        }
+
+    private:
+        int grid_stride = 0, local_stride = 0;
+        int corner = 0; // ndice en la grilla de la esquina del borde local.
+        int origin = 0;
+        std::vector<uint32_t> stamps; // Generacin en la que se alcanz cada casilla local.
+        std::vector<int> distances;
+        std::vector<int> parents;
+        std::vector<int> frontier; // Frontera FIFO en ndices locales...
+        std::vector<int> cells; // ...y los mismos elementos en ndices de la grilla.
+        uint32_t generation = 0;
+
+        // Conversin entre ndices de la grilla e ndices locales del rectngulo con borde.
+        int local(int cell) const
+        {
+            int offset = cell - corner;
+            return (offset / grid_stride) * local_stride + offset % grid_stride;
+        }
+
+        int global(int i) const { return corner + (i / local_stride) * grid_stride + i % local_stride; }
+
+        void reach(int i, int from, int distance)
+        {
+            stamps[i] = generation;
+            parents[i] = from;
+            distances[i] = distance;
+        }
+};
+
+// ClusterGraph es el grafo abstracto de la bsqueda jerrquica (HPA*). La grilla se divide en clusters
+// cuadrados; en cada tramo transitable del borde entre dos clusters vecinos se colocan entradas (una en el
+// centro si el tramo es corto, una en cada extremo si es largo), que forman pares de nodos unidos con costo 1.
+// Dentro de cada cluster se precalcula la distancia entre todos sus nodos. Una bsqueda recorre este grafo,
+// mucho ms chico que la grilla, y luego refina cada tramo con bsquedas dentro de un solo cluster.
+// Cuando cambia una casilla solo se reconstruyen su cluster y los bordes y distancias de sus vecinos.
+// Las consultas no modifican el grafo: varios ClusterSearch pueden usarlo a la vez.
+class ClusterGraph {
+    public:
+        // Arista del grafo abstracto.
+        struct Edge {
+            int to;
+            int cost;
+        };
+
+        // Nodo de entrada: una casilla del permetro de un cluster.
+        struct Node {
+            int cell = -1; // ndice en la grilla.
+            int row = 0, col = 0;
+            int cluster = -1;
+            bool alive = false;
+            std::vector<int> links; // Nodos de los clusters vecinos a un paso.
+            std::vector<Edge> edges; // Nodos del mismo cluster con su distancia.
+        };
+
+        ClusterGraph(int cluster_size = 16) : size(cluster_size) {}
+
+        // Construye el grafo completo para 'grid'.
+        void build(const Grid &grid)
+        {
+            PROFILE_ZONE("ClusterGraph::build");
+            grid_rows = grid.rows();
+            grid_cols = grid.cols();
+            grid_size = grid.size();
+            cluster_rows = (grid_rows + size - 1) / size;
+            cluster_cols = (grid_cols + size - 1) / size;
+
+            clusters.assign((size_t)cluster_rows * cluster_cols, Cluster());
+            for (int cr = 0; cr < cluster_rows; cr++)
+            {
+                for (int cc = 0; cc < cluster_cols; cc++)
+                {
+                    Cluster &cluster = clusters[cr * cluster_cols + cc];
+                    cluster.row0 = cr * size;
+                    cluster.col0 = cc * size;
+                    cluster.rows = std::min(size, grid_rows - cluster.row0);
+                    cluster.cols = std::min(size, grid_cols - cluster.col0);
+                }
+            }
+            nodes.clear();
+            free_nodes.clear();
+            node_at.assign(grid.size(), -1);
+            right_borders.assign(clusters.size(), {});
+            down_borders.assign(clusters.size(), {});
+
+            for (int c = 0; c < (int)clusters.size(); c++)
+            {
+                build_right_border(grid, c);
+                build_down_border(grid, c);
+            }
+            for (int c = 0; c < (int)clusters.size(); c++)
+                build_edges(grid, c);
+        }
+
+        // Vaca el grafo.
+        void clear()
+        {
+            clusters.clear();
+            nodes.clear();
+            free_nodes.clear();
+            node_at.clear();
+            right_borders.clear();
+            down_borders.clear();
+            grid_rows = grid_cols = cluster_rows = cluster_cols = 0;
+            grid_size = 0;
+        }
+
+        // Reconstruye la parte del grafo afectada por un cambio en la casilla (fila, columna): los cuatro
+        // bordes de su cluster y las distancias internas de ese cluster y de sus vecinos.
+        void rebuild(const Grid &grid, int row, int col)
+        {
+            if (!matches(grid) || !grid.in_bounds(row, col))
+                return;
+            PROFILE_ZONE("ClusterGraph::rebuild");
+            int cr = row / size, cc = col / size;
+            int c = cr * cluster_cols + cc;
+            int left = cc > 0 ? c - 1 : -1;
+            int up = cr > 0 ? c - cluster_cols : -1;
+            int right = cc + 1 < cluster_cols ? c + 1 : -1;
+            int down = cr + 1 < cluster_rows ? c + cluster_cols : -1;
+
+            clear_border(right_borders[c]);
+            clear_border(down_borders[c]);
+            if (left >= 0) clear_border(right_borders[left]);
+            if (up >= 0) clear_border(down_borders[up]);
+
+            build_right_border(grid, c);
+            build_down_border(grid, c);
+            if (left >= 0) build_right_border(grid, left);
+            if (up >= 0) build_down_border(grid, up);
+
+            for (int affected : { c, left, up, right, down })
+            {
+                if (affected >= 0)
+                    build_edges(grid, affected);
+            }
+        }
+
+        // Verdadero si el grafo se construy para una grilla de este tamao.
+        bool matches(const Grid &grid) const
+        {
+            return !clusters.empty() && grid_size == grid.size() && grid_rows == grid.rows() && grid_cols == grid.cols();
+        }
+
+        int cluster_of(glm::ivec2 cell) const { return (cell.x / size) * cluster_cols + cell.y / size; }
+        const Cluster& cluster(int c) const { return clusters[c]; }
+        const Node& node(int n) const { return nodes[n]; }
+        int node_capacity() const { return (int)nodes.size(); }
+        int node_count() const { return (int)(nodes.size() - free_nodes.size()); }
+        int cluster_size() const { return size; }
+
+    private:
+        int size;
+        int grid_rows = 0, grid_cols = 0;
+        size_t grid_size = 0;
+        int cluster_rows = 0, cluster_cols = 0;
+        std::vector<Cluster> clusters;
+        std::vector<Node> nodes;
+        std::vector<int> free_nodes; // Nodos eliminados que se pueden reutilizar.
+        std::vector<int> node_at; // Nodo de cada casilla de la grilla, o -1.
+        std::vector<std::vector<std::pair<int, int>>> right_borders; // Entradas entre cada cluster y el de su derecha.
+        std::vector<std::vector<std::pair<int, int>>> down_borders; // Entradas entre cada cluster y el de abajo.
+        ClusterBreadth breadth;
+        std::vector<int> distances; // Distancias entre los nodos del cluster que se est construyendo.
+
+        // Los tramos transitables ms cortos que esto tienen una sola entrada en el centro.
+        static const int long_run = 6;
+
+        // Nodo de la casilla 'cell' del cluster 'c', crendolo si no existe.
+        int node_for(const Grid &grid, int cell, int c)
+        {
+            if (node_at[cell] >= 0)
+                return node_at[cell];
+
+            int n;
+            if (!free_nodes.empty())
+            {
+                n = free_nodes.back();
+                free_nodes.pop_back();
+            }
+            else
+            {
+                n = (int)nodes.size();
+                nodes.push_back(Node());
+            }
+            Node &node = nodes[n];
+            glm::ivec2 position = grid.cell(cell);
+            node.cell = cell;
+            node.row = position.x;
+            node.col = position.y;
+            node.cluster = c;
+            node.alive = true;
+            node.links.clear();
+            node.edges.clear();
+            node_at[cell] = n;
+            clusters[c].nodes.push_back(n);
+            return n;
+        }
+
+        void free_node(int n)
+        {
+            Node &node = nodes[n];
+            std::vector<int> &owner = clusters[node.cluster].nodes;
+            owner.erase(std::find(owner.begin(), owner.end(), n));
+            node_at[node.cell] = -1;
+            node.alive = false;
+            node.edges.clear();
+            free_nodes.push_back(n);
+        }
+
+        static void unlink(Node &node, int other)
+        {
+            auto it = std::find(node.links.begin(), node.links.end(), other);
+            if (it != node.links.end())
+                node.links.erase(it);
+        }
+
+        // Elimina las entradas de un borde. Los nodos que se quedan sin vecinos en otros clusters se liberan.
+        void clear_border(std::vector<std::pair<int, int>> &border)
+        {
+            for (auto &entrance : border)
+            {
+                unlink(nodes[entrance.first], entrance.second);
+                unlink(nodes[entrance.second], entrance.first);
+            }
+            for (auto &entrance : border)
+            {
+                for (int n : { entrance.first, entrance.second })
+                {
+                    if (nodes[n].alive && nodes[n].links.empty())
+                        free_node(n);
+                }
+            }
+            border.clear();
+        }
+
+        // Coloca las entradas de un borde. 'a' y 'b' devuelven las casillas enfrentadas nmero 'i' del tramo.
+        template <typename CellA, typename CellB>
+        void build_border(const Grid &grid, std::vector<std::pair<int, int>> &border, int ca, int cb, int length, CellA a, CellB b)
+        {
+            int run_start = -1;
+            for (int i = 0; i <= length; i++)
+            {
+                bool open = i < length && grid.walkable_at(a(i)) && grid.walkable_at(b(i));
+                if (open && run_start < 0)
+                    run_start = i;
+                if (open || run_start < 0)
+                    continue;
+
+                int run_end = i - 1;
+                if (run_end - run_start + 1 < long_run)
+                {
+                    int middle = (run_start + run_end) / 2;
+                    add_entrance(grid, border, a(middle), ca, b(middle), cb);
+                }
+                else
+                {
+                    add_entrance(grid, border, a(run_start), ca, b(run_start), cb);
+                    add_entrance(grid, border, a(run_end), ca, b(run_end), cb);
+                }
+                run_start = -1;
+            }
+        }
+
+        void add_entrance(const Grid &grid, std::vector<std::pair<int, int>> &border, int cell_a, int ca, int cell_b, int cb)
+        {
+            int na = node_for(grid, cell_a, ca);
+            int nb = node_for(grid, cell_b, cb);
+            nodes[na].links.push_back(nb);
+            nodes[nb].links.push_back(na);
+            border.push_back({ na, nb });
+        }
+
+        void build_right_border(const Grid &grid, int c)
+        {
+            if (c % cluster_cols + 1 >= cluster_cols)
+                return;
+            const Cluster &cluster = clusters[c];
+            int col = cluster.col0 + cluster.cols - 1;
+            build_border(grid, right_borders[c], c, c + 1, cluster.rows,
+                [&](int i) { return grid.index(cluster.row0 + i, col); },
+                [&](int i) { return grid.index(cluster.row0 + i, col + 1); });
+        }
+
+        void build_down_border(const Grid &grid, int c)
+        {
+            if (c / cluster_cols + 1 >= cluster_rows)
+                return;
+            const Cluster &cluster = clusters[c];
+            int row = cluster.row0 + cluster.rows - 1;
+            build_border(grid, down_borders[c], c, c + cluster_cols, cluster.cols,
+                [&](int i) { return grid.index(row, cluster.col0 + i); },
+                [&](int i) { return grid.index(row + 1, cluster.col0 + i); });
+        }
+
+        // Recalcula las distancias entre los nodos del cluster 'c' con una bsqueda en anchura desde cada uno.
+        // Se omiten las aristas a-c cuando algn otro nodo b del cluster est en un camino mnimo entre ellos
+        // (d(a, b) + d(b, c) == d(a, c)): la ruta por b cuesta lo mismo y el grafo queda con menos aristas.
+        void build_edges(const Grid &grid, int c)
+        {
+            const Cluster &cluster = clusters[c];
+            int count = (int)cluster.nodes.size();
+            distances.assign((size_t)count * count, -1);
+            for (int i = 0; i < count; i++)
+            {
+                breadth.run(grid, cluster, nodes[cluster.nodes[i]].cell);
+                for (int j = 0; j < count; j++)
+                    distances[i * count + j] = breadth.distance(nodes[cluster.nodes[j]].cell);
+            }
+
+            for (int i = 0; i < count; i++)
+            {
+                Node &node = nodes[cluster.nodes[i]];
+                node.edges.clear();
+                for (int j = 0; j < count; j++)
+                {
+                    int distance = distances[i * count + j];
+                    if (distance <= 0)
+                        continue;
+                    bool redundant = false;
+                    for (int k = 0; k < count && !redundant; k++)
+                    {
+                        int first = distances[i * count + k], second = distances[k * count + j];
+                        redundant = k != i && k != j && first > 0 && second > 0 && first + second == distance;
+                    }
+                    if (!redundant)
+                        node.edges.push_back({ cluster.nodes[j], distance });
+                }
+            }
+        }
+};
+
+// ClusterSearch es el contexto de una bsqueda jerrquica sobre un ClusterGraph: conecta el inicio y la meta
+// con las entradas de sus clusters, busca con A* en el grafo abstracto y refina el resultado casilla por casilla.
+// Las rutas son casi ptimas (pasan por las entradas). Como GridSearch, reutiliza sus arreglos entre
+// bsquedas y no debe usarse desde dos hilos a la vez.
+class ClusterSearch {
+    public:
+        // Ruta desde 'start' (excluido) hasta 'goal' (incluido) en 'path'. Devuelve su largo, o 0 si no hay ruta.
+        int find_path(const ClusterGraph &graph, const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2> &path)
+        {
+            PROFILE_ZONE("ClusterSearch::find_path");
+            auto started = std::chrono::steady_clock::now();
+            last_stats = SearchStats();
+            path.clear();
+            search(graph, grid, start, goal, path);
+            last_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+            return (int)path.size();
+        }
+
+        // Estadsticas de la ltima bsqueda. 'expanded' cuenta nodos del grafo abstracto.
+        const SearchStats& stats() const { return last_stats; }
+
+    private:
+        ClusterBreadth from_start, from_goal, refine;
+        std::vector<int> cost;
+        std::vector<int> parent;
+        std::vector<uint32_t> visited;
+        std::vector<uint32_t> closed;
+        std::vector<std::vector<int>> open; // Frontera por cubetas de f, como en GridSearch.
+        int open_base = 0, open_bucket = 0, open_used = 0, open_count = 0;
+        std::vector<int> route; // Nodos de la ruta abstracta, desde la meta hacia el inicio.
+        uint32_t generation = 0;
+        SearchStats last_stats;
+
+        void search(const ClusterGraph &graph, const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2> &path)
+        {
+            if (!graph.matches(grid) || !grid.in_bounds(start.x, start.y) || !grid.in_bounds(goal.x, goal.y) || start == goal)
+                return;
+            int start_cell = grid.index(start.x, start.y);
+            int goal_cell = grid.index(goal.x, goal.y);
+            if (!grid.walkable_at(goal_cell))
+                return;
+
+            int start_cluster = graph.cluster_of(start);
+            int goal_cluster = graph.cluster_of(goal);
+
+            // Dentro de un mismo cluster primero se intenta la ruta local.
+            if (start_cluster == goal_cluster)
+            {
+                refine.run(grid, graph.cluster(start_cluster), start_cell, goal_cell);
+                if (refine.distance(goal_cell) >= 0)
+                {
+                    refine.append_path_to(grid, goal_cell, path);
+                    return;
+                }
+            }
+
+            from_start.run(grid, graph.cluster(start_cluster), start_cell);
+            from_goal.run(grid, graph.cluster(goal_cluster), goal_cell);
+            if (!search_abstract(graph, start_cluster, goal_cluster, start, goal))
+                return;
+
+            // Refina cada tramo de la ruta abstracta. Los nodos virtuales de inicio y meta son los dos ltimos ndices.
+            int start_node = graph.node_capacity(), goal_node = start_node + 1;
+            for (int i = (int)route.size() - 1; i > 0; i--)
+            {
+                int a = route[i], b = route[i - 1];
+                if (a == start_node)
+                    from_start.append_path_to(grid, graph.node(b).cell, path);
+                else if (b == goal_node)
+                    from_goal.append_path_from(grid, graph.node(a).cell, path);
+                else if (graph.node(a).cluster != graph.node(b).cluster)
+                    path.push_back({ graph.node(b).row, graph.node(b).col });
+                else
+                {
+                    refine.run(grid, graph.cluster(graph.node(a).cluster), graph.node(a).cell, graph.node(b).cell);
+                    refine.append_path_to(grid, graph.node(b).cell, path);
+                }
+            }
+        }
+
+        // A* sobre el grafo abstracto con dos nodos virtuales: el inicio, unido a las entradas de su cluster que
+        // alcanza, y la meta, alcanzable desde las entradas de su cluster. Deja la ruta en 'route'.
+        bool search_abstract(const ClusterGraph &graph, int start_cluster, int goal_cluster, glm::ivec2 start, glm::ivec2 goal)
+        {
+            int start_node = graph.node_capacity(), goal_node = start_node + 1;
+            size_t count = (size_t)start_node + 2;
+            if (visited.size() < count)
+            {
+                cost.resize(count);
+                parent.resize(count);
+                visited.resize(count, 0);
+                closed.resize(count, 0);
+            }
+            if (++generation == 0)
+            {
+                std::fill(visited.begin(), visited.end(), 0);
+                std::fill(closed.begin(), closed.end(), 0);
+                generation = 1;
+            }
+            for (int i = 0; i < open_used; i++)
+                open[i].clear();
+            open_base = std::abs(start.x - goal.x) + std::abs(start.y - goal.y);
+            open_bucket = open_used = open_count = 0;
+            route.clear();
+
+            auto heuristic = [&](int n) {
+                if (n == goal_node)
+                    return 0;
+                const ClusterGraph::Node &node = graph.node(n);
+                return std::abs(node.row - goal.x) + std::abs(node.col - goal.y);
+            };
+            // La heurstica solo se calcula si el costo mejora.
+            auto relax = [&](int to, int from, int to_cost) {
+                if (visited[to] == generation && cost[to] <= to_cost)
+                    return;
+                int estimate = heuristic(to);
+                visited[to] = generation;
+                cost[to] = to_cost;
+                parent[to] = from;
+                int bucket = std::max(to_cost + estimate - open_base, open_bucket);
+                if (bucket >= (int)open.size())
+                    open.resize(bucket + 1);
+                open[bucket].push_back(to);
+                open_used = std::max(open_used, bucket + 1);
+                open_count++;
+            };
+            for (int n : graph.cluster(start_cluster).nodes)
+            {
+                int distance = from_start.distance(graph.node(n).cell);
+                if (distance >= 0)
+                    relax(n, start_node, distance);
+            }
+
+            while (open_count > 0)
+            {
+                while (open[open_bucket].empty())
+                    open_bucket++;
+                int current = open[open_bucket].back();
+                open[open_bucket].pop_back();
+                open_count--;
+                if (closed[current] == generation)
+                    continue;
+                closed[current] = generation;
+                last_stats.expanded++;
+                if (current == goal_node)
+                    break;
+
+                const ClusterGraph::Node &node = graph.node(current);
+                for (const ClusterGraph::Edge &edge : node.edges)
+                    relax(edge.to, current, cost[current] + edge.cost);
+                for (int link : node.links)
+                    relax(link, current, cost[current] + 1);
+                if (node.cluster == goal_cluster)
+                {
+                    int distance = from_goal.distance(node.cell);
+                    if (distance >= 0)
+                        relax(goal_node, current, cost[current] + distance);
+                }
+            }
+
+            if (visited[goal_node] != generation)
+                return false;
+            for (int n = goal_node; n != start_node; n = parent[n])
+                route.push_back(n);
+            route.push_back(start_node);
+            return true;
+        }
+};
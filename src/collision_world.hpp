@@ -0,0 +1,302 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// Qu representa un cuerpo del mundo de colisiones, para filtrar las consultas.
+enum class BodyTag : uint8_t {
+    Other,
+    Goal, // Meta del nivel.
+    Enemy,
+    Pickup, // Objeto que se recoge al tocarlo.
+    Prop // Objeto slido del mapa (estatua).
+};
+
+// Resultado de un desplazamiento con CollisionWorld::move.
+struct CollisionHit {
+    bool x = false; // Se detuvo contra una pared en el eje x.
+    bool z = false; // Se detuvo contra una pared en el eje z.
+    glm::ivec2 tile = { -1, -1 }; // ltima pared contra la que choc (fila, columna).
+};
+
+// CollisionWorld resuelve colisiones de cajas alineadas a los ejes (en el plano xz) contra las paredes de la
+// grilla y entre cuerpos mviles, sin recorrer todas las paredes: una caja solo consulta las casillas que
+// toca. Cada pared ocupa su casilla entera, de lado 1 y centrada en (columna, fila).
+// Los desplazamientos se resuelven por ejes separados, primero x y despus z: si un eje choca, el otro
+// sigue avanzando y el cuerpo se desliza a lo largo de la pared en lugar de detenerse. En cada eje se
+// barren todas las casillas entre la posicin inicial y la final, as que un paso largo no atraviesa paredes.
+// Los cuerpos (meta, enemigos, objetos) se guardan en listas enlazadas por casilla de la grilla, segn la
+// casilla de su centro. Una consulta recorre las casillas de la caja agrandada por la mitad del cuerpo ms
+// grande, as que su costo depende del rea consultada y no de la cantidad de cuerpos.
+// Las coordenadas son las del mundo: x = columna, z = fila. La grilla se pasa en cada llamada, como en Crowd.
+class CollisionWorld {
+    public:
+        float skin = 1e-3f; // Separacin que se deja entre un cuerpo detenido y la pared.
+
+        // Prepara las listas de cuerpos para una grilla y descarta los cuerpos anteriores.
+        void build(const Grid &grid)
+        {
+            clear();
+            rows = grid.rows();
+            cols = grid.cols();
+            stride = grid.stride();
+            heads.assign(grid.size(), -1);
+        }
+
+        void clear()
+        {
+            heads.clear();
+            bodies.clear();
+            free_bodies.clear();
+            max_half = glm::vec2(0.0f);
+            rows = cols = stride = 0;
+        }
+
+        // Verdadero si la caja de centro 'center' y semilados 'half' se superpone con alguna pared.
+        // Tocar una pared sin entrar en ella no cuenta.
+        bool overlaps_wall(const Grid &grid, glm::vec3 center, glm::vec2 half) const
+        {
+            bool hit = false;
+            for_each_wall(grid, center, half, [&](int, int) { hit = true; return false; });
+            return hit;
+        }
+
+        // Llama a 'visit(fila, columna)' con cada pared que se superpone con la caja, hasta que devuelva falso.
+        template <typename Visit>
+        void for_each_wall(const Grid &grid, glm::vec3 center, glm::vec2 half, Visit &&visit) const
+        {
+            int min_col, max_col, min_row, max_row;
+            span(center.x, half.x, min_col, max_col);
+            span(center.z, half.y, min_row, max_row);
+            for (int row = min_row; row <= max_row; row++)
+                for (int col = min_col; col <= max_col; col++)
+                    if (grid.wall(row, col) && !visit(row, col))
+                        return;
+        }
+
+        // Mueve una caja cuadrada de semilado 'radius' desde 'position' segn 'delta' y devuelve la posicin
+        // final, detenida contra las paredes eje por eje. La altura (y) se suma sin comprobar.
+        glm::vec3 move(const Grid &grid, glm::vec3 position, glm::vec3 delta, float radius, CollisionHit* hit = nullptr) const
+        {
+            PROFILE_ZONE("CollisionWorld::move");
+            CollisionHit result;
+            glm::ivec2 tile;
+            if (delta.x != 0.0f && sweep(grid, position.x, position.z, delta.x, radius, false, tile))
+            {
+                result.x = true;
+                result.tile = tile;
+            }
+            if (delta.z != 0.0f && sweep(grid, position.z, position.x, delta.z, radius, true, tile))
+            {
+                result.z = true;
+                result.tile = tile;
+            }
+            position.y += delta.y;
+            if (hit)
+                *hit = result;
+            return position;
+        }
+
+        // Agrega un cuerpo de centro 'position' y semilados 'half' (en x y z) y devuelve su identificador.
+        // 'user' es un dato libre del dueo del cuerpo (por ejemplo, su entidad).
+        int add_body(glm::vec3 position, glm::vec2 half, BodyTag tag = BodyTag::Other, uint32_t user = 0)
+        {
+            int id;
+            if (!free_bodies.empty())
+            {
+                id = free_bodies.back();
+                free_bodies.pop_back();
+            } else {
+                id = (int)bodies.size();
+                bodies.emplace_back();
+            }
+            Body &body = bodies[id];
+            body.position = position;
+            body.half = half;
+            body.tag = tag;
+            body.user = user;
+            body.alive = true;
+            max_half = glm::max(max_half, half);
+            link(id);
+            return id;
+        }
+
+        // Mueve un cuerpo. Solo toca las listas si cambi de casilla.
+        void move_body(int id, glm::vec3 position)
+        {
+            Body &body = bodies[id];
+            body.position = position;
+            if (cell_of(position) != body.cell)
+            {
+                unlink(id);
+                link(id);
+            }
+        }
+
+        void remove_body(int id)
+        {
+            if (!bodies[id].alive)
+                return;
+            unlink(id);
+            bodies[id].alive = false;
+            free_bodies.push_back(id);
+        }
+
+        glm::vec3 body_position(int id) const { return bodies[id].position; }
+        BodyTag body_tag(int id) const { return bodies[id].tag; }
+        uint32_t body_user(int id) const { return bodies[id].user; }
+
+        // Llama a 'visit(id)' con cada cuerpo cuya caja toca la caja de centro 'center' y semilados 'half'
+        // (los bordes incluidos), hasta que devuelva falso.
+        template <typename Visit>
+        void query(glm::vec3 center, glm::vec2 half, Visit &&visit) const
+        {
+            if (heads.empty())
+                return;
+            glm::vec2 reach = half + max_half;
+            int min_col = clamp_col((int)std::floor(center.x - reach.x + 0.5f));
+            int max_col = clamp_col((int)std::floor(center.x + reach.x + 0.5f));
+            int min_row = clamp_row((int)std::floor(center.z - reach.y + 0.5f));
+            int max_row = clamp_row((int)std::floor(center.z + reach.y + 0.5f));
+            for (int row = min_row; row <= max_row; row++)
+            {
+                for (int col = min_col; col <= max_col; col++)
+                {
+                    for (int id = heads[(row + 1) * stride + col + 1]; id != -1; id = bodies[id].next)
+                    {
+                        const Body &body = bodies[id];
+                        if (std::abs(body.position.x - center.x) <= body.half.x + half.x &&
+                            std::abs(body.position.z - center.z) <= body.half.y + half.y && !visit(id))
+                            return;
+                    }
+                }
+            }
+        }
+
+        // Primer cuerpo con la etiqueta 'tag' que toca la caja, o -1 si no hay.
+        int find_body(glm::vec3 center, glm::vec2 half, BodyTag tag) const
+        {
+            int found = -1;
+            query(center, half, [&](int id) {
+                if (bodies[id].tag != tag)
+                    return true;
+                found = id;
+                return false;
+            });
+            return found;
+        }
+
+    private:
+        struct Body {
+            glm::vec3 position = glm::vec3(0.0f);
+            glm::vec2 half = glm::vec2(0.0f);
+            int cell = -1; // ndice de la casilla en cuya lista est.
+            int prev = -1;
+            int next = -1;
+            uint32_t user = 0;
+            BodyTag tag = BodyTag::Other;
+            bool alive = false;
+        };
+
+        // Casillas [lo, hi] en un eje cuyo interior se superpone con el intervalo abierto (c - h, c + h).
+        static void span(float c, float h, int &lo, int &hi)
+        {
+            lo = (int)std::floor(c - h - 0.5f) + 1;
+            hi = (int)std::ceil(c + h + 0.5f) - 1;
+        }
+
+        // Avanza la coordenada 'c' del eje de movimiento en 'delta', con la coordenada 'other' del otro eje fija,
+        // y la detiene ante la primera fila de casillas con pared. 'along_z' indica si el eje de movimiento es z
+        // (filas) o x (columnas). Las paredes que ya se superponen con la caja no la frenan, para poder salir.
+        bool sweep(const Grid &grid, float &c, float other, float delta, float radius, bool along_z, glm::ivec2 &tile) const
+        {
+            int lo, hi;
+            span(other, radius, lo, hi);
+            auto blocked = [&](int t) {
+                for (int k = lo; k <= hi; k++)
+                {
+                    int row = along_z ? t : k;
+                    int col = along_z ? k : t;
+                    if (grid.wall(row, col))
+                    {
+                        tile = { row, col };
+                        return true;
+                    }
+                }
+                return false;
+            };
+
+            if (delta > 0.0f)
+            {
+                float front = c + radius;
+                int first = (int)std::ceil(front + 0.5f - skin);
+                int last = (int)std::ceil(front + delta + 0.5f) - 1;
+                for (int t = first; t <= last; t++)
+                {
+                    if (blocked(t))
+                    {
+                        c = std::max(c, t - 0.5f - radius - skin);
+                        return true;
+                    }
+                }
+            } else {
+                float front = c - radius;
+                int first = (int)std::floor(front - 0.5f + skin);
+                int last = (int)std::floor(front + delta - 0.5f) + 1;
+                for (int t = first; t >= last; t--)
+                {
+                    if (blocked(t))
+                    {
+                        c = std::min(c, t + 0.5f + radius + skin);
+                        return true;
+                    }
+                }
+            }
+            c += delta;
+            return false;
+        }
+
+        int clamp_col(int col) const { return std::clamp(col, -1, cols); }
+        int clamp_row(int row) const { return std::clamp(row, -1, rows); }
+
+        // ndice de la casilla del centro de 'position'; fuera del mapa, la casilla ms cercana del borde.
+        int cell_of(glm::vec3 position) const
+        {
+            int col = clamp_col((int)std::floor(position.x + 0.5f));
+            int row = clamp_row((int)std::floor(position.z + 0.5f));
+            return (row + 1) * stride + col + 1;
+        }
+
+        void link(int id)
+        {
+            Body &body = bodies[id];
+            body.cell = cell_of(body.position);
+            body.prev = -1;
+            body.next = heads[body.cell];
+            if (body.next != -1)
+                bodies[body.next].prev = id;
+            heads[body.cell] = id;
+        }
+
+        void unlink(int id)
+        {
+            Body &body = bodies[id];
+            if (body.prev != -1) bodies[body.prev].next = body.next;
+            else heads[body.cell] = body.next;
+            if (body.next != -1)
+                bodies[body.next].prev = body.prev;
+        }
+
+        int rows = 0;
+        int cols = 0;
+        int stride = 0;
+        std::vector<int> heads; // Primer cuerpo de cada casilla (mismo orden que la grilla), -1 si no hay.
+        std::vector<Body> bodies;
+        std::vector<int> free_bodies; // Identificadores de cuerpos quitados, para reutilizar.
+        glm::vec2 max_half = glm::vec2(0.0f); // Semilados del cuerpo ms grande agregado.
+};
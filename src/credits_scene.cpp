@@ -4,8 +4,6 @@ CreditsScene::CreditsScene(Context &ctx) : ctx(ctx)
 {
     camera = CameraOrtho(glm::vec3(0.0f, 0.0f, 0.0f), ctx.win_width, ctx.win_height);
 
-    stbi_set_flip_vertically_on_load(true);
-    load_texture("./assets/textures/credits.png", credits_texture);
     shape.transform.scale.x = ctx.win_width;
     shape.transform.scale.y = ctx.win_height;
     credits_shader = Shader("button.vs", "button.fs");
@@ -14,7 +12,7 @@ CreditsScene::CreditsScene(Context &ctx) : ctx(ctx)
 
 void CreditsScene::store_scene_in_ctx()
 {
-    ctx.scenes.push_back(this);
+    ctx.store_scene(this);
 }
 
 void CreditsScene::open_scene() 
@@ -24,12 +22,22 @@ void CreditsScene::open_scene()
 
 void CreditsScene::close_scene() { return; }
 
-void CreditsScene::update()
+// La textura se carga al abrir la escena y se libera al cerrarla.
+void CreditsScene::begin_load()
+{
+    stbi_set_flip_vertically_on_load(true);
+    load_texture("./assets/textures/credits.png", credits_texture);
+}
+
+void CreditsScene::unload()
 {
-    double currentTime = glfwGetTime();
-    deltaTime = currentTime - lastFrame;
-    lastFrame = currentTime;
+    glDeleteTextures(1, &credits_texture);
+}
 
+void CreditsScene::fixed_update(float delta_time) {}
+
+void CreditsScene::update()
+{
     credits_shader.use();
 
     glActiveTexture(GL_TEXTURE0);
@@ -0,0 +1,326 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// Crowd mueve a un grupo de agentes (los enemigos) hacia sus puntos de paso sin que se encimen. Cada paso:
+//  1. Reconstruye un hash espacial uniforme (celdas de 'neighbour_radius') con un ordenamiento por conteo,
+//     de modo que los vecinos de un agente son los de las nueve celdas que lo rodean.
+//  2. Calcula la velocidad deseada de cada agente: ir al punto de paso, separarse de los vecinos y, si dos
+//     agentes se cruzan de frente, mantenerse a su derecha. En un pasillo (paredes a ambos lados) la separacin
+//     solo acta a lo largo del pasillo, para no empujar a nadie contra la pared.
+//  3. Integra velocidades y posiciones en una sola pasada sobre arreglos separados por componente (SoA),
+//     sin saltos, que el compilador puede vectorizar.
+//  4. Saca de las paredes a los agentes que quedaron dentro de una.
+// Las coordenadas son (fila, columna) en casillas, como en la Grid: fila = z, columna = x del mundo.
+class Crowd {
+    public:
+        float agent_radius = 0.2f; // Radio de cada agente frente a las paredes.
+        float neighbour_radius = 0.6f; // Distancia a la que los agentes se separan; tambin el tamao de celda del hash.
+        float separation_weight = 1.5f; // Peso de la separacin frente al avance hacia el punto de paso.
+        float response = 8.0f; // Rapidez con la que la velocidad sigue a la deseada (1/s).
+        float arrive_radius = 0.25f; // Distancia a la que se considera alcanzado el punto de paso.
+
+        // Agrega un agente en 'position' y devuelve su identificador.
+        int add(glm::vec2 position, float max_speed)
+        {
+            int id;
+            if (!free_ids.empty())
+            {
+                id = free_ids.back();
+                free_ids.pop_back();
+            }
+            else
+            {
+                id = (int)slot_of.size();
+                slot_of.push_back(-1);
+            }
+            slot_of[id] = (int)id_of.size();
+            id_of.push_back(id);
+            row.push_back(position.x);
+            col.push_back(position.y);
+            velocity_row.push_back(0.0f);
+            velocity_col.push_back(0.0f);
+            target_row.push_back(position.x);
+            target_col.push_back(position.y);
+            speed.push_back(max_speed);
+            want_row.push_back(0.0f);
+            want_col.push_back(0.0f);
+            return id;
+        }
+
+        // Quita un agente. Su lugar en los arreglos lo ocupa el ltimo, as los arreglos siguen contiguos.
+        void remove(int id)
+        {
+            if (id < 0 || id >= (int)slot_of.size() || slot_of[id] < 0)
+                return;
+            int slot = slot_of[id];
+            int last = (int)id_of.size() - 1;
+            for (std::vector<float>* values : { &row, &col, &velocity_row, &velocity_col, &target_row, &target_col, &speed, &want_row, &want_col })
+            {
+                (*values)[slot] = (*values)[last];
+                values->pop_back();
+            }
+            id_of[slot] = id_of[last];
+            slot_of[id_of[slot]] = slot;
+            id_of.pop_back();
+            slot_of[id] = -1;
+            free_ids.push_back(id);
+        }
+
+        void clear()
+        {
+            for (std::vector<float>* values : { &row, &col, &velocity_row, &velocity_col, &target_row, &target_col, &speed, &want_row, &want_col })
+                values->clear();
+            id_of.clear();
+            slot_of.clear();
+            free_ids.clear();
+        }
+
+        int size() const { return (int)id_of.size(); }
+
+        // Punto de paso del agente. El agente frena al acercarse y se queda en l.
+        void set_target(int id, glm::vec2 target)
+        {
+            target_row[slot_of[id]] = target.x;
+            target_col[slot_of[id]] = target.y;
+        }
+
+        void set_max_speed(int id, float max_speed) { speed[slot_of[id]] = max_speed; }
+
+        // Coloca al agente en 'position', detenido y con ese punto de paso (por ejemplo, si otro cdigo lo mueve).
+        void place(int id, glm::vec2 position)
+        {
+            int slot = slot_of[id];
+            row[slot] = target_row[slot] = position.x;
+            col[slot] = target_col[slot] = position.y;
+            velocity_row[slot] = velocity_col[slot] = 0.0f;
+        }
+
+        glm::vec2 position(int id) const { return { row[slot_of[id]], col[slot_of[id]] }; }
+        glm::vec2 velocity(int id) const { return { velocity_row[slot_of[id]], velocity_col[slot_of[id]] }; }
+
+        // Verdadero si el agente est a menos de 'arrive_radius' de su punto de paso.
+        bool arrived(int id) const
+        {
+            int slot = slot_of[id];
+            float d_row = target_row[slot] - row[slot];
+            float d_col = target_col[slot] - col[slot];
+            return d_row * d_row + d_col * d_col < arrive_radius * arrive_radius;
+        }
+
+        // Avanza a todos los agentes un paso de 'delta_time' segundos.
+        void update(const Grid &grid, float delta_time)
+        {
+            PROFILE_ZONE("Crowd::update");
+            int count = size();
+            if (count == 0)
+                return;
+            build_hash();
+            steer(grid);
+            integrate(delta_time);
+            resolve_walls(grid);
+        }
+
+    private:
+        // Estado de los agentes, un arreglo por componente e indexado por ranura.
+        std::vector<float> row, col; // Posicin.
+        std::vector<float> velocity_row, velocity_col; // Velocidad en casillas por segundo.
+        std::vector<float> target_row, target_col; // Punto de paso.
+        std::vector<float> speed; // Velocidad mxima.
+        std::vector<float> want_row, want_col; // Velocidad deseada en este paso.
+        std::vector<int> id_of; // Identificador del agente de cada ranura.
+        std::vector<int> slot_of; // Ranura de cada identificador, o -1.
+        std::vector<int> free_ids; // Identificadores libres para reutilizar.
+
+        // Hash espacial: las ranuras ordenadas por cubeta, con el comienzo de cada cubeta.
+        std::vector<int> cell_row, cell_col; // Celda de cada agente.
+        std::vector<int> bucket_of; // Cubeta de cada agente.
+        std::vector<int> bucket_start; // Primera entrada de cada cubeta en 'sorted' (ms una entrada final).
+        std::vector<int> sorted; // Ranuras ordenadas por cubeta.
+        std::vector<int> bucket_fill; // Prxima entrada libre de cada cubeta al ordenar.
+        uint32_t bucket_mask = 0;
+
+        uint32_t bucket(int cell_r, int cell_c) const
+        {
+            return ((uint32_t)cell_r * 73856093u ^ (uint32_t)cell_c * 19349663u) & bucket_mask;
+        }
+
+        // Ordenamiento por conteo de las ranuras segn su cubeta. La tabla tiene al menos el doble de cubetas que agentes.
+        void build_hash()
+        {
+            int count = size();
+            uint32_t buckets = 64;
+            while (buckets < 2u * (uint32_t)count)
+                buckets <<= 1;
+            bucket_mask = buckets - 1;
+            bucket_start.assign(buckets + 1, 0);
+            cell_row.resize(count);
+            cell_col.resize(count);
+            bucket_of.resize(count);
+            sorted.resize(count);
+
+            float inverse = 1.0f / neighbour_radius;
+            for (int i = 0; i < count; i++)
+            {
+                cell_row[i] = (int)std::floor(row[i] * inverse);
+                cell_col[i] = (int)std::floor(col[i] * inverse);
+                bucket_of[i] = (int)bucket(cell_row[i], cell_col[i]);
+                bucket_start[bucket_of[i] + 1]++;
+            }
+            for (uint32_t b = 0; b < buckets; b++)
+                bucket_start[b + 1] += bucket_start[b];
+            bucket_fill.assign(bucket_start.begin(), bucket_start.end() - 1);
+            for (int i = 0; i < count; i++)
+                sorted[bucket_fill[bucket_of[i]]++] = i;
+        }
+
+        // Velocidad deseada de cada agente.
+        void steer(const Grid &grid)
+        {
+            int count = size();
+            float radius_squared = neighbour_radius * neighbour_radius;
+            for (int i = 0; i < count; i++)
+            {
+                float max_speed = speed[i];
+                float heading_row = target_row[i] - row[i];
+                float heading_col = target_col[i] - col[i];
+                float distance = std::sqrt(heading_row * heading_row + heading_col * heading_col);
+
+                // Avance: a velocidad mxima, frenando dentro de 'arrive_radius' del punto de paso.
+                float seek_row = 0.0f, seek_col = 0.0f;
+                if (distance > 1e-4f)
+                {
+                    float seek_speed = max_speed * std::min(1.0f, distance / arrive_radius);
+                    seek_row = heading_row / distance * seek_speed;
+                    seek_col = heading_col / distance * seek_speed;
+                }
+
+                // Separacin de los vecinos en las nueve celdas alrededor, ms fuerte cuanto ms cerca.
+                float push_row = 0.0f, push_col = 0.0f;
+                bool head_on = false;
+                for (int a = -1; a <= 1; a++)
+                {
+                    for (int b = -1; b <= 1; b++)
+                    {
+                        int cr = cell_row[i] + a, cc = cell_col[i] + b;
+                        uint32_t key = bucket(cr, cc);
+                        for (int s = bucket_start[key]; s < bucket_start[key + 1]; s++)
+                        {
+                            int j = sorted[s];
+                            // Otra celda puede caer en la misma cubeta: se comprueba la celda.
+                            if (j == i || cell_row[j] != cr || cell_col[j] != cc)
+                                continue;
+                            float away_row = row[i] - row[j];
+                            float away_col = col[i] - col[j];
+                            float d2 = away_row * away_row + away_col * away_col;
+                            if (d2 >= radius_squared || d2 < 1e-8f)
+                                continue;
+                            float d = std::sqrt(d2);
+                            float weight = (neighbour_radius - d) / (neighbour_radius * d);
+                            push_row += away_row * weight;
+                            push_col += away_col * weight;
+                            // De frente: el vecino est delante y viene hacia este agente.
+                            if (away_row * seek_row + away_col * seek_col < 0.0f
+                                && velocity_row[j] * seek_row + velocity_col[j] * seek_col < 0.0f)
+                                head_on = true;
+                        }
+                    }
+                }
+
+                // En un pasillo la separacin solo acta a lo largo de l.
+                int tile_r = (int)std::round(row[i]), tile_c = (int)std::round(col[i]);
+                bool walls_row = grid.wall(tile_r - 1, tile_c) && grid.wall(tile_r + 1, tile_c);
+                bool walls_col = grid.wall(tile_r, tile_c - 1) && grid.wall(tile_r, tile_c + 1);
+                if (walls_row && !walls_col)
+                    push_row = 0.0f;
+                else if (walls_col && !walls_row)
+                    push_col = 0.0f;
+
+                float want_r = seek_row + push_row * separation_weight * max_speed;
+                float want_c = seek_col + push_col * separation_weight * max_speed;
+                // De frente se corre hacia su derecha: (fila, columna) girado un cuarto de vuelta.
+                if (head_on && distance > 1e-4f)
+                {
+                    want_r += -heading_col / distance * 0.5f * max_speed;
+                    want_c += heading_row / distance * 0.5f * max_speed;
+                }
+                // Se limita aqu a la velocidad mxima: al mezclar dos velocidades dentro del lmite (integrate), el
+                // resultado tambin queda dentro, as la pasada de integracin no necesita comparaciones.
+                float want_speed = std::sqrt(want_r * want_r + want_c * want_c);
+                if (want_speed > max_speed)
+                {
+                    want_r *= max_speed / want_speed;
+                    want_c *= max_speed / want_speed;
+                }
+                want_row[i] = want_r;
+                want_col[i] = want_c;
+            }
+        }
+
+        // Acerca la velocidad a la deseada y mueve a los agentes.
+        void integrate(float delta_time)
+        {
+            float blend = std::min(1.0f, response * delta_time);
+            integrate_arrays(size(), blend, delta_time, row.data(), col.data(), velocity_row.data(), velocity_col.data(),
+                want_row.data(), want_col.data());
+        }
+
+        // Una sola pasada sin saltos ni llamadas. Los arreglos van como parmetros __restrict para que el
+        // compilador sepa que no se solapan y pueda vectorizar el bucle.
+        static void integrate_arrays(int count, float blend, float delta_time, float* __restrict pr, float* __restrict pc,
+            float* __restrict vr, float* __restrict vc, const float* __restrict wr, const float* __restrict wc)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                vr[i] += (wr[i] - vr[i]) * blend;
+                vc[i] += (wc[i] - vc[i]) * blend;
+                pr[i] += vr[i] * delta_time;
+                pc[i] += vc[i] * delta_time;
+            }
+        }
+
+        // Empuja fuera de las paredes vecinas a los agentes que se metieron en ellas.
+        void resolve_walls(const Grid &grid)
+        {
+            int count = size();
+            for (int i = 0; i < count; i++)
+            {
+                int tile_r = (int)std::round(row[i]), tile_c = (int)std::round(col[i]);
+                for (int a = -1; a <= 1; a++)
+                {
+                    for (int b = -1; b <= 1; b++)
+                    {
+                        if (!grid.wall(tile_r + a, tile_c + b))
+                            continue;
+                        // Punto de la casilla de pared ms cercano al agente.
+                        float near_r = std::clamp(row[i], tile_r + a - 0.5f, tile_r + a + 0.5f);
+                        float near_c = std::clamp(col[i], tile_c + b - 0.5f, tile_c + b + 0.5f);
+                        float out_r = row[i] - near_r, out_c = col[i] - near_c;
+                        float d2 = out_r * out_r + out_c * out_c;
+                        if (d2 >= agent_radius * agent_radius)
+                            continue;
+                        if (d2 < 1e-12f)
+                        {
+                            // El centro qued dentro de la pared: sale por el lado ms cercano, a lo largo de
+                            // la normal de ese lado.
+                            float in_r = row[i] - (tile_r + a), in_c = col[i] - (tile_c + b);
+                            if (std::abs(in_r) > std::abs(in_c))
+                                row[i] = tile_r + a + (in_r < 0.0f ? -1.0f : 1.0f) * (0.5f + agent_radius);
+                            else
+                                col[i] = tile_c + b + (in_c < 0.0f ? -1.0f : 1.0f) * (0.5f + agent_radius);
+                            continue;
+                        }
+                        float d = std::sqrt(d2);
+                        row[i] += out_r / d * (agent_radius - d);
+                        col[i] += out_c / d * (agent_radius - d);
+                    }
+                }
+            }
+        }
+};
@@ -1,31 +1,27 @@
 #pragma once
 
 #include "mygl/model.hpp" // Incluye la definicin de la clase Model para manejar modelos 3D.
-#include "mygl/clock.hpp" // Incluye la definicin de la clase Clock para manejar el tiempo.
 #include "map.hpp" // Incluye la definicin de la clase Map para interactuar con el mapa del juego.
 #include "breadth.hpp" // Incluye la funcin de bsqueda en anchura para calcular rutas.
 #include "toolbox.hpp" // Herramientas tiles para operaciones matemticas o de sonido.
+#include "mygl/profiler.hpp" // Zonas de perfilado para medir el costo de cada actualizacin.
 
 class Enemy 
 {
-    // Enumeracin para representar las posibles direcciones de movimiento del enemigo.
-    enum Enemy_Movement {
-        FORWARD,
-        BACKWARD,
-        LEFT,
-        RIGHT
-    };
-
     public:
         // Variables booleanas para controlar el estado del enemigo.
         bool scream = false; // Si el enemigo est gritando.
         bool see_player = false; // Si el enemigo ve al jugador.
         bool near_player = false; // Si el enemigo est cerca del jugador.
+        bool heard_player = false; // Si le llega algn ruido del jugador.
+        PathAlgorithm path_algorithm = PathAlgorithm::JumpPoint; // Algoritmo con el que se calculan las rutas.
+        ViewCone view_cone = { 5.0f, glm::radians(60.0f) }; // Alcance y apertura de la vista del enemigo.
 
         // Constructor de la clase Enemy. Inicializa el modelo 3D del enemigo y carga el sonido asociado.
         Enemy(Map &map, Sound &sm) : map(map)
         {
             // Carga y configuracin inicial del modelo 3D y el sonido.
+            PROFILE_ZONE("Enemy::Enemy");
 
             stbi_set_flip_vertically_on_load(false);
             ma_sound_init_from_file(&sm.engine, sf, MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, NULL, &sm.fence, &noise);
@@ -36,44 +32,87 @@ class Enemy
             model.transform.scale *= 0.1f;
 
             path_pos = tile_pos(model.transform.position);
+            agent = map.crowd.add({ model.transform.position.z, model.transform.position.x }, movement_speed);
+            ai_agent = map.ai.add();
+        }
+
+        // Destructor: libera el sonido y los recursos OpenGL del modelo.
+        ~Enemy()
+        {
+            map.crowd.remove(agent);
+            map.ai.remove(ai_agent);
+            map.routes.cancel(route_ticket);
+            ma_sound_uninit(&noise);
+            model.release();
         }
 
-        // Funcin para renderizar el modelo 3D del enemigo.
-        void render(Shader shader, Camera3D &camera){ model.draw(shader, camera); }
+        // Funcin para renderizar el modelo 3D del enemigo, interpolando su transformacin entre pasos de simulacin.
+        void render(Shader shader, Camera3D &camera, float alpha)
+        {
+            Transform simulated = model.transform;
+            model.transform = simulated.interpolated(alpha);
+            model.draw(shader, camera);
+            model.transform = simulated;
+        }
 
         // Funcin para inicializar o reiniciar el estado del enemigo.
         void init()
         {
             // Configuracin inicial del enemigo, incluyendo posicin, velocidad, y ruta de movimiento.
-            
-            clock.reset();
+
             front = glm::vec3(0.0f, 0.0f, 1.0f);
             model.transform.position = map.enemy_start_position;
             model.transform.rotation.y = 0.0f;
-            choose_direction = false;
+            model.transform.snap();
             see_player = false;
             near_player = false;
+            heard_player = false;
             scream = false;
+            investigating = false;
             movement_speed = 0.3f;
             it = 0;
             path_pos = tile_pos(model.transform.position);
-            path.clear();
-            path = breadth(map, path_pos, map.random_walkable_pos());
-            if (path.empty())
+            map.crowd.place(agent, { model.transform.position.z, model.transform.position.x });
+            map.crowd.set_max_speed(agent, movement_speed);
+            map.routes.cancel(route_ticket);
+            next_ready = false;
+            nav_path.clear();
+            if (!map.grid.empty())
             {
-                path = breadth(map, path_pos, map.random_walkable_pos());
+                find_route(map.random_reachable_pos(path_pos));
+                request_next_route();
             }
             ma_sound_start(&noise);
             ma_sound_set_looping(&noise, true);
         }
 
-        // Funcin para actualizar el estado y la posicin del enemigo cada frame.
-        void update()
+        // Funcin para avanzar el estado del enemigo un paso fijo de simulacin. El enemigo elige su punto de
+        // paso; el desplazamiento lo hace despus la multitud del mapa junto con los dems agentes (ver apply_steering).
+        // Lejos del jugador el planificador de IA del mapa saltea pasos: la actualizacin siguiente recibe todo el
+        // tiempo acumulado.
+        void update(float delta_time)
         {
             // Actualiza la posicin del enemigo, detecta al jugador, y ajusta el movimiento basado en la ruta calculada.
+            PROFILE_ZONE("Enemy::update");
 
-            clock.update();
+            model.transform.store_previous();
+            float distance_to_player = glm::distance(model.transform.position, map.player_position);
+            delta_time = map.ai.due(ai_agent, distance_to_player, scream || near_player || see_player || heard_player, delta_time);
+            if (delta_time <= 0.0f)
+                return;
+
+            step_time = delta_time;
             update_sound_position();
+            if (map.grid.empty() && !scream)
+            {
+                // Nivel sin grilla de texto: las rutas salen de la malla de navegacin. La percepcin es la misma.
+                listen();
+                follow_nav_path();
+                map.enemy_position = model.transform.position;
+                detect_player();
+                return;
+            }
+            take_next_route();
 
             if (scream == true)
             {
@@ -82,25 +121,53 @@ class Enemy
                 {
                     move_forward();
                 }
+                map.crowd.place(agent, { model.transform.position.z, model.transform.position.x });
                 return;
             }
 
-            if (it < path.size() - 1) {
-                compute_direction();
-            } else {
-                path = breadth(map, path_pos, map.random_walkable_pos());
-                if (path.empty())
-                {
-                    path = breadth(map, path_pos, map.random_walkable_pos());
-                }
-                choose_direction = false;
+            listen();
+            if (it < path.size()) {
+                follow_path();
+            } else if (next_ready) {
+                // La prxima ruta se pidi al empezar esta, as que normalmente ya est lista al llegar.
+                path.swap(next_path);
+                next_ready = false;
                 it = 0;
+                request_next_route();
+            } else if (route_ticket == 0) {
+                request_next_route();
             }
             
             map.enemy_position = model.transform.position;
             detect_player();
         }
 
+        // Toma la posicin calculada por la multitud del mapa y orienta el modelo segn su velocidad.
+        // Se llama despus de Crowd::update en cada paso.
+        void apply_steering()
+        {
+            if (scream)
+                return;
+            glm::vec2 position = map.crowd.position(agent);
+            glm::vec2 velocity = map.crowd.velocity(agent);
+            model.transform.position.z = position.x;
+            model.transform.position.x = position.y;
+            if (glm::length(velocity) > 1e-3f)
+            {
+                front = glm::normalize(glm::vec3(velocity.y, 0.0f, velocity.x));
+                model.transform.rotation.y = atan2(front.x, front.z);
+            }
+            if (map.grid.empty())
+            {
+                // La multitud mueve en el plano; la altura sale de la malla de navegacin.
+                glm::vec3 ground;
+                if (map.navmesh.find_nearest(model.transform.position, ground) >= 0)
+                    model.transform.position.y = ground.y + nav_height;
+            }
+            path_pos = tile_pos(model.transform.position);
+            map.enemy_position = model.transform.position;
+        }
+
         // Funcin para manejar el comportamiento del enemigo cuando est gritando.
         void screamer(Player &player)
         {
@@ -116,6 +183,7 @@ class Enemy
             float angle = atan2(rotation_matrix[0][2], rotation_matrix[2][2]) - M_PI;
             model.transform.rotation.y = angle;
             front = -player.player_camera.front;
+            model.transform.snap();
 
             movement_speed = 4.0f;
             scream = true;
@@ -128,10 +196,17 @@ class Enemy
             return {int(std::round(pos.z / 1)) * 1, int(std::round(pos.x / 1)) * 1};
         }
 
+        // Estadsticas (casillas o nodos expandidos y duracin) de la ltima bsqueda de ruta.
+        const SearchStats& path_stats() const
+        {
+            return path_algorithm == PathAlgorithm::Hierarchical ? cluster_search.stats() : search.stats();
+        }
+
         // Funcin para detectar la presencia del jugador cerca del enemigo.
         void detect_player()
         {
-            // Utiliza la bsqueda en anchura para determinar si el jugador est cerca y/o visible para el enemigo.
+            // Utiliza el campo de distancias hacia el jugador para determinar si est cerca y/o visible para el enemigo.
+            PROFILE_ZONE("Enemy::detect_player");
 
             glm::ivec2 tp = tile_pos(map.player_position);
             glm::ivec2 tpe = tile_pos(map.enemy_position);
@@ -142,26 +217,35 @@ class Enemy
                 see_player = false;
                 return;
             }
-            
-            std::vector<glm::ivec2> p = breadth(map, path_pos, tile_pos(map.player_position));
 
-            for (int i = 0; i < p.size(); i++)
+            if (map.grid.empty())
             {
-                if (p[i] == tile_pos(map.player_position))
-                {
-                    near_player = true;
-                }
-
-                if (i < 4 && p[i] == tile_pos(map.player_position))
-                {
-                    see_player = true;
-                } else {see_player = false;}
+                // Sin grilla no hay campo de distancias ni paredes en casillas: cerca es a menos de la distancia de
+                // arriba, y la vista exige el cono y un tramo recto libre sobre la malla de navegacin.
+                glm::vec2 to_player = { map.player_position.z - model.transform.position.z, map.player_position.x - model.transform.position.x };
+                float distance = glm::length(to_player);
+                glm::vec3 hit;
+                near_player = true;
+                see_player = distance <= view_cone.range
+                    && glm::dot(to_player, glm::vec2(front.z, front.x)) >= std::cos(view_cone.half_angle) * distance
+                    && map.navmesh.raycast(model.transform.position, map.player_position, hit);
+                return;
+            }
+            
+            // La cercana se mide en casillas hasta el jugador, que el mapa ya tiene calculada; la vista
+            // exige adems que el jugador est dentro del cono y sin paredes en medio.
+            int distance = map.player_field.distance(path_pos);
+            if (distance > 0)
+            {
+                near_player = true;
+                see_player = map.sight.can_see(map.grid, { model.transform.position.z, model.transform.position.x },
+                    { front.z, front.x }, { map.player_position.z, map.player_position.x }, view_cone);
             }
         }
 
     private:
         // Miembros privados de la clase, incluyendo el modelo 3D, el sonido, la velocidad de movimiento, y la ruta de movimiento.
-        Clock clock; // Reloj para manejar el tiempo.
+        float step_time = 0.0f; // Duracin del paso de simulacin en curso.
         Map& map; // Referencia al mapa del juego.
         Model model; // Modelo 3D del enemigo.
         ma_sound noise; // Sonido asociado con el enemigo.
@@ -171,94 +255,120 @@ class Enemy
         glm::vec3 right = glm::vec3(-1.0f, 0.0f, 0.0f); // Direccin derecha del enemigo.
 
         std::vector<glm::ivec2> path; // Ruta de movimiento calculada.
+        std::vector<glm::ivec2> next_path; // Ruta siguiente, recibida del servicio de rutas.
+        bool next_ready = false; // Si 'next_path' ya lleg.
+        PathService::Ticket route_ticket = 0; // Pedido de la ruta siguiente en curso (0 si no hay).
+        bool investigating = false; // Si 'route_ticket' es la ruta hacia un ruido, que reemplaza a la actual al llegar.
+        uint32_t heard_event = 0; // ltimo ruido al que reaccion.
+        GridSearch search; // Contexto de bsqueda reutilizado entre rutas (no reserva memoria tras la primera).
+        ClusterSearch cluster_search; // Contexto de la bsqueda jerrquica sobre los clusters del mapa.
         glm::ivec2 path_pos; // Posicin actual en el mapa.
+        std::vector<glm::vec3> nav_path; // Ruta sobre la malla de navegacin (niveles sin grilla).
+        size_t nav_it = 0; // Punto de 'nav_path' hacia el que va.
+        float nav_height = 0.3f; // Altura del modelo sobre la malla de navegacin.
 
         float movement_speed = 0.3f; // Velocidad de movimiento del enemigo.
         float velocity; // Velocidad calculada basada en el tiempo.
 
         int it = 0; // ndice para iterar a travs de la ruta de movimiento.
-        bool choose_direction = false; // Indica si se debe elegir una nueva direccin de movimiento.
+        int agent = -1; // Identificador del enemigo en la multitud del mapa.
+        int ai_agent = -1; // Identificador del enemigo en el planificador de IA del mapa.
 
         // Funciones privadas para manejar el movimiento y la orientacin del enemigo.
 
         void move_forward()
         {
-            velocity = movement_speed * clock.delta_time;
+            velocity = movement_speed * step_time;
             model.transform.position += front * velocity;
         }
 
-        bool on_tile(glm::ivec2 path_tile)
+        // Calcula en 'path' una ruta desde la casilla actual hasta 'goal' con el algoritmo elegido y, como las del
+        // servicio de rutas, la reduce a sus puntos de giro. Devuelve su largo.
+        int find_route(glm::ivec2 goal)
         {
-            float offset = 0.01f;
-            float min_x = path_tile.y - offset;
-            float max_x = path_tile.y + offset;
-            float min_z = path_tile.x - offset;
-            float max_z = path_tile.x + offset;
-    
-            if (model.transform.position.x >= min_x && model.transform.position.x <= max_x && model.transform.position.z >= min_z && model.transform.position.z <= max_z)
-            {
-                choose_direction = false;
-                path_pos = path_tile;
-                return true;
-            }
-            return false;
+            solve_route(path_algorithm, map.grid, map.clusters, map.paths, search, cluster_search, path_pos, goal, path);
+            if (map.routes.any_angle)
+                smooth_path(map.grid, path_pos, path, map.routes.clearance);
+            return (int)path.size();
         }
 
-        void change_direction(Enemy_Movement direction)
+        // Pide al servicio de rutas la ruta siguiente, desde la casilla en la que termina la actual hasta una
+        // posicin aleatoria alcanzable. El enemigo recorre la ruta hasta su ltimo punto (ver update).
+        void request_next_route()
         {
-            if (direction == BACKWARD) 
-            {
-                model.transform.rotation.y += glm::radians(180.0f);
-                front = glm::vec3(glm::rotate(glm::mat4(1.0f), glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::vec4(front, 1.0f));
-            }
-            if (direction == LEFT) 
+            glm::ivec2 start = path.empty() ? path_pos : path.back();
+            route_ticket = map.routes.request(start, map.random_reachable_pos(start), path_algorithm);
+        }
+
+        // Retira la ruta siguiente si el servicio ya la public. Si la meta toc en la misma casilla de inicio
+        // la ruta es vaca y se pide otra.
+        void take_next_route()
+        {
+            if (route_ticket == 0)
+                return;
+            int length = map.routes.take(route_ticket, next_path);
+            if (length < 0)
+                return;
+            route_ticket = 0;
+            if (length > 0 && investigating)
             {
-                model.transform.rotation.y += glm::radians(90.0f);
-                front = glm::vec3(glm::rotate(glm::mat4(1.0f), glm::radians(90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::vec4(front, 1.0f));
+                // La ruta hacia el ruido parte de la casilla en la que estaba al orlo: se sigue desde ya.
+                path.swap(next_path);
+                it = 0;
+                investigating = false;
+                request_next_route();
             }
-            if (direction == RIGHT) 
+            else if (length > 0)
+                next_ready = true;
+            else
             {
-                model.transform.rotation.y += glm::radians(-90.0f);
-                front = glm::vec3(glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(0.0f, 1.0f, 0.0f)) * glm::vec4(front, 1.0f));
+                investigating = false;
+                request_next_route();
             }
         }
 
-        void compute_direction()
+        // Consulta los ruidos que llegan a su casilla. Ante uno nuevo abandona la ruta siguiente y pide una hacia el
+        // origen del ruido; la propagacin ya la hizo el mapa al emitirlo, aqu solo se lee.
+        void listen()
         {
-            glm::vec3 forward = glm::normalize(front);
-            glm::vec2 currentDirection = {forward.z, forward.x};
-            glm::vec2 direction = (path[it] - path_pos);
-
-            path_pos = tile_pos(model.transform.position);
+            HeardNoise heard;
+            heard_player = map.hearing.hear(map.grid, path_pos, heard);
+            if (!heard_player || heard.event == heard_event)
+                return;
+            heard_event = heard.event;
+            map.routes.cancel(route_ticket);
+            next_ready = false;
+            investigating = true;
+            route_ticket = map.routes.request(path_pos, heard.source, path_algorithm);
+        }
 
-            if (on_tile(path[it])) {
+        // Fija como punto de paso el punto actual de la ruta y pasa al siguiente al alcanzarlo; entre puntos el
+        // enemigo va en lnea recta. Al alcanzar el ltimo punto la ruta queda terminada.
+        void follow_path()
+        {
+            map.crowd.set_target(agent, glm::vec2(path[it]));
+            if (map.crowd.arrived(agent))
+            {
                 it++;
-                choose_direction = false;
-                move_forward();
-            }
-            else {
-                move_forward();
+                if (it < path.size())
+                    map.crowd.set_target(agent, glm::vec2(path[it]));
             }
+        }
 
-            if (choose_direction == false) {
-                choose_direction = true;
-                direction = (path[it] - path_pos);
-                currentDirection = {forward.z, forward.x};
-
-                float dotProduct = glm::dot(direction, currentDirection);
-
-                if (dotProduct < -0.95f) {
-                    change_direction(BACKWARD);
-                } else if (dotProduct > 0.95f) {
-                } else {
-                    float crossProduct = direction.x * currentDirection.y - direction.y * currentDirection.x;
-                    if (crossProduct > 0.0f) {
-                        change_direction(RIGHT);
-                    } else {
-                        change_direction(LEFT);
-                    }
-                }
+        // Sigue la ruta sobre la malla de navegacin hacia un punto al azar; al terminarla busca otra.
+        void follow_nav_path()
+        {
+            if (nav_it >= nav_path.size())
+            {
+                map.navmesh.find_path(model.transform.position, map.random_nav_point(), nav_path);
+                nav_it = 0;
+                if (nav_path.empty())
+                    return;
             }
+            glm::vec3 target = nav_path[nav_it];
+            map.crowd.set_target(agent, { target.z, target.x });
+            if (map.crowd.arrived(agent))
+                nav_it++;
         }
 
         void update_sound_position()
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// FlowField guarda, para cada casilla a menos de 'radius' pasos de una casilla fuente (el jugador), la
+// distancia en pasos hasta la fuente y la casilla vecina por la que se sigue hacia ella. Se recalcula solo
+// cuando la fuente cambia de casilla, y cada reclculo recorre nicamente las casillas dentro del radio:
+// los arreglos no se limpian, las casillas de clculos anteriores quedan descartadas por su generacin.
+// As cualquier cantidad de enemigos puede consultar la distancia y el siguiente paso en O(1), sin
+// hacer una bsqueda propia en cada paso de simulacin.
+class FlowField {
+    public:
+        // 'radius' es la distancia mxima en pasos que se calcula. Por defecto cubre el mapa del juego completo.
+        FlowField(int radius = 128) : max_distance(radius) {}
+
+        // Cambia el radio. El campo se recalcula en la prxima actualizacin.
+        void set_radius(int radius)
+        {
+            max_distance = radius;
+            invalidate();
+        }
+
+        int radius() const { return max_distance; }
+
+        // Descarta el campo (por ejemplo, al liberar el mapa). La prxima actualizacin lo recalcula.
+        void invalidate()
+        {
+            valid = false;
+            grid = nullptr;
+        }
+
+        // Actualiza el campo para la fuente 'source' (fila, columna). Si la fuente no cambi de casilla no hace
+        // nada. Devuelve verdadero si recalcul. Una fuente no transitable deja el campo vaco, igual que una
+        // bsqueda cuya meta no es transitable.
+        bool update(const Grid &map_grid, glm::ivec2 source)
+        {
+            if (valid && grid == &map_grid && distances.size() == map_grid.size() && source == source_cell)
+                return false;
+
+            PROFILE_ZONE("FlowField::update");
+            grid = &map_grid;
+            source_cell = source;
+            valid = true;
+            prepare();
+
+            if (!grid->walkable(source.x, source.y))
+                return true;
+
+            int offsets[4];
+            grid->neighbour_offsets(offsets);
+            int source_index = grid->index(source.x, source.y);
+
+            int head = 0, tail = 0;
+            frontier[tail++] = source_index;
+            reach(source_index, source_index, 0);
+
+            while (head < tail)
+            {
+                int current = frontier[head++];
+                int next_distance = distances[current] + 1;
+                if (next_distance > max_distance)
+                    continue;
+
+                for (int i = 0; i < 4; i++)
+                {
+                    int next = current + offsets[i];
+                    // El borde de la grilla no es transitable, as que 'next' nunca sale del arreglo.
+                    if (!grid->walkable_at(next) || generations[next] == generation)
+                        continue;
+                    reach(next, current, next_distance);
+                    frontier[tail++] = next;
+                }
+            }
+            return true;
+        }
+
+        // Distancia en pasos desde la casilla (fila, columna) hasta la fuente, o -1 si est fuera del radio o
+        // no hay camino. Una casilla no transitable (como la inicial del enemigo) usa la de su mejor vecino
+        // ms uno, igual que una bsqueda que parte de ella.
+        int distance(glm::ivec2 cell) const
+        {
+            int index = nearest(cell);
+            if (index < 0)
+                return -1;
+            return distances[index] + (grid->walkable_at(grid->index(cell.x, cell.y)) ? 0 : 1);
+        }
+
+        // Escribe en 'step' la siguiente casilla hacia la fuente desde 'cell'. Devuelve falso si la casilla
+        // no alcanza la fuente o si ya es la fuente.
+        bool next_step(glm::ivec2 cell, glm::ivec2 &step) const
+        {
+            int index = nearest(cell);
+            if (index < 0)
+                return false;
+
+            int cell_index = grid->index(cell.x, cell.y);
+            if (index != cell_index)
+            {
+                step = grid->cell(index);
+                return true;
+            }
+            if (toward[index] == index)
+                return false;
+            step = grid->cell(toward[index]);
+            return true;
+        }
+
+        // Casilla fuente del ltimo clculo.
+        glm::ivec2 source() const { return source_cell; }
+
+    private:
+        const Grid* grid = nullptr;
+        int max_distance;
+        bool valid = false;
+        glm::ivec2 source_cell = { -1, -1 };
+
+        std::vector<int> distances; // Distancia a la fuente de cada casilla.
+        std::vector<int> toward; // Casilla vecina siguiente hacia la fuente.
+        std::vector<uint32_t> generations; // Clculo en el que se alcanz cada casilla.
+        std::vector<int> frontier; // Frontera FIFO: cada casilla entra una sola vez.
+        uint32_t generation = 0;
+
+        // Ajusta los arreglos al tamao de la grilla y abre una nueva generacin.
+        void prepare()
+        {
+            if (generations.size() != grid->size())
+            {
+                distances.assign(grid->size(), 0);
+                toward.assign(grid->size(), -1);
+                generations.assign(grid->size(), 0);
+                frontier.assign(grid->size(), 0);
+                generation = 0;
+            }
+            if (++generation == 0)
+            {
+                std::fill(generations.begin(), generations.end(), 0);
+                generation = 1;
+            }
+        }
+
+        void reach(int index, int from, int distance)
+        {
+            generations[index] = generation;
+            toward[index] = from;
+            distances[index] = distance;
+        }
+
+        bool reached(int index) const { return generations[index] == generation; }
+
+        // ndice de la casilla del campo que representa a 'cell': ella misma si fue alcanzada o, si no es
+        // transitable, su vecino alcanzado ms cercano a la fuente. -1 si no hay ninguno.
+        int nearest(glm::ivec2 cell) const
+        {
+            if (!valid || grid == nullptr || !grid->in_bounds(cell.x, cell.y))
+                return -1;
+            int index = grid->index(cell.x, cell.y);
+            if (reached(index))
+                return index;
+            if (grid->walkable_at(index))
+                return -1;
+
+            int offsets[4];
+            grid->neighbour_offsets(offsets);
+            int best = -1;
+            for (int i = 0; i < 4; i++)
+            {
+                int next = index + offsets[i];
+                if (reached(next) && (best < 0 || distances[next] < distances[best]))
+                    best = next;
+            }
+            return best;
+        }
+};
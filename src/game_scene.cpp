@@ -1,29 +1,12 @@
 #include "game_scene.hpp"
 #include "toolbox.hpp"
 
-// Constructor de la escena del juego, inicializa componentes y carga recursos.
+// Constructor de la escena del juego. Solo crea el quad de pantalla; los recursos se cargan en begin_load.
 GameScene::GameScene(Context& ctx) : ctx(ctx)
 {
+    PROFILE_ZONE("GameScene::GameScene");
     store_scene_in_ctx(); // Almacena la escena actual en el contexto global.
 
-    map.load_map(); // Carga el mapa del juego.
-    // Inicializa shaders para diferentes elementos de la escena.
-    map_shader = Shader("basic_light.vs", "map_spotlight.fs");
-    floor_shader = Shader("floor.vs", "floor_spotlight.fs");
-
-    shader = Shader("framebuffer.vs", "framebuffer.fs");
-    screen_shader = Shader("framebuffer_screen.vs", "framebuffer_screen.fs");
-
-    // Crea objetos jugador y enemigo.
-    player = new Player(map, ctx.sound_manager, ctx.win_width, ctx.win_height);
-    enemy = new Enemy(map, ctx.sound_manager);
-
-    // Carga sonidos de ambiente y de eventos especficos.
-    ma_sound_init_from_file(&ctx.sound_manager.engine, "./assets/sfx/screamer.wav", MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, NULL, &ctx.sound_manager.fence, &scream_sound);
-    ma_sound_init_from_file(&ctx.sound_manager.engine, "./assets/sfx/ambiance.wav", MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, NULL, &ctx.sound_manager.fence, &ambiance_sound);
-    // Carga la textura de la linterna.
-    load_texture("./assets/textures/flashlight.png", cookie_mask_id);
-
     // Configuracin del framebuffer para efectos de post-procesamiento.
     glGenVertexArrays(1, &quad_vao);
     glGenBuffers(1, &quad_vbo);
@@ -37,7 +20,86 @@ GameScene::GameScene(Context& ctx) : ctx(ctx)
 }
 
 // Almacena la referencia de esta escena en el contexto global.
-void GameScene::store_scene_in_ctx(){ ctx.scenes.push_back(this); }
+void GameScene::store_scene_in_ctx(){ ctx.store_scene(this); }
+
+// Programa la carga de la escena. El mapa se lee e importa en hilos trabajadores; lo que usa OpenGL
+// o el motor de sonido (shaders, subidas, jugador y enemigo) corre en el hilo principal entre frames.
+void GameScene::begin_load()
+{
+    PROFILE_ZONE("GameScene::begin_load");
+    JobSystem &jobs = ctx.jobs;
+    load_jobs.clear();
+
+    JobHandle layout = map.load_async(load_jobs);
+
+    // Inicializa shaders para diferentes elementos de la escena.
+    load_jobs.push_back(jobs.schedule([this] {
+        map_shader = Shader("basic_light.vs", "map_spotlight.fs");
+        floor_shader = Shader("floor.vs", "floor_spotlight.fs");
+    }, {}, JobAffinity::Main));
+    load_jobs.push_back(jobs.schedule([this] {
+        shader = Shader("framebuffer.vs", "framebuffer.fs");
+        screen_shader = Shader("framebuffer_screen.vs", "framebuffer_screen.fs");
+    }, {}, JobAffinity::Main));
+
+    // Crea objetos jugador y enemigo; necesitan las posiciones del mapa.
+    JobHandle player_job = jobs.schedule([this] {
+        player = std::make_unique<Player>(map, ctx.sound_manager, ctx.win_width, ctx.win_height);
+    }, { layout }, JobAffinity::Main);
+    load_jobs.push_back(player_job);
+    load_jobs.push_back(jobs.schedule([this] {
+        enemy = std::make_unique<Enemy>(map, ctx.sound_manager);
+
+        // Carga sonidos de ambiente y de eventos especficos.
+        ma_sound_init_from_file(&ctx.sound_manager.engine, "./assets/sfx/screamer.wav", MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, NULL, &ctx.sound_manager.fence, &scream_sound);
+        ma_sound_init_from_file(&ctx.sound_manager.engine, "./assets/sfx/ambiance.wav", MA_SOUND_FLAG_DECODE | MA_SOUND_FLAG_ASYNC, NULL, &ctx.sound_manager.fence, &ambiance_sound);
+        // Carga la textura de la linterna.
+        load_texture("./assets/textures/flashlight.png", cookie_mask_id);
+    }, { player_job }, JobAffinity::Main));
+}
+
+// Avance de la carga: trabajos terminados ms un ltimo tramo para las subidas a la GPU pendientes.
+float GameScene::load_progress()
+{
+    if (load_jobs.empty())
+        return 0.0f;
+
+    size_t done = 0;
+    for (const JobHandle &job : load_jobs)
+    {
+        if (job->done)
+            done++;
+    }
+    if (done == load_jobs.size() && ctx.uploads.idle())
+        return 1.0f;
+    return (float)done / (float)(load_jobs.size() + 1);
+}
+
+// Libera todos los recursos cargados por begin_load.
+void GameScene::unload()
+{
+    PROFILE_ZONE("GameScene::unload");
+    ctx.jobs.wait_all(load_jobs); // Por si la carga no haba terminado.
+    ctx.uploads.flush();
+    load_jobs.clear();
+
+    player.reset();
+    enemy.reset();
+    ma_sound_uninit(&scream_sound);
+    ma_sound_uninit(&ambiance_sound);
+
+    glDeleteTextures(1, &cookie_mask_id);
+    glDeleteTextures(1, &textureColorbuffer);
+    glDeleteRenderbuffers(1, &rbo);
+    glDeleteFramebuffers(1, &framebuffer);
+
+    glDeleteProgram(map_shader.ID);
+    glDeleteProgram(floor_shader.ID);
+    glDeleteProgram(shader.ID);
+    glDeleteProgram(screen_shader.ID);
+
+    map.release();
+}
 
 // Inicializa el framebuffer para efectos de post-procesamiento.
 void GameScene::init_framebuffer()
@@ -79,7 +141,6 @@ void GameScene::open_scene()
     init_framebuffer();
     player->init();
     enemy->init();
-    clock.reset();
     call_screamer = false;
     ma_engine_start(&ctx.sound_manager.engine);
     ma_sound_start(&ambiance_sound);
@@ -95,20 +156,20 @@ void GameScene::close_scene()
 }
 
 // Configura los shaders con parmetros especficos de la escena.
-void GameScene::shader_config()
+void GameScene::shader_config(const Camera3D &camera)
 {
     // Configura los shaders para el renderizado, incluyendo propiedades de luz y material.
 
     map_shader.use();
 
-    map_shader.set_float("time", clock.current_time);
+    map_shader.set_float("time", ctx.clock.current_time);
     //spotlight properties
-    map_shader.set_vec3("light.position", player->player_camera.position);
-    map_shader.set_vec3("light.direction", player->player_camera.front);
+    map_shader.set_vec3("light.position", camera.position);
+    map_shader.set_vec3("light.direction", camera.front);
     map_shader.set_float("light.cutOff",   glm::cos(glm::radians(10.0f)));
     map_shader.set_float("light.outerCutOff", glm::cos(glm::radians(12.0f)));
 
-    map_shader.set_vec3("viewPos", player->player_camera.position);
+    map_shader.set_vec3("viewPos", camera.position);
 
     // light properties
     if (player->torchlight_on)
@@ -143,8 +204,8 @@ void GameScene::shader_config()
     glBindTexture(GL_TEXTURE_2D, cookie_mask_id);
 
     floor_shader.use();
-    floor_shader.set_vec3("light.position", player->player_camera.position);
-    floor_shader.set_vec3("light.direction", player->player_camera.front);
+    floor_shader.set_vec3("light.position", camera.position);
+    floor_shader.set_vec3("light.direction", camera.front);
     /*
     floor_shader.set_float("light.cutOff",   glm::cos(glm::radians(10.0f)));
     floor_shader.set_float("light.outerCutOff", glm::cos(glm::radians(12.0f)));
@@ -152,7 +213,7 @@ void GameScene::shader_config()
     map_shader.set_float("light.cutOff", glm::cos(glm::radians(15.0f))); // Valor original: glm::cos(glm::radians(10.0f))
     map_shader.set_float("light.outerCutOff", glm::cos(glm::radians(17.5f))); // Valor original: glm::cos(glm::radians(12.0f))
 
-    floor_shader.set_vec3("viewPos", player->player_camera.position);
+    floor_shader.set_vec3("viewPos", camera.position);
 
     // light properties
     if (player->torchlight_on)
@@ -184,14 +245,45 @@ void GameScene::shader_config()
     glBindTexture(GL_TEXTURE_2D, cookie_mask_id);
 }
 
-// Actualiza el estado de la escena en cada frame.
+// Avanza la simulacin del juego un paso fijo: movimiento del jugador, radio y enemigo.
+void GameScene::fixed_update(float delta_time)
+{
+    map.routes.deliver(); // Publica las rutas pedidas en el paso anterior.
+    map.ai.begin_step();
+    map.hearing.update(delta_time);
+    player->begin_step();
+
+    if (!call_screamer)
+    {
+        bool k_pressed = false;
+        for (int i = 0; i < 4; i++)
+        {
+            if (move_keys[i]) {
+                k_pressed = true;
+                player->process_keyboard((Camera3D_Movement)i, delta_time, k_pressed);
+            }
+        }
+        player->update_velocity(k_pressed, delta_time);
+    }
+
+    player->update(delta_time, ctx.clock.simulation_time);
+    if (player->radio->radio_on)
+        map.emit_noise(player->player_camera.position, map.hearing.radio); // Mientras suena, renueva su ruido en cada paso.
+    map.update_player_field();
+    enemy->update(delta_time);
+    map.crowd.update(map.grid, delta_time);
+    enemy->apply_steering();
+    map.dispatch_routes();
+}
+
+// Renderiza la escena en cada frame, interpolando jugador y enemigo entre pasos de simulacin.
 void GameScene::update()
 {
-    // Lgica de actualizacin de la escena, incluyendo renderizado a framebuffer y efectos.
+    // Lgica de renderizado de la escena a framebuffer y efectos.
 
-    clock.update();
-    player->update();
-    enemy->update();
+    float alpha = ctx.clock.alpha;
+    Camera3D view_camera = player->player_camera;
+    view_camera.position = player->render_position(alpha);
 
     glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
     glEnable(GL_DEPTH_TEST); // enable depth testing (is disabled for rendering screen-space quad)
@@ -201,12 +293,12 @@ void GameScene::update()
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     shader.use();
-    shader.set_mat4("view", player->player_camera.get_view_matrix());
-    shader.set_mat4("projection", player->player_camera.get_projection_matrix());
+    shader.set_mat4("view", view_camera.get_view_matrix());
+    shader.set_mat4("projection", view_camera.get_projection_matrix());
 
-    shader_config();
-    map.render(map_shader, floor_shader, player->player_camera);
-    enemy->render(map_shader, player->player_camera);
+    shader_config(view_camera);
+    map.render(map_shader, floor_shader, view_camera);
+    enemy->render(map_shader, view_camera, alpha);
 
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
     glDisable(GL_DEPTH_TEST);
@@ -214,7 +306,7 @@ void GameScene::update()
     glClear(GL_COLOR_BUFFER_BIT);
 
     screen_shader.use();
-    screen_shader.set_float("time", clock.current_time);
+    screen_shader.set_float("time", ctx.clock.current_time);
 
     float distance = glm::distance(map.player_position, map.enemy_position);
 
@@ -259,7 +351,7 @@ void GameScene::end_condition()
     {
         screamer();
 
-        if (clock.current_time - scream_start_time >= 3.0f) 
+        if (ctx.clock.current_time - scream_start_time >= 3.0f) 
         {
             ma_sound_stop(&scream_sound);
             ctx.load_scene_id(0);
@@ -275,7 +367,7 @@ void GameScene::screamer()
     if (call_screamer == false)
     {
         call_screamer = true;
-        scream_start_time = clock.current_time;
+        scream_start_time = ctx.clock.current_time;
         enemy->screamer(*player);
         ma_sound_seek_to_pcm_frame(&scream_sound, 0);
         ma_sound_start(&scream_sound);
@@ -294,36 +386,17 @@ void GameScene::scene_clear()
 // Procesa la entrada del usuario desde el teclado.
 void GameScene::process_input()
 {
-    // Gestiona las entradas del teclado para controlar al jugador.
-
-    bool k_pressed = false;
+    // Registra las teclas de movimiento; el desplazamiento se aplica en fixed_update.
 
     if (glfwGetKey(ctx.window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
     {
         ctx.load_scene_id(0);
     }
 
-    if (call_screamer)
-        return;
-
-    if (glfwGetKey(ctx.window, GLFW_KEY_W) == GLFW_PRESS) {
-        k_pressed = true;
-        player->process_keyboard(FORWARD, clock.delta_time, k_pressed);
-    }
-    if (glfwGetKey(ctx.window, GLFW_KEY_S) == GLFW_PRESS) {
-        k_pressed = true;
-        player->process_keyboard(BACKWARD, clock.delta_time, k_pressed);
-    }
-    if (glfwGetKey(ctx.window, GLFW_KEY_A) == GLFW_PRESS) {
-        k_pressed = true;
-        player->process_keyboard(LEFT, clock.delta_time, k_pressed);
-    }
-    if (glfwGetKey(ctx.window, GLFW_KEY_D) == GLFW_PRESS) {
-        k_pressed = true;
-        player->process_keyboard(RIGHT, clock.delta_time, k_pressed);
-    }
-
-    player->update_velocity(k_pressed);
+    move_keys[FORWARD] = glfwGetKey(ctx.window, GLFW_KEY_W) == GLFW_PRESS;
+    move_keys[BACKWARD] = glfwGetKey(ctx.window, GLFW_KEY_S) == GLFW_PRESS;
+    move_keys[LEFT] = glfwGetKey(ctx.window, GLFW_KEY_A) == GLFW_PRESS;
+    move_keys[RIGHT] = glfwGetKey(ctx.window, GLFW_KEY_D) == GLFW_PRESS;
 }
 
 // Callback para manejar el movimiento del mouse.
@@ -365,6 +438,7 @@ void GameScene::left_click_callback(GLFWwindow* window, int button, int action,
     glfwGetCursorPos(window, &xpos, &ypos);
     if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS) {
         ma_engine_play_sound(&ctx.sound_manager.engine, "./assets/sfx/torchlight_click.wav", NULL);
+        map.emit_noise(player->player_camera.position, map.hearing.torch_click);
         if (player->torchlight_on)
             player->torchlight_on = false;
         else
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 // Inclusin de las dependencias necesarias para la escena del juego.
 #include "mygl/shader.h"
 #include "mygl/shape.hpp"
@@ -7,7 +9,6 @@
 #include "mygl/context.hpp"
 #include "mygl/button.hpp"
 #include "mygl/model.hpp"
-#include "mygl/clock.hpp"
 #include "map.hpp"
 #include "player.hpp"
 #include "enemy.hpp"
@@ -23,9 +24,13 @@ class GameScene : public IScene {
         void store_scene_in_ctx() override;
         void open_scene() override;
         void close_scene() override;
+        void fixed_update(float delta_time) override;
         void update() override;
         void scene_clear() override;
         void process_input() override;
+        void begin_load() override; // Programa la carga del mapa, los shaders, el jugador y el enemigo.
+        float load_progress() override;
+        void unload() override;
 
         // Callbacks para manejar eventos de entrada especficos.
         void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) override; // Maneja el movimiento del mouse.
@@ -35,7 +40,7 @@ class GameScene : public IScene {
 
         // Mtodos especficos de GameScene para inicializar y configurar elementos de la escena.
         void init_framebuffer();
-        void shader_config();
+        void shader_config(const Camera3D &camera);
         void screamer();
         void end_condition();
 
@@ -50,19 +55,21 @@ class GameScene : public IScene {
         float lastY = ctx.win_height / 2.0f;
         bool first_mouse = true;
     
-        // Punteros a los elementos principales de la escena.
-        Player *player = nullptr;
-        Enemy *enemy = nullptr;
-
         // Componentes de la escena como el mapa, shaders y reloj.
         Map map;
+
+        // Elementos principales de la escena. Van despus del mapa porque sus destructores lo usan: se destruyen antes.
+        std::unique_ptr<Player> player;
+        std::unique_ptr<Enemy> enemy;
         Shader shader;
         Shader screen_shader;
         Shader light_shader;
         Shader map_shader;
         Shader floor_shader;
-        
-        Clock clock; // Reloj para controlar el tiempo dentro de la escena.
+
+        std::vector<JobHandle> load_jobs; // Trabajos de carga programados por begin_load.
+
+        bool move_keys[4] = {false, false, false, false}; // Teclas de movimiento presionadas, indexadas por Camera3D_Movement.
         glm::vec3 light_pos; // Posicin de la luz principal en la escena.
 
         Shader modelShader; // Shader para los modelos 3D.
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Tipos de casilla del mapa. Cada uno corresponde a un carcter del archivo de mapa.
+enum class Tile : uint8_t {
+    Void, // Fuera del mapa (borde de relleno o filas ms cortas que las dems).
+    Floor, // ' ' suelo transitable.
+    Wall, // '#' pared.
+    PlayerStart, // '@' posicin inicial del jugador.
+    EnemyStart, // '&' posicin inicial del enemigo.
+    Goal, // 'w' meta.
+    StatueA, // 'A' a 'D' estatuas.
+    StatueB,
+    StatueC,
+    StatueD,
+    Other // Cualquier otro carcter.
+};
+
+// Convierte un carcter del archivo de mapa en su tipo de casilla.
+inline Tile tile_from_glyph(char c)
+{
+    switch (c)
+    {
+        case ' ': return Tile::Floor;
+        case '#': return Tile::Wall;
+        case '@': return Tile::PlayerStart;
+        case '&': return Tile::EnemyStart;
+        case 'w': return Tile::Goal;
+        case 'A': return Tile::StatueA;
+        case 'B': return Tile::StatueB;
+        case 'C': return Tile::StatueC;
+        case 'D': return Tile::StatueD;
+        default: return Tile::Other;
+    }
+}
+
+// Convierte un tipo de casilla en el carcter que lo representa en el archivo de mapa.
+inline char tile_glyph(Tile tile)
+{
+    static const char glyphs[] = { ' ', ' ', '#', '@', '&', 'w', 'A', 'B', 'C', 'D', '?' };
+    return glyphs[(int)tile];
+}
+
+// Intercala los bits de fila y columna (orden Z o de Morton): casillas cercanas en 2D quedan cercanas en la clave.
+inline uint32_t morton_key(uint32_t row, uint32_t col)
+{
+    auto spread = [](uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    return spread(row) << 1 | spread(col);
+}
+
+// Grid guarda el mapa en un nico arreglo contiguo, fila por fila, rodeado por un borde de una casilla
+// de tipo Void. Gracias al borde, los vecinos de cualquier casilla del mapa estn siempre dentro del
+// arreglo y se obtienen sumando un desplazamiento al ndice, sin comprobar lmites.
+// Adems de los tipos, mantiene un bitset por propiedad (transitable, opaca, pared) indexado igual que
+// las casillas, para consultas de un bit.
+// Las coordenadas de casilla son (fila, columna), igual que tile_pos del enemigo: fila = z, columna = x.
+class Grid {
+    public:
+        // Propiedades de casilla con bitset propio.
+        enum Property {
+            Walkable, // Se puede caminar (solo el suelo libre).
+            Opaque, // Bloquea la vista.
+            Wall, // Pared (bloquea el movimiento del jugador).
+            PropertyCount
+        };
+
+        Grid() = default;
+
+        // Construye la grilla a partir de las lneas del archivo de mapa.
+        void load(const std::vector<std::string> &lines)
+        {
+            row_count = (int)lines.size();
+            col_count = 0;
+            for (const std::string &line : lines)
+                col_count = std::max(col_count, (int)line.size());
+            row_stride = col_count + 2;
+
+            tiles.assign((size_t)row_stride * (row_count + 2), Tile::Void);
+            for (int row = 0; row < row_count; row++)
+            {
+                Tile* dst = &tiles[index(row, 0)];
+                for (size_t col = 0; col < lines[row].size(); col++)
+                    dst[col] = tile_from_glyph(lines[row][col]);
+            }
+
+            size_t words = (tiles.size() + 63) / 64;
+            for (int p = 0; p < PropertyCount; p++)
+                bits[p].assign(words, 0);
+            for (size_t i = 0; i < tiles.size(); i++)
+                update_bits((int)i);
+        }
+
+        // Cambia el tipo de una casilla del mapa y actualiza sus propiedades. Fuera del mapa no hace nada.
+        void set_tile(int row, int col, Tile tile)
+        {
+            if (!in_bounds(row, col))
+                return;
+            int i = index(row, col);
+            tiles[i] = tile;
+            update_bits(i);
+        }
+
+        // Vaca la grilla.
+        void clear()
+        {
+            tiles.clear();
+            for (int p = 0; p < PropertyCount; p++)
+                bits[p].clear();
+            row_count = col_count = row_stride = 0;
+        }
+
+        int rows() const { return row_count; }
+        int cols() const { return col_count; }
+        int stride() const { return row_stride; } // Distancia entre filas en el arreglo (incluye el borde).
+        size_t size() const { return tiles.size(); } // Cantidad de casillas del arreglo, con el borde.
+        bool empty() const { return tiles.empty(); }
+
+        // ndice en el arreglo de la casilla (fila, columna). Acepta el borde: fila y columna desde -1.
+        int index(int row, int col) const { return (row + 1) * row_stride + col + 1; }
+
+        // Casilla (fila, columna) de un ndice.
+        glm::ivec2 cell(int i) const { return { i / row_stride - 1, i % row_stride - 1 }; }
+
+        // Verdadero si (fila, columna) est dentro del mapa. Una sola comparacin sin signo por eje.
+        bool in_bounds(int row, int col) const
+        {
+            return (unsigned)row < (unsigned)row_count && (unsigned)col < (unsigned)col_count;
+        }
+
+        // Desplazamientos de ndice hacia los cuatro vecinos, en el orden {-1, 0}, {1, 0}, {0, -1}, {0, 1}.
+        void neighbour_offsets(int offsets[4]) const
+        {
+            offsets[0] = -row_stride;
+            offsets[1] = row_stride;
+            offsets[2] = -1;
+            offsets[3] = 1;
+        }
+
+        // Consultas por ndice, sin comprobar lmites (el ndice debe estar dentro del arreglo).
+        Tile tile_at(int i) const { return tiles[i]; }
+        bool test(Property property, int i) const { return (bits[property][i >> 6] >> (i & 63)) & 1; }
+        bool walkable_at(int i) const { return test(Walkable, i); }
+
+        // Consultas por casilla. Fuera del mapa devuelven Void o falso.
+        Tile tile(int row, int col) const { return in_bounds(row, col) ? tiles[index(row, col)] : Tile::Void; }
+        bool walkable(int row, int col) const { return in_bounds(row, col) && test(Walkable, index(row, col)); }
+        bool opaque(int row, int col) const { return in_bounds(row, col) && test(Opaque, index(row, col)); }
+        bool wall(int row, int col) const { return in_bounds(row, col) && test(Wall, index(row, col)); }
+
+        // Bitset completo de una propiedad (64 casillas por palabra, mismo orden que el arreglo).
+        const std::vector<uint64_t>& bitset(Property property) const { return bits[property]; }
+
+        // ndices de las casillas del mapa ordenados por clave de Morton, para recorridos con mejor localidad 2D.
+        std::vector<int> morton_order() const
+        {
+            std::vector<std::pair<uint32_t, int>> keyed;
+            keyed.reserve((size_t)row_count * col_count);
+            for (int row = 0; row < row_count; row++)
+                for (int col = 0; col < col_count; col++)
+                    keyed.push_back({ morton_key(row, col), index(row, col) });
+            std::sort(keyed.begin(), keyed.end());
+
+            std::vector<int> order;
+            order.reserve(keyed.size());
+            for (auto &k : keyed)
+                order.push_back(k.second);
+            return order;
+        }
+
+    private:
+        // Recalcula los bits de propiedades de la casilla 'i' a partir de su tipo.
+        void update_bits(int i)
+        {
+            uint64_t mask = (uint64_t)1 << (i & 63);
+            bool set[PropertyCount];
+            set[Walkable] = tiles[i] == Tile::Floor;
+            set[Opaque] = tiles[i] == Tile::Wall;
+            set[Wall] = tiles[i] == Tile::Wall;
+            for (int p = 0; p < PropertyCount; p++)
+            {
+                if (set[p]) bits[p][i >> 6] |= mask;
+                else bits[p][i >> 6] &= ~mask;
+            }
+        }
+
+        int row_count = 0;
+        int col_count = 0;
+        int row_stride = 0;
+        std::vector<Tile> tiles; // Tipos de casilla, con un borde Void alrededor.
+        std::vector<uint64_t> bits[PropertyCount]; // Un bitset por propiedad.
+};
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+#if defined(__AVX2__)
+#define GRID_BITS_AVX2
+#include <immintrin.h>
+#endif
+
+// GridBits resuelve anlisis de todo el mapa (qu se alcanza desde el inicio, a cuntos pasos est cada casilla
+// de las estatuas, qu queda a N pasos de la meta) sobre el bitset de casillas transitables de Grid, 64 casillas
+// por palabra. Como Grid guarda las filas una tras otra con un borde Void, los cuatro vecinos de todas las
+// casillas de una palabra se obtienen desplazando el bitset entero: un bit a cada lado para las columnas y
+// 'stride' bits para las filas; el borde no es transitable, as que nada pasa de una fila a otra por los lados.
+// Los conjuntos de casillas (entradas y resultados) son bitsets con el mismo ndice que la grilla. Las fuentes
+// pueden no ser transitables (el inicio del jugador, una estatua): se incluyen y el anlisis sale de ellas.
+// 'within' y 'distances' hacen un BFS por capas desde todas las fuentes a la vez, con las capas tambin como
+// bitsets. Una capa ancha se calcula en una pasada sin saltos, 4 palabras por instruccin con AVX2 (una por una
+// sin l); una dispersa, repartiendo cada palabra a sus vecinas.
+class GridBits {
+    public:
+        // Copia el bitset transitable de 'grid' entre palabras de guarda vacas, para leer vecinos sin comprobar lmites.
+        void build(const Grid &grid)
+        {
+            PROFILE_ZONE("GridBits::build");
+            const std::vector<uint64_t> &walkable = grid.bitset(Grid::Walkable);
+            word_count = (int)walkable.size();
+            grid_stride = grid.stride();
+            shift_words = grid_stride / 64;
+            shift_bits = grid_stride % 64;
+            // Las capas de corrido leen hasta dos filas ms all de las palabras con casillas.
+            guard = 2 * shift_words + 4;
+            mask.assign(word_count + 2 * guard, 0);
+            std::copy(walkable.begin(), walkable.end(), mask.begin() + guard);
+        }
+
+        void clear()
+        {
+            word_count = 0;
+            mask.clear();
+        }
+
+        bool empty() const { return word_count == 0; }
+
+        // Deja en 'out' las casillas alcanzables desde 'sources' (incluidas). Devuelve cuntas son.
+        // Relleno por palabras con una pila de trabajo: una palabra toma lo que le llega de sus vecinas (por los
+        // costados y desde las filas de arriba y de abajo), lo extiende por sus tramos transitables y, si gan
+        // casillas, apila las palabras vecinas. Cada palabra se procesa unas pocas veces, sin importar cun
+        // retorcidos sean los caminos.
+        int reachable(const Grid &grid, const std::vector<glm::ivec2> &sources, std::vector<uint64_t> &out)
+        {
+            PROFILE_ZONE("GridBits::reachable");
+            seed(grid, sources, current);
+            uint64_t* set = current.data() + guard;
+            const uint64_t* walk = mask.data() + guard;
+            queued.assign(mask.size(), 0);
+            uint8_t* in_stack = queued.data() + guard;
+            stack.clear();
+            for (int w = 0; w < word_count; w++)
+            {
+                if (set[w])
+                {
+                    stack.push_back(w);
+                    in_stack[w] = 1;
+                }
+            }
+            const int around[6] = { -shift_words - 1, -shift_words, -1, 1, shift_words, shift_words + 1 };
+            while (!stack.empty())
+            {
+                int w = stack.back();
+                stack.pop_back();
+                in_stack[w] = 0;
+                uint64_t x = set[w];
+                // Con filas de menos de 64 casillas las filas vecinas pueden estar en la misma palabra: se repite.
+                for (;;)
+                {
+                    set[w] = x;
+                    uint64_t next = fill(x | (incoming(set, w) & walk[w]), walk[w]);
+                    if (next == x)
+                        break;
+                    x = next;
+                }
+                if (x == 0)
+                    continue;
+                for (int offset : around)
+                {
+                    int n = w + offset;
+                    // Solo vale la pena si a la vecina le llega algo nuevo. Las guardas no tienen casillas transitables.
+                    if (in_stack[n] || n == w || !(walk[n] & ~set[n]) || !(incoming(set, n) & walk[n] & ~set[n]))
+                        continue;
+                    in_stack[n] = 1;
+                    stack.push_back(n);
+                }
+            }
+            out.assign(set, set + word_count);
+            return count(out);
+        }
+
+        // Deja en 'out' las casillas a 'steps' pasos o menos de alguna fuente. Devuelve cuntas son.
+        int within(const Grid &grid, const std::vector<glm::ivec2> &sources, int steps, std::vector<uint64_t> &out)
+        {
+            PROFILE_ZONE("GridBits::within");
+            layers(grid, sources, steps, nullptr);
+            out.assign(visited.begin() + guard, visited.begin() + guard + word_count);
+            return count(out);
+        }
+
+        // Distancia en pasos desde la fuente ms cercana, por ndice de la grilla (-1 si no se alcanza o est a
+        // ms de 'max_steps').
+        void distances(const Grid &grid, const std::vector<glm::ivec2> &sources, std::vector<int> &distance, int max_steps = INT_MAX)
+        {
+            PROFILE_ZONE("GridBits::distances");
+            distance.assign((size_t)word_count * 64, -1);
+            layers(grid, sources, max_steps, &distance);
+            distance.resize(grid.size());
+        }
+
+        // Verdadero si la casilla (fila, columna) est en el conjunto 'set'.
+        bool contains(const Grid &grid, const std::vector<uint64_t> &set, glm::ivec2 cell) const
+        {
+            if (!grid.in_bounds(cell.x, cell.y))
+                return false;
+            int i = grid.index(cell.x, cell.y);
+            return (set[i >> 6] >> (i & 63)) & 1;
+        }
+
+        // Cantidad de casillas de un conjunto.
+        static int count(const std::vector<uint64_t> &set)
+        {
+            int total = 0;
+            for (uint64_t word : set)
+                total += std::popcount(word);
+            return total;
+        }
+
+    private:
+        int word_count = 0;
+        int grid_stride = 0;
+        int shift_words = 0, shift_bits = 0; // 'stride' en palabras y bits.
+        int guard = 0; // Palabras vacas antes y despus de los datos.
+        std::vector<uint64_t> mask; // Casillas transitables, con las guardas.
+        // Conjuntos de trabajo, con las mismas guardas.
+        std::vector<uint64_t> current;
+        std::vector<uint64_t> frontier;
+        std::vector<uint64_t> visited;
+        std::vector<uint8_t> queued; // Palabras en la pila de 'reachable'.
+        std::vector<int> stack;
+        std::vector<int> layer_words, next_words; // Palabras con bits en la capa y en la siguiente.
+
+        // Bits que le llegan a la palabra 'w' de 'set' desde sus cuatro vecinos: los costados son un bit de
+        // desplazamiento y las filas de arriba y de abajo 'stride' bits, repartidos entre dos palabras. El doble
+        // desplazamiento evita desplazar 64 bits cuando 'shift_bits' es 0.
+        uint64_t incoming(const uint64_t* set, int w) const
+        {
+            return neighbours(set, w, shift_bits, shift_words);
+        }
+
+        static uint64_t neighbours(const uint64_t* set, int w, int shift_bits, int shift_words)
+        {
+            uint64_t x = set[w];
+            uint64_t sides = (x << 1) | (set[w - 1] >> 63) | (x >> 1) | (set[w + 1] << 63);
+            uint64_t rows = (set[w - shift_words] << shift_bits) | ((set[w - shift_words - 1] >> 1) >> (63 - shift_bits))
+                | (set[w + shift_words] >> shift_bits) | ((set[w + shift_words + 1] << 1) << (63 - shift_bits));
+            return sides | rows;
+        }
+
+        // Extiende 'x' por los tramos de 'walk' dentro de la palabra, en ambos sentidos: Kogge-Stone, seis pasos por sentido.
+        static uint64_t fill(uint64_t x, uint64_t walk)
+        {
+            uint64_t up = x, down = x, p = walk, q = walk;
+            for (int s = 1; s < 64; s <<= 1)
+            {
+                up |= p & (up << s);
+                down |= q & (down >> s);
+                p &= p << s;
+                q &= q >> s;
+            }
+            return up | down;
+        }
+
+        // Pone en 'set' (con guardas) solo las fuentes.
+        void seed(const Grid &grid, const std::vector<glm::ivec2> &sources, std::vector<uint64_t> &set) const
+        {
+            set.assign(mask.size(), 0);
+            for (glm::ivec2 source : sources)
+            {
+                if (!grid.in_bounds(source.x, source.y))
+                    continue;
+                int i = grid.index(source.x, source.y);
+                set[guard + (i >> 6)] |= (uint64_t)1 << (i & 63);
+            }
+        }
+
+        // BFS por capas hasta 'max_steps'. Deja lo visitado en 'visited' y, si 'distance' no es nulo, la capa de
+        // cada casilla. Cada capa se calcula de corrido sobre el intervalo de palabras al que llega la anterior si
+        // esta tiene al menos una palabra de cada 4; si est ms dispersa (un frente en diagonal pone una casilla
+        // por palabra), cada palabra de la capa reparte sus bits a sus vecinas.
+        void layers(const Grid &grid, const std::vector<glm::ivec2> &sources, int max_steps, std::vector<int>* distance)
+        {
+            seed(grid, sources, frontier);
+            visited = frontier;
+            current.assign(mask.size(), 0);
+            layer_words.resize(mask.size());
+            next_words.resize(mask.size());
+            int count = 0;
+            for (int w = guard; w < guard + word_count; w++)
+            {
+                if (frontier[w])
+                    layer_words[count++] = w;
+            }
+            if (distance)
+                write_layer(frontier.data(), layer_words.data(), count, 0, *distance);
+
+            const uint64_t* walk = mask.data();
+            for (int step = 1; step <= max_steps && count > 0; step++)
+            {
+                uint64_t* layer = frontier.data();
+                uint64_t* next = current.data();
+                uint64_t* seen = visited.data();
+                int* words = layer_words.data();
+                int low = words[0], high = words[0];
+                for (int i = 1; i < count; i++)
+                {
+                    low = std::min(low, words[i]);
+                    high = std::max(high, words[i]);
+                }
+
+                int from = low - shift_words - 1, to = high + shift_words + 2, next_count = 0;
+                if (count * 4 >= to - from)
+                    next_count = expand(from, to, shift_bits, shift_words, layer, walk, seen, next, next_words.data());
+                else
+                {
+                    for (int i = 0; i < count; i++)
+                        next_count = spread(words[i], layer[words[i]], walk, seen, next, next_words.data(), next_count);
+                }
+                if (distance)
+                    write_layer(next, next_words.data(), next_count, step, *distance);
+
+                // La capa anterior ya no hace falta: sus palabras se limpian y pasa a ser el bfer de la siguiente.
+                for (int i = 0; i < count; i++)
+                    layer[words[i]] = 0;
+                std::swap(frontier, current);
+                std::swap(layer_words, next_words);
+                count = next_count;
+            }
+        }
+
+        // Suma a la capa siguiente lo que la palabra 'w' de la capa ('x') le da a cada vecina: ella misma por las
+        // columnas y las de arriba y abajo por las filas; las palabras de al lado solo reciben los bits que cruzan
+        // el borde de la palabra, que casi nunca hay. Las palabras que pasan a tener bits se agregan a 'words'.
+        int spread(int w, uint64_t x, const uint64_t* walk, uint64_t* seen, uint64_t* next, int* words, int count) const
+        {
+            count = give(w, (x << 1) | (x >> 1), walk, seen, next, words, count);
+            count = give(w + shift_words, x << shift_bits, walk, seen, next, words, count);
+            count = give(w - shift_words, x >> shift_bits, walk, seen, next, words, count);
+            uint64_t left = x << 63, right = x >> 63;
+            uint64_t down = (x >> 1) >> (63 - shift_bits), up = (x << 1) << (63 - shift_bits);
+            if (left | right | down | up)
+            {
+                count = give(w - 1, left, walk, seen, next, words, count);
+                count = give(w + 1, right, walk, seen, next, words, count);
+                count = give(w + shift_words + 1, down, walk, seen, next, words, count);
+                count = give(w - shift_words - 1, up, walk, seen, next, words, count);
+            }
+            return count;
+        }
+
+        // Agrega a la palabra 'w' de la capa siguiente los bits transitables y no visitados de 'bits', sin saltos:
+        // 'w' siempre se escribe al final de 'words' y solo cuenta si la palabra estaba vaca y ahora no.
+        static int give(int w, uint64_t bits, const uint64_t* walk, uint64_t* seen, uint64_t* next, int* words, int count)
+        {
+            bits &= walk[w] & ~seen[w];
+            uint64_t old = next[w];
+            words[count] = w;
+            next[w] = old | bits;
+            seen[w] |= bits;
+            return count + (old == 0 && bits != 0);
+        }
+
+        // Una capa del BFS de corrido: vecinos de 'layer' transitables y no visitados, en las palabras [from, to).
+        // Cada palabra solo lee su propio 'seen', as que se marca como visitada en la misma pasada. Deja en
+        // 'words' las palabras que ganaron casillas y devuelve cuntas son.
+        static int expand(int from, int to, int shift_bits, int shift_words, const uint64_t* __restrict layer,
+            const uint64_t* __restrict walk, uint64_t* __restrict seen, uint64_t* __restrict next, int* words)
+        {
+            int count = 0, w = from;
+#ifdef GRID_BITS_AVX2
+            // Desplazar 64 bits o ms deja 0 en cada palabra, as que con 'shift_bits' 0 las palabras de al lado no aportan.
+            const __m128i row = _mm_cvtsi32_si128(shift_bits), carry = _mm_cvtsi32_si128(64 - shift_bits);
+            for (; w + 4 <= to; w += 4)
+            {
+                __m256i x = load(layer + w);
+                __m256i left = _mm256_or_si256(_mm256_slli_epi64(x, 1), _mm256_srli_epi64(load(layer + w - 1), 63));
+                __m256i right = _mm256_or_si256(_mm256_srli_epi64(x, 1), _mm256_slli_epi64(load(layer + w + 1), 63));
+                __m256i up = _mm256_or_si256(_mm256_sll_epi64(load(layer + w - shift_words), row),
+                    _mm256_srl_epi64(load(layer + w - shift_words - 1), carry));
+                __m256i down = _mm256_or_si256(_mm256_srl_epi64(load(layer + w + shift_words), row),
+                    _mm256_sll_epi64(load(layer + w + shift_words + 1), carry));
+                __m256i reached = _mm256_or_si256(_mm256_or_si256(left, right), _mm256_or_si256(up, down));
+                __m256i old = load(seen + w);
+                __m256i gained = _mm256_andnot_si256(old, _mm256_and_si256(reached, load(walk + w)));
+                _mm256_storeu_si256((__m256i*)(next + w), gained);
+                if (_mm256_testz_si256(gained, gained))
+                    continue;
+                _mm256_storeu_si256((__m256i*)(seen + w), _mm256_or_si256(old, gained));
+                // Un bit por palabra no vaca.
+                __m256i empty = _mm256_cmpeq_epi64(gained, _mm256_setzero_si256());
+                int nonzero = ~_mm256_movemask_pd(_mm256_castsi256_pd(empty)) & 15;
+                for (; nonzero; nonzero &= nonzero - 1)
+                    words[count++] = w + std::countr_zero((unsigned)nonzero);
+            }
+#endif
+            for (; w < to; w++)
+            {
+                uint64_t x = layer[w];
+                uint64_t sides = (x << 1) | (layer[w - 1] >> 63) | (x >> 1) | (layer[w + 1] << 63);
+                uint64_t rows = (layer[w - shift_words] << shift_bits) | ((layer[w - shift_words - 1] >> 1) >> (63 - shift_bits))
+                    | (layer[w + shift_words] >> shift_bits) | ((layer[w + shift_words + 1] << 1) << (63 - shift_bits));
+                uint64_t gained = (sides | rows) & walk[w] & ~seen[w];
+                next[w] = gained;
+                seen[w] |= gained;
+                words[count] = w;
+                count += gained != 0;
+            }
+            return count;
+        }
+
+#ifdef GRID_BITS_AVX2
+        static __m256i load(const uint64_t* words) { return _mm256_loadu_si256((const __m256i*)words); }
+#endif
+
+        // Escribe 'step' en la distancia de cada casilla de 'layer' en las palabras 'words' (con guardas).
+        void write_layer(const uint64_t* layer, const int* words, int count, int step, std::vector<int> &distance) const
+        {
+            for (int i = 0; i < count; i++)
+            {
+                size_t base = (size_t)(words[i] - guard) * 64;
+                for (uint64_t x = layer[words[i]]; x; x &= x - 1)
+                    distance[base + std::countr_zero(x)] = step;
+            }
+        }
+};
\ No newline at end of file
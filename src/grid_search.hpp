@@ -0,0 +1,437 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// Algoritmos de bsqueda de rutas disponibles en GridSearch. Todos devuelven rutas de largo mnimo.
+enum class PathAlgorithm {
+    Breadth, // Bsqueda en anchura: expande todo lo alcanzable hasta llegar a la meta.
+    AStar, // A* con heurstica Manhattan: expande hacia la meta.
+    JumpPoint, // Jump Point Search: A* que salta los tramos rectos, mejor en zonas abiertas.
+    Hierarchical, // HPA* sobre un ClusterGraph precalculado (ver ClusterSearch); rutas casi ptimas.
+    NextHop // Tabla precalculada de primeros pasos (ver PathDatabase); rutas mnimas sin bsqueda.
+};
+
+// Estado de una bsqueda por tramos (ver GridSearch::start_astar).
+enum class SearchStatus {
+    Running, // Quedan casillas por expandir.
+    Found, // Se lleg a la meta.
+    NotFound // No hay ruta.
+};
+
+// Estadsticas de la ltima bsqueda de un GridSearch.
+struct SearchStats {
+    int expanded = 0; // Casillas (o puntos de salto) sacadas de la frontera.
+    double milliseconds = 0.0; // Duracin de la bsqueda.
+};
+
+// GridSearch es un contexto de bsqueda reutilizable sobre una Grid. Guarda arreglos planos del tamao
+// de la grilla (padre, costo y generacin de visita por casilla) y la frontera, de modo que las bsquedas
+// repetidas no reservan memoria: marcar todo como no visitado es solo incrementar la generacin.
+// Todos los algoritmos comparten la misma firma: la ruta excluye 'start' e incluye 'goal' (casillas fila,
+// columna); se escriben en 'out' los primeros min(largo, out.size()) pasos y se devuelve el largo total
+// (0 si no hay ruta). Con un 'out' vaco sirven para obtener solo la distancia.
+// Un contexto no debe usarse desde dos hilos a la vez.
+class GridSearch {
+    public:
+        // Bsqueda con el algoritmo indicado.
+        int find_path(PathAlgorithm algorithm, const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::span<glm::ivec2> out)
+        {
+            switch (algorithm)
+            {
+                case PathAlgorithm::AStar:
+                case PathAlgorithm::Hierarchical:
+                case PathAlgorithm::NextHop: return astar(grid, start, goal, out); // Sin grafo ni tabla precalculados, se usa A*.
+                case PathAlgorithm::JumpPoint: return jump_point(grid, start, goal, out);
+                default: return breadth(grid, start, goal, out);
+            }
+        }
+
+        // Igual que la anterior, pero deja la ruta completa en 'path' (reutiliza su capacidad).
+        int find_path(PathAlgorithm algorithm, const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2> &path)
+        {
+            int length = find_path(algorithm, grid, start, goal, std::span<glm::ivec2>());
+            path.resize(length);
+            if (length > 0)
+                write_path(grid, grid.index(start.x, start.y), grid.index(goal.x, goal.y), path);
+            return length;
+        }
+
+        // Bsqueda en anchura.
+        int breadth(const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::span<glm::ivec2> out)
+        {
+            PROFILE_ZONE("GridSearch::breadth");
+            int start_index, goal_index;
+            if (!begin(grid, start, goal, start_index, goal_index))
+                return 0;
+
+            int offsets[4];
+            grid.neighbour_offsets(offsets);
+
+            int head = 0, tail = 0;
+            frontier[tail++] = start_index;
+            visit(start_index, start_index, 0);
+
+            while (head < tail)
+            {
+                int current = frontier[head++];
+                last_stats.expanded++;
+                if (current == goal_index)
+                    break;
+
+                for (int i = 0; i < 4; i++)
+                {
+                    int next = current + offsets[i];
+                    // El borde de la grilla no es transitable, as que 'next' nunca sale del arreglo.
+                    if (!grid.walkable_at(next) || visited[next] == generation)
+                        continue;
+                    visit(next, current, 0);
+                    frontier[tail++] = next;
+                }
+            }
+            return finish(grid, start_index, goal_index, out);
+        }
+
+        int breadth(const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2> &path)
+        {
+            return find_path(PathAlgorithm::Breadth, grid, start, goal, path);
+        }
+
+        // A* con heurstica Manhattan (admisible y consistente en una grilla de 4 vecinos con costo 1).
+        // Ante igual f se expande primero lo ltimo agregado, lo que favorece seguir avanzando hacia la meta.
+        int astar(const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::span<glm::ivec2> out)
+        {
+            PROFILE_ZONE("GridSearch::astar");
+            if (start_astar(grid, start, goal) == SearchStatus::NotFound)
+                return 0;
+            advance_astar(grid, INT_MAX);
+            return finish(grid, sliced_start, sliced_goal, out);
+        }
+
+        // A* por tramos: start_astar prepara la bsqueda y cada advance_astar expande a lo sumo 'max_expansions'
+        // casillas, as una bsqueda larga se reparte entre varios pasos de simulacin. Entre tramos la grilla no
+        // debe cambiar y el contexto no debe usarse para otra bsqueda. La duracin de stats() suma solo el tiempo
+        // pasado dentro de los tramos.
+        SearchStatus start_astar(const Grid &grid, glm::ivec2 start, glm::ivec2 goal)
+        {
+            if (!begin(grid, start, goal, sliced_start, sliced_goal))
+                return sliced_status = SearchStatus::NotFound;
+            visit(sliced_start, sliced_start, 0);
+            push(sliced_start, 0, heuristic(start));
+            return sliced_status = SearchStatus::Running;
+        }
+
+        SearchStatus advance_astar(const Grid &grid, int max_expansions)
+        {
+            if (sliced_status != SearchStatus::Running)
+                return sliced_status;
+            auto slice_started = std::chrono::steady_clock::now();
+
+            int offsets[4];
+            grid.neighbour_offsets(offsets);
+            static const glm::ivec2 directions[4] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+
+            while (open_count > 0 && max_expansions > 0)
+            {
+                int current = pop();
+                if (closed[current] == generation)
+                    continue;
+                closed[current] = generation;
+                last_stats.expanded++;
+                max_expansions--;
+                if (current == sliced_goal)
+                {
+                    sliced_status = SearchStatus::Found;
+                    break;
+                }
+
+                // Una sola divisin por expansin: la heurstica de los vecinos sale de la casilla actual.
+                glm::ivec2 cell = grid.cell(current);
+                int next_cost = cost[current] + 1;
+                for (int i = 0; i < 4; i++)
+                {
+                    int next = current + offsets[i];
+                    if (!grid.walkable_at(next) || (visited[next] == generation && cost[next] <= next_cost))
+                        continue;
+                    visit(next, current, next_cost);
+                    push(next, next_cost, heuristic(cell + directions[i]));
+                }
+            }
+            if (sliced_status == SearchStatus::Running && open_count == 0)
+                sliced_status = SearchStatus::NotFound;
+            sliced_time += std::chrono::steady_clock::now() - slice_started;
+            last_stats.milliseconds = std::chrono::duration<double, std::milli>(sliced_time).count();
+            return sliced_status;
+        }
+
+        // Ruta de la bsqueda por tramos terminada en 'path'. Devuelve su largo (0 si no hay ruta o no termin).
+        int astar_result(const Grid &grid, std::vector<glm::ivec2> &path)
+        {
+            int length = sliced_status == SearchStatus::Found ? write_path(grid, sliced_start, sliced_goal, std::span<glm::ivec2>()) : 0;
+            path.resize(length);
+            if (length > 0)
+                write_path(grid, sliced_start, sliced_goal, path);
+            return length;
+        }
+
+        // Jump Point Search para 4 vecinos. Las rutas cannicas hacen los movimientos verticales lo antes
+        // posible: desde una casilla a la que se lleg en vertical se sigue recto o se gira a los lados,
+        // y desde una a la que se lleg en horizontal solo se sigue recto, salvo que una pared obligue
+        // a girar (vecino forzado). Los tramos rectos sin decisiones se saltan sin pasar por la frontera.
+        int jump_point(const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::span<glm::ivec2> out)
+        {
+            PROFILE_ZONE("GridSearch::jump_point");
+            int start_index, goal_index;
+            if (!begin(grid, start, goal, start_index, goal_index))
+                return 0;
+
+            int stride = grid.stride();
+            visit(start_index, start_index, 0);
+            push(start_index, 0, heuristic(grid.cell(start_index)));
+
+            while (open_count > 0)
+            {
+                int current = pop();
+                if (closed[current] == generation)
+                    continue;
+                closed[current] = generation;
+                last_stats.expanded++;
+                if (current == goal_index)
+                    break;
+
+                // Direccin de llegada: los saltos horizontales avanzan menos que una fila.
+                int from = current - parent[current];
+                bool horizontal = from != 0 && from > -stride && from < stride;
+                bool vertical = from != 0 && !horizontal;
+
+                if (!vertical)
+                {
+                    int step = from > 0 ? 1 : -1;
+                    for (int dir = -1; dir <= 1; dir += 2)
+                    {
+                        if (horizontal && dir != step)
+                            continue;
+                        add_jump(grid, current, jump_horizontal(grid, current, dir, goal_index));
+                    }
+                    for (int dir = -stride; dir <= stride; dir += 2 * stride)
+                    {
+                        // Llegando en horizontal, el giro solo se considera si la casilla vecina del padre est bloqueada.
+                        if (horizontal && !forced(grid, current, dir, step))
+                            continue;
+                        add_jump(grid, current, jump_vertical(grid, current, dir, goal_index));
+                    }
+                }
+                else
+                {
+                    add_jump(grid, current, jump_vertical(grid, current, from > 0 ? stride : -stride, goal_index));
+                    add_jump(grid, current, jump_horizontal(grid, current, 1, goal_index));
+                    add_jump(grid, current, jump_horizontal(grid, current, -1, goal_index));
+                }
+            }
+
+            if (visited[goal_index] == generation && goal_index != start_index)
+                fill_jumps(start_index, goal_index, stride);
+            return finish(grid, start_index, goal_index, out);
+        }
+
+        // Estadsticas de la ltima bsqueda.
+        const SearchStats& stats() const { return last_stats; }
+
+    private:
+        std::vector<int> parent; // Casilla desde la que se lleg a cada casilla (en JPS, el punto de salto anterior).
+        std::vector<int> cost; // Costo desde el inicio (A* y JPS).
+        std::vector<uint32_t> visited; // Generacin en la que se visit cada casilla.
+        std::vector<uint32_t> closed; // Generacin en la que se expandi cada casilla (A* y JPS).
+        std::vector<int> frontier; // Frontera FIFO de la bsqueda en anchura: cada casilla entra una sola vez.
+        // Frontera de prioridad de A* y JPS: una cubeta por valor de f = costo + heurstica, contado desde
+        // la heurstica del inicio. Con una heurstica consistente f nunca baja, as que basta avanzar
+        // 'open_bucket'. Dentro de una cubeta se saca lo ltimo agregado, que suele ser lo de mayor costo
+        // (lo ms cercano a la meta).
+        std::vector<std::vector<int>> open;
+        int open_base = 0, open_bucket = 0, open_used = 0, open_count = 0;
+        uint32_t generation = 0;
+        int goal_row = 0, goal_col = 0;
+        SearchStats last_stats;
+        std::chrono::steady_clock::time_point started;
+        int sliced_start = 0, sliced_goal = 0; // Inicio y meta de la bsqueda por tramos.
+        SearchStatus sliced_status = SearchStatus::NotFound;
+        std::chrono::steady_clock::duration sliced_time{}; // Tiempo acumulado en los tramos.
+
+        // Valida la consulta y prepara los arreglos. Devuelve falso si no puede haber ruta.
+        bool begin(const Grid &grid, glm::ivec2 start, glm::ivec2 goal, int &start_index, int &goal_index)
+        {
+            started = std::chrono::steady_clock::now();
+            sliced_time = {};
+            last_stats = SearchStats();
+            if (!grid.in_bounds(start.x, start.y) || !grid.in_bounds(goal.x, goal.y) || start == goal)
+                return false;
+            start_index = grid.index(start.x, start.y);
+            goal_index = grid.index(goal.x, goal.y);
+            // El inicio puede no ser transitable (la casilla inicial del enemigo), pero la meta s debe serlo.
+            if (!grid.walkable_at(goal_index))
+                return false;
+
+            prepare(grid);
+            goal_row = goal.x;
+            goal_col = goal.y;
+            for (int i = 0; i < open_used; i++)
+                open[i].clear();
+            open_base = heuristic(start);
+            open_bucket = open_used = open_count = 0;
+            return true;
+        }
+
+        // Registra la duracin y escribe la ruta si se lleg a la meta.
+        int finish(const Grid &grid, int start_index, int goal_index, std::span<glm::ivec2> out)
+        {
+            int length = 0;
+            if (visited[goal_index] == generation)
+                length = write_path(grid, start_index, goal_index, out);
+            last_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+            return length;
+        }
+
+        // Ajusta los arreglos al tamao de la grilla (solo reserva si la grilla cambi) y abre una nueva generacin.
+        void prepare(const Grid &grid)
+        {
+            if (visited.size() != grid.size())
+            {
+                parent.assign(grid.size(), -1);
+                cost.assign(grid.size(), 0);
+                visited.assign(grid.size(), 0);
+                closed.assign(grid.size(), 0);
+                frontier.assign(grid.size(), 0);
+                generation = 0;
+            }
+            if (++generation == 0)
+            {
+                std::fill(visited.begin(), visited.end(), 0);
+                std::fill(closed.begin(), closed.end(), 0);
+                generation = 1;
+            }
+        }
+
+        void visit(int index, int from, int path_cost)
+        {
+            visited[index] = generation;
+            parent[index] = from;
+            cost[index] = path_cost;
+        }
+
+        // Distancia Manhattan desde una casilla (fila, columna) hasta la meta.
+        int heuristic(glm::ivec2 cell) const
+        {
+            return std::abs(cell.x - goal_row) + std::abs(cell.y - goal_col);
+        }
+
+        void push(int index, int path_cost, int estimate)
+        {
+            int bucket = std::max(path_cost + estimate - open_base, open_bucket);
+            if (bucket >= (int)open.size())
+                open.resize(bucket + 1);
+            open[bucket].push_back(index);
+            open_used = std::max(open_used, bucket + 1);
+            open_count++;
+        }
+
+        int pop()
+        {
+            while (open[open_bucket].empty())
+                open_bucket++;
+            int index = open[open_bucket].back();
+            open[open_bucket].pop_back();
+            open_count--;
+            return index;
+        }
+
+        // Verdadero si, avanzando en horizontal con paso 'step', la casilla vecina en la direccin vertical
+        // 'dir' de 'index' es transitable pero la misma vecina del padre no: no hay otra ruta igual de corta.
+        static bool forced(const Grid &grid, int index, int dir, int step)
+        {
+            return grid.walkable_at(index + dir) && !grid.walkable_at(index + dir - step);
+        }
+
+        // Salta en horizontal desde 'index'. Devuelve el primer punto de salto (la meta o una casilla con
+        // un vecino forzado) o -1 si se llega a un obstculo.
+        static int jump_horizontal(const Grid &grid, int index, int step, int goal_index)
+        {
+            int stride = grid.stride();
+            while (true)
+            {
+                index += step;
+                if (!grid.walkable_at(index))
+                    return -1;
+                if (index == goal_index || forced(grid, index, -stride, step) || forced(grid, index, stride, step))
+                    return index;
+            }
+        }
+
+        // Salta en vertical desde 'index'. Una casilla es punto de salto si es la meta o si alguno de los
+        // saltos horizontales que parten de ella encuentra un punto de salto.
+        static int jump_vertical(const Grid &grid, int index, int step, int goal_index)
+        {
+            while (true)
+            {
+                index += step;
+                if (!grid.walkable_at(index))
+                    return -1;
+                if (index == goal_index || jump_horizontal(grid, index, 1, goal_index) >= 0 || jump_horizontal(grid, index, -1, goal_index) >= 0)
+                    return index;
+            }
+        }
+
+        // Agrega a la frontera el punto de salto 'jump' alcanzado en lnea recta desde 'current'.
+        void add_jump(const Grid &grid, int current, int jump)
+        {
+            if (jump < 0)
+                return;
+            int distance = std::abs(jump - current);
+            if (distance >= grid.stride())
+                distance /= grid.stride();
+            int jump_cost = cost[current] + distance;
+            if (visited[jump] == generation && cost[jump] <= jump_cost)
+                return;
+            visit(jump, current, jump_cost);
+            push(jump, jump_cost, heuristic(grid.cell(jump)));
+        }
+
+        // Completa los padres de las casillas intermedias de cada salto de la ruta final, para que
+        // write_path la recorra casilla por casilla.
+        void fill_jumps(int start_index, int goal_index, int stride)
+        {
+            int index = goal_index;
+            while (index != start_index)
+            {
+                int jump_from = parent[index];
+                int step = index - jump_from;
+                step = std::abs(step) >= stride ? (step > 0 ? stride : -stride) : (step > 0 ? 1 : -1);
+                for (int i = index; i != jump_from; i -= step)
+                    parent[i] = i - step;
+                index = jump_from;
+            }
+        }
+
+        // Recorre los padres desde 'goal' para medir la ruta y escribe sus primeros pasos en orden.
+        int write_path(const Grid &grid, int start_index, int goal_index, std::span<glm::ivec2> out)
+        {
+            int length = 0;
+            for (int i = goal_index; i != start_index; i = parent[i])
+                length++;
+
+            int step = length;
+            for (int i = goal_index; i != start_index; i = parent[i])
+            {
+                step--;
+                if (step < (int)out.size())
+                    out[step] = grid.cell(i);
+            }
+            return length;
+        }
+};
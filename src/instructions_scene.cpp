@@ -4,8 +4,6 @@ InstructionsScene::InstructionsScene(Context &ctx) : ctx(ctx)
 {
     camera = CameraOrtho(glm::vec3(0.0f, 0.0f, 0.0f), ctx.win_width, ctx.win_height);
 
-    stbi_set_flip_vertically_on_load(true);
-    load_texture("./assets/textures/instructions.png", instructions_texture);
     shape.transform.scale.x = ctx.win_width;
     shape.transform.scale.y = ctx.win_height;
     instructions_shader = Shader("button.vs", "button.fs");
@@ -14,7 +12,7 @@ InstructionsScene::InstructionsScene(Context &ctx) : ctx(ctx)
 
 void InstructionsScene::store_scene_in_ctx()
 {
-    ctx.scenes.push_back(this);
+    ctx.store_scene(this);
 }
 
 void InstructionsScene::open_scene() 
@@ -24,12 +22,22 @@ void InstructionsScene::open_scene()
 
 void InstructionsScene::close_scene() { return; }
 
-void InstructionsScene::update()
+// La textura se carga al abrir la escena y se libera al cerrarla.
+void InstructionsScene::begin_load()
+{
+    stbi_set_flip_vertically_on_load(true);
+    load_texture("./assets/textures/instructions.png", instructions_texture);
+}
+
+void InstructionsScene::unload()
 {
-    double currentTime = glfwGetTime();
-    deltaTime = currentTime - lastFrame;
-    lastFrame = currentTime;
+    glDeleteTextures(1, &instructions_texture);
+}
 
+void InstructionsScene::fixed_update(float delta_time) {}
+
+void InstructionsScene::update()
+{
     instructions_shader.use();
 
     glActiveTexture(GL_TEXTURE0);
@@ -16,9 +16,12 @@ class InstructionsScene : public IScene {
         void store_scene_in_ctx() override; // Almacena la escena en el contexto global.
         void open_scene() override; // Se llama al abrir la escena, inicializa recursos.
         void close_scene() override; // Se llama al cerrar la escena, libera recursos.
-        void update() override; // Actualiza la lgica de la escena en cada frame.
+        void fixed_update(float delta_time) override; // Avanza la simulacin un paso fijo (vaco en esta escena).
+        void update() override; // Renderiza la escena en cada frame.
         void scene_clear() override; // Limpia la escena.
         void process_input() override; // Procesa la entrada del usuario.
+        void begin_load() override; // Carga la textura de la escena.
+        void unload() override; // Libera la textura de la escena.
 
         // Callbacks para manejar eventos de entrada especficos.
         void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) override;
@@ -30,9 +33,6 @@ class InstructionsScene : public IScene {
         Context& ctx; // Referencia al contexto de la aplicacin.
 
     private:
-        float deltaTime = 0.0f; // Tiempo entre el frame actual y el ltimo frame.
-        float lastFrame = 0.0f; // Tiempo en el que el ltimo frame fue procesado.
-
         CameraOrtho camera; // Cmara ortogrfica para la renderizacin 2D.
         Shader instructions_shader; // Shader utilizado para renderizar las instrucciones.
         MyRectangle shape; // Forma geomtrica utilizada para renderizar las instrucciones.
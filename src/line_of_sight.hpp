@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// Cono de visin: alcance en casillas y semingulo de apertura en radianes (pi = ve en todas direcciones).
+struct ViewCone {
+    float range = 5.0f;
+    float half_angle = 1.0471976f; // 60 grados.
+};
+
+// LineOfSight responde consultas de lnea de visin sobre la grilla con el recorrido DDA de Amanatides y
+// Woo: avanza de casilla en casilla por donde cruza el segmento y se detiene en la primera casilla opaca.
+// Si el segmento pasa justo por una esquina, basta que una de las dos casillas laterales sea opaca para
+// bloquear la vista (no se ve por la rendija entre dos paredes en diagonal). Las casillas de los extremos
+// no bloquean: se puede ver una pared.
+// Las consultas entre casillas se guardan en una cach asociativa de dos vas indexada por el par (sin orden,
+// porque la visin entre centros de casilla es simtrica) que solo se descarta al editar el mapa, as las
+// consultas repetidas de cada paso de simulacin cuestan una lectura.
+// Las coordenadas son (fila, columna) como en la Grid; el centro de cada casilla est en coordenadas enteras.
+// La cach se escribe al consultar: una instancia no debe usarse desde dos hilos a la vez.
+class LineOfSight {
+    public:
+        // 'cache_bits' fija el tamao de la cach en 2^cache_bits pares (al menos 1).
+        LineOfSight(int cache_bits = 14) { set_cache_size(cache_bits); }
+
+        void set_cache_size(int cache_bits)
+        {
+            cache_bits = std::max(cache_bits, 1);
+            cache.assign((size_t)1 << cache_bits, Entry());
+            shift = 64 - cache_bits;
+            generation = 1;
+        }
+
+        // Descarta la cach (por ejemplo, al cambiar una casilla del mapa).
+        void invalidate()
+        {
+            if (++generation == 0)
+            {
+                std::fill(cache.begin(), cache.end(), Entry());
+                generation = 1;
+            }
+        }
+
+        // Verdadero si hay lnea de visin entre los centros de las casillas 'from' y 'to', usando la cach.
+        bool visible(const Grid &grid, glm::ivec2 from, glm::ivec2 to)
+        {
+            if (!grid.in_bounds(from.x, from.y) || !grid.in_bounds(to.x, to.y))
+                return false;
+            if (&grid != cached_grid || grid.size() != cached_size)
+            {
+                cached_grid = &grid;
+                cached_size = grid.size();
+                invalidate();
+            }
+
+            uint32_t a = (uint32_t)grid.index(from.x, from.y);
+            uint32_t b = (uint32_t)grid.index(to.x, to.y);
+            if (a > b)
+                std::swap(a, b);
+            // Cach asociativa de dos vas: cada par puede estar en dos entradas contiguas. Un par nuevo entra en
+            // la primera y el que estaba all pasa a la segunda, as la entrada descartada es la ms antigua.
+            uint64_t key = ((uint64_t)a << 32) | b;
+            Entry* set = &cache[((key * 0x9E3779B97F4A7C15ull) >> shift) & ~(size_t)1];
+            for (int way = 0; way < 2; way++)
+            {
+                if (set[way].generation == generation && set[way].key == key)
+                {
+                    hit_count++;
+                    return set[way].visible;
+                }
+            }
+            miss_count++;
+            set[1] = set[0];
+            Entry &entry = set[0];
+            entry.key = key;
+            entry.generation = generation;
+            entry.visible = trace(grid, from, to);
+            return entry.visible;
+        }
+
+        // Verdadero si un observador en 'eye' mirando hacia 'facing' ve el punto 'target': dentro del alcance y
+        // del semingulo del cono, y con lnea de visin entre sus casillas.
+        bool can_see(const Grid &grid, glm::vec2 eye, glm::vec2 facing, glm::vec2 target, const ViewCone &cone)
+        {
+            glm::vec2 to_target = target - eye;
+            float distance = glm::length(to_target);
+            if (distance > cone.range)
+                return false;
+            float facing_length = glm::length(facing);
+            if (distance > 1e-4f && facing_length > 1e-4f
+                && glm::dot(to_target, facing) < std::cos(cone.half_angle) * distance * facing_length)
+                return false;
+            return visible(grid, tile_of(eye), tile_of(target));
+        }
+
+        // Recorrido DDA entre los centros de dos casillas, sin cach. Todo en enteros: los cruces de borde se
+        // comparan multiplicados por 2|filas||columnas|, as los empates en esquinas son exactos.
+        static bool trace(const Grid &grid, glm::ivec2 from, glm::ivec2 to)
+        {
+            PROFILE_ZONE("LineOfSight::trace");
+            int rows = std::abs(to.x - from.x);
+            int cols = std::abs(to.y - from.y);
+            int row_step = to.x > from.x ? grid.stride() : -grid.stride();
+            int col_step = to.y > from.y ? 1 : -1;
+
+            int index = grid.index(from.x, from.y);
+            int end = grid.index(to.x, to.y);
+            // Prximo cruce de borde horizontal y vertical, escalados: (2k + 1)cols y (2k + 1)rows.
+            int64_t next_row = rows > 0 ? cols : INT64_MAX;
+            int64_t next_col = cols > 0 ? rows : INT64_MAX;
+            for (int steps = rows + cols; steps > 0 && index != end; )
+            {
+                if (next_row < next_col)
+                {
+                    index += row_step;
+                    next_row += 2 * (int64_t)cols;
+                    steps--;
+                }
+                else if (next_col < next_row)
+                {
+                    index += col_step;
+                    next_col += 2 * (int64_t)rows;
+                    steps--;
+                }
+                else
+                {
+                    // Esquina: se pasa en diagonal si ninguna de las dos casillas laterales es opaca.
+                    if (grid.test(Grid::Opaque, index + row_step) || grid.test(Grid::Opaque, index + col_step))
+                        return false;
+                    index += row_step + col_step;
+                    next_row += 2 * (int64_t)cols;
+                    next_col += 2 * (int64_t)rows;
+                    steps -= 2;
+                }
+                if (index != end && grid.test(Grid::Opaque, index))
+                    return false;
+            }
+            return true;
+        }
+
+        // Casilla (fila, columna) que contiene un punto.
+        static glm::ivec2 tile_of(glm::vec2 point) { return { (int)std::round(point.x), (int)std::round(point.y) }; }
+
+        // Consultas resueltas por la cach y recorridas desde la creacin.
+        uint64_t hits() const { return hit_count; }
+        uint64_t misses() const { return miss_count; }
+
+    private:
+        struct Entry {
+            uint64_t key = 0; // ndices de las dos casillas en la grilla (a <= b): (a << 32) | b.
+            uint32_t generation = 0; // Generacin de la cach en la que se calcul (0: vaca).
+            bool visible = false;
+        };
+
+        std::vector<Entry> cache;
+        int shift = 50;
+        uint32_t generation = 1;
+        const Grid* cached_grid = nullptr;
+        size_t cached_size = 0;
+        uint64_t hit_count = 0;
+        uint64_t miss_count = 0;
+};
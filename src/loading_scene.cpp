@@ -0,0 +1,103 @@
+#include "loading_scene.hpp"
+
+// Crea una textura de un solo pxel del color indicado.
+static unsigned int solid_texture(unsigned char r, unsigned char g, unsigned char b)
+{
+    unsigned char pixel[4] = { r, g, b, 255 };
+    unsigned int texture;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return texture;
+}
+
+LoadingScene::LoadingScene(Context &ctx) : ctx(ctx)
+{
+    camera = CameraOrtho(glm::vec3(0.0f, 0.0f, 0.0f), ctx.win_width, ctx.win_height);
+
+    frame_texture = solid_texture(60, 60, 60);
+    bar_texture = solid_texture(220, 220, 220);
+
+    frame.transform.position.y = -ctx.win_height / 4;
+    frame.transform.scale.x = bar_width;
+    frame.transform.scale.y = bar_height;
+    bar.transform.position.y = frame.transform.position.y;
+    bar.transform.scale.y = bar_height;
+
+    bar_shader = Shader("button.vs", "button.fs");
+    store_scene_in_ctx();
+}
+
+void LoadingScene::store_scene_in_ctx()
+{
+    ctx.loading_scene = this;
+}
+
+// Mientras se muestra la pantalla de carga no hay otra cosa que hacer en el hilo principal,
+// as que se le da ms tiempo por frame a los trabajos de carga.
+void LoadingScene::open_scene()
+{
+    glDisable(GL_DEPTH_TEST);
+    glfwSetInputMode(ctx.window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+    saved_job_budget = ctx.main_job_budget;
+    ctx.main_job_budget = 0.012;
+}
+
+void LoadingScene::close_scene()
+{
+    ctx.main_job_budget = saved_job_budget;
+}
+
+void LoadingScene::fixed_update(float delta_time) {}
+
+void LoadingScene::update()
+{
+    if (ctx.loading_target < 0)
+        return;
+
+    float progress = ctx.get_scene(ctx.loading_target)->load_progress();
+    if (progress >= 1.0f)
+    {
+        ctx.load_scene_id(ctx.loading_target);
+        return;
+    }
+
+    bar_shader.use();
+    glActiveTexture(GL_TEXTURE0);
+    bar_shader.set_int("texture0", 0);
+    bar_shader.set_bool("hovered", false);
+
+    glBindTexture(GL_TEXTURE_2D, frame_texture);
+    frame.render(bar_shader, camera);
+
+    // La parte completada crece desde el borde izquierdo del fondo.
+    bar.transform.scale.x = bar_width * progress;
+    bar.transform.position.x = frame.transform.position.x - (bar_width - bar.transform.scale.x) / 2;
+    glBindTexture(GL_TEXTURE_2D, bar_texture);
+    bar.render(bar_shader, camera);
+}
+
+void LoadingScene::scene_clear()
+{
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+void LoadingScene::process_input() {}
+
+void LoadingScene::mouse_callback(GLFWwindow* window, double xposIn, double yposIn) {}
+
+void LoadingScene::left_click_callback(GLFWwindow* window, int button, int action, int mods) {}
+
+void LoadingScene::scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {}
+
+void LoadingScene::framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    glViewport(0, 0, width, height);
+    camera.width = width;
+    camera.height = height;
+    frame.transform.position.y = -height / 4.0f;
+    bar.transform.position.y = frame.transform.position.y;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+// Inclusin de las dependencias necesarias para la pantalla de carga.
+#include "mygl/shader.h"
+#include "mygl/shape.hpp"
+#include "mygl/camera_ortho.hpp"
+#include "mygl/iscene.hpp"
+#include "mygl/context.hpp"
+
+// LoadingScene es la pantalla que se muestra mientras termina de cargarse otra escena (ctx.loading_target).
+// Dibuja una barra de progreso y cambia a la escena esperada cuando su carga llega al 100%.
+// No forma parte del vector de escenas: se guarda en ctx.loading_scene.
+class LoadingScene : public IScene {
+    public:
+        LoadingScene(Context &ctx);
+
+        // Mtodos heredados de IScene para gestionar el ciclo de vida de la escena.
+        void store_scene_in_ctx() override; // Registra la escena como pantalla de carga del contexto.
+        void open_scene() override; // Aumenta el tiempo por frame dedicado a los trabajos de carga.
+        void close_scene() override; // Restaura el tiempo por frame de los trabajos de carga.
+        void fixed_update(float delta_time) override; // Vaco en esta escena.
+        void update() override; // Dibuja la barra de progreso y cambia de escena al terminar la carga.
+        void scene_clear() override; // Limpia la escena.
+        void process_input() override; // Procesa la entrada del usuario.
+
+        // Callbacks para manejar eventos de entrada especficos.
+        void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) override;
+        void left_click_callback(GLFWwindow* window, int button, int action, int mods) override;
+        void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) override;
+        void framebuffer_size_callback(GLFWwindow* window, int width, int height) override;
+
+    public:
+        Context& ctx; // Referencia al contexto de la aplicacin.
+
+    private:
+        CameraOrtho camera; // Cmara ortogrfica para la renderizacin 2D.
+        Shader bar_shader; // Shader utilizado para dibujar la barra.
+        MyRectangle frame; // Fondo de la barra de progreso.
+        MyRectangle bar; // Parte completada de la barra de progreso.
+        unsigned int frame_texture; // Textura de un pxel gris para el fondo de la barra.
+        unsigned int bar_texture; // Textura de un pxel blanco para la parte completada.
+        double saved_job_budget = 0.0; // Tiempo por frame de los trabajos del hilo principal antes de abrir la escena.
+
+        float bar_width = 600.0f; // Ancho total de la barra en pxeles.
+        float bar_height = 16.0f; // Alto de la barra en pxeles.
+};
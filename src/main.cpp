@@ -13,6 +13,7 @@
 #include "game_scene.hpp"
 #include "instructions_scene.hpp"
 #include "credits_scene.hpp"
+#include "loading_scene.hpp"
 
 // Funcin principal del programa.
 int main()
@@ -21,18 +22,26 @@ int main()
     Context ctx;
     glfwSwapInterval(1); // Habilita VSync para sincronizar la tasa de refresco con la tasa de frames.
 
-    // Creacin de las escenas del juego. Cada escena representa una pantalla diferente en la aplicacin.
-    MenuScene menu(ctx); // Escena del men principal - idx 0
-    GameScene scene(ctx); // Escena del juego en s - idx 1
-    InstructionsScene instructions(ctx); // Escena de instrucciones - idx 2
-    CreditsScene credits(ctx); // Escena de crditos - idx 3
+    // Registro de las escenas del juego. Cada escena representa una pantalla diferente en la aplicacin y
+    // se construye recin cuando se necesita. Instrucciones y crditos liberan su textura al cerrarse.
+    ctx.add_scene([&ctx] { return new MenuScene(ctx); }); // Escena del men principal - idx 0
+    ctx.add_scene([&ctx] { return new GameScene(ctx); }); // Escena del juego en s - idx 1
+    ctx.add_scene([&ctx] { return new InstructionsScene(ctx); }, true); // Escena de instrucciones - idx 2
+    ctx.add_scene([&ctx] { return new CreditsScene(ctx); }, true); // Escena de crditos - idx 3
+    LoadingScene loading(ctx); // Pantalla de carga, se muestra si se entra a una escena que an no termin de cargarse.
 
     // Carga y muestra la primera escena (men principal) al iniciar el programa.
-    ctx.load_scene(ctx.scenes[0]);
+    ctx.load_scene_id(0);
+
+    // La escena del juego empieza a cargarse en segundo plano mientras se muestra el men.
+    ctx.preload_scene(1);
     // Ejecuta el bucle principal del programa, gestionando la renderizacin y actualizacin de las escenas.
     ctx.run();
 
-    // Limpieza y liberacin de recursos de GLFW antes de terminar el programa.
+    // Detiene los hilos trabajadores, libera el staging de subidas y los recursos de GLFW antes de terminar el programa.
+    ctx.jobs.shutdown();
+    ctx.delete_scenes();
+    ctx.uploads.shutdown();
     glfwTerminate();
     return 0;
 }
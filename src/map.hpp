@@ -6,158 +6,242 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <memory>
+#include <string>
+#include <random>
+#include <thread>
 #include <stb_image.h>
 #include "mygl/shape.hpp"
+#include "mygl/profiler.hpp"
+#include "mygl/job_system.hpp"
+#include "grid.hpp"
+#include "flow_field.hpp"
+#include "cluster_graph.hpp"
+#include "path_database.hpp"
+#include "line_of_sight.hpp"
+#include "path_service.hpp"
+#include "walkable_index.hpp"
+#include "crowd.hpp"
+#include "ai_scheduler.hpp"
+#include "noise_map.hpp"
+#include "grid_bits.hpp"
+#include "nav_mesh_builder.hpp"
+#include "collision_world.hpp"
+#include "mesh_bvh.hpp"
+#include "registry.hpp"
+
+// Tipo de objeto del mapa: qu casilla lo genera y cmo se arma su entidad.
+struct PropType {
+    Tile tile; // Casilla del archivo de mapa que lo genera.
+    const char* model; // Modelo 3D. Se carga una sola vez aunque lo usen varios tipos o muchas entidades.
+    bool flip; // Invertir las texturas del modelo al cargarlas.
+    float scale;
+    float height; // Altura sobre el suelo.
+    bool faces_player; // Gira para mirar al jugador (FacePlayer).
+    float yaw_offset; // Correccin del giro segn hacia dnde mira el modelo.
+    bool solid; // Choca con el jugador (Collider con la malla del modelo).
+};
+
+// Tabla de tipos de objeto. Una casilla puede generar varias entidades: la meta es la jaula y el hermano.
+inline const std::vector<PropType>& prop_types()
+{
+    static const std::vector<PropType> types = {
+        { Tile::Wall, "./assets/models/wall/wall.obj", true, 1.0f, 0.0f, false, 0.0f, false },
+        { Tile::Goal, "./assets/models/cage/Cage.obj", true, 0.5f, 0.0f, false, 0.0f, false },
+        { Tile::StatueA, "./assets/models/statue/untitled2.obj", false, 0.4f, 0.03f, true, -(float)M_PI / 2.0f, true },
+        { Tile::StatueB, "./assets/models/statue2/untitled.obj", false, 0.5f, 0.03f, true, 0.0f, true },
+        { Tile::StatueC, "./assets/models/statue3/untitled.obj", false, 1.0f, 0.03f, true, -(float)M_PI, true },
+        { Tile::StatueD, "./assets/models/statue4/untitled.obj", false, 0.5f, 0.05f, true, -(float)M_PI / 2.0f, true },
+        { Tile::Goal, "./assets/models/brother/maya2sketchfab.obj", false, 0.006f, 0.06f, false, 0.0f, false },
+    };
+    return types;
+}
 
 class Map {
     public:
         // Almacena la representacin del mapa en texto y las posiciones de elementos clave.
-        std::vector<std::vector<char>> txt_map; // Representacin del mapa como una matriz de caracteres.
-        std::vector<glm::vec3> walls_position; // Posiciones de las paredes en el mapa.
+        Grid grid; // Representacin del mapa como una grilla contigua de casillas.
         glm::vec3 player_position = { 0.0f, 0.5f, 0.0f }; // Posicin actual del jugador.
         glm::vec3 player_start_position = { 0.0f, 0.5f, 0.0f }; // Posicin inicial del jugador.
         glm::vec3 win_position; // Posicin de la meta.
-        glm::vec3 statue_position; // Posiciones de estatuas y enemigos.
-        glm::vec3 statue2_position;
-        glm::vec3 statue3_position;
-        glm::vec3 statue4_position;
-        glm::vec3 enemy_position;
+        glm::vec3 enemy_position; // Posiciones del enemigo.
         glm::vec3 enemy_start_position;
+        FlowField player_field; // Distancias y pasos hacia la casilla del jugador, compartidos por los enemigos.
+        ClusterGraph clusters; // Grafo de clusters para la bsqueda jerrquica de rutas.
+        PathDatabase paths; // Tabla de primeros pasos entre todas las casillas (solo en mapas chicos y medianos).
+        LineOfSight sight; // Consultas de lnea de visin entre casillas, con cach.
+        PathService routes; // Pedidos de rutas asncronos, resueltos en lote por los hilos trabajadores.
+        WalkableIndex walkable; // Casillas transitables agrupadas por regin conexa, para elegir metas alcanzables.
+        Crowd crowd; // Desplazamiento conjunto de los enemigos, sin que se encimen.
+        AiScheduler ai; // Frecuencia de actualizacin de la IA de cada enemigo segn su distancia al jugador.
+        NoiseMap hearing; // Ruidos del jugador propagados por la grilla, para que los enemigos los oigan.
+        GridBits bits; // Alcance, distancias y regiones sobre todo el mapa con el bitset de casillas transitables.
+        NavMesh navmesh; // Malla de navegacin de los niveles hechos con modelos, sin grilla de texto.
+        CollisionWorld collision; // Colisiones contra las paredes y cuerpos del mapa (meta, enemigos, objetos).
+        int goal_body = -1; // Cuerpo de la meta en 'collision'.
+        Registry entities; // Paredes, estatuas y meta, generadas a partir de los caracteres del archivo de mapa.
+
+        // Constructor: no carga nada; la carga se programa con load_async.
+        Map() { entities.collision = &collision; }
+
+        // Programa la carga del mapa en el JobSystem y agrega sus trabajos a 'jobs'. La lectura del archivo
+        // y la importacin de los modelos corren en hilos trabajadores; la subida de los modelos y la
+        // disposicin de los elementos (load_map) en el hilo principal. Devuelve el trabajo de disposicin:
+        // cuando termina, las posiciones del mapa ya son vlidas.
+        JobHandle load_async(std::vector<JobHandle> &jobs)
+        {
+            PROFILE_ZONE("Map::load_async");
+            JobSystem &job_system = JobSystem::get();
+            // Con un solo ncleo el trabajador le quita tiempo al hilo principal: las rutas se buscan por tramos en l.
+            routes.mode = std::thread::hardware_concurrency() <= 1 ? PathServiceMode::TimeSliced : PathServiceMode::Workers;
+
+            std::vector<JobHandle> uploads = load_models(); // Antes de load_map, que necesita los modelos de cada tipo.
+            JobHandle map_file = job_system.schedule([this] { read_map_file("./assets/final_map.txt"); });
+            JobHandle layout = job_system.schedule([this] {
+                stbi_set_flip_vertically_on_load(true); // La textura del suelo espera la inversin activada.
+                load_map();
+            }, { map_file }, JobAffinity::Main);
+            std::vector<JobHandle> collider_dependencies = uploads;
+            collider_dependencies.push_back(layout);
+            JobHandle colliders = job_system.schedule([this] { build_colliders(); }, collider_dependencies);
+
+            jobs.push_back(map_file);
+            jobs.insert(jobs.end(), uploads.begin(), uploads.end());
+            jobs.push_back(layout);
+            jobs.push_back(colliders);
+
+            return layout;
+        }
+
+        // Libera los recursos OpenGL del mapa y descarta su contenido para poder cargarlo de nuevo.
+        void release()
+        {
+            routes.clear();
+            for (std::unique_ptr<Model> &model : models)
+                model->release();
+            models.clear();
+            shapes.clear();
+            type_models.clear();
+            entities.clear();
+            glDeleteTextures(1, &floor.diffuse_texture);
+            floor.diffuse_texture = 0;
+            floor.transform = Transform();
+            grid.clear();
+            player_field.invalidate();
+            clusters.clear();
+            paths.clear();
+            sight.invalidate();
+            walkable.clear();
+            crowd.clear();
+            ai.clear();
+            hearing.clear();
+            bits.clear();
+            navmesh.clear();
+            collision.clear();
+            goal_body = -1;
+        }
 
-        // Constructor: carga el mapa y las texturas.
-        Map()
+        // Cambia una casilla del mapa y actualiza las estructuras de bsqueda que dependen de ella.
+        void set_tile(int row, int col, Tile tile)
         {
-            read_map_file("./assets/final_map.txt"); // Lee el archivo de mapa.
-            stbi_set_flip_vertically_on_load(false); // Configura la carga de texturas.
-            // Carga modelos 3D para elementos del mapa.
-            statue = Model("./assets/models/statue/untitled2.obj");
-            statue2 = Model("./assets/models/statue2/untitled.obj");
-            statue3 = Model("./assets/models/statue3/untitled.obj");
-            statue4 = Model("./assets/models/statue4/untitled.obj");
-            brother = Model("./assets/models/brother/maya2sketchfab.obj");
-            stbi_set_flip_vertically_on_load(true);
-            wall = Model("./assets/models/wall/wall.obj");
-            cage = Model("./assets/models/cage/Cage.obj");
+            routes.invalidate(); // Ninguna bsqueda debe estar leyendo la grilla mientras cambia.
+            grid.set_tile(row, col, tile);
+            clusters.rebuild(grid, row, col);
+            walkable.build(grid); // Una casilla puede unir o separar regiones: se vuelve a etiquetar todo.
+            bits.build(grid);
+            player_field.invalidate();
+            sight.invalidate();
+            hearing.invalidate();
+            paths.clear(); // Reconstruir la tabla es costoso: hasta la prxima carga, las rutas se buscan.
+        }
+
+        // Actualiza el campo de distancias hacia el jugador. Solo se recalcula si el jugador cambi de casilla.
+        void update_player_field()
+        {
+            player_field.update(grid, { int(std::round(player_position.z)), int(std::round(player_position.x)) });
+        }
+
+        // Despacha los pedidos de rutas del paso a los hilos trabajadores.
+        void dispatch_routes()
+        {
+            routes.dispatch(grid, clusters, paths);
         }
 
         // Renderiza el mapa y sus elementos.
         void render(Shader shader, Shader shader2, const ICamera &camera)
         {
-            // Renderiza las paredes, la jaula, las estatuas, el suelo y el techo.
-            // Tambin ajusta la rotacin de las estatuas para que miren hacia el jugador.
-            for (auto &pos : walls_position)
+            // Gira las estatuas hacia el jugador y renderiza las entidades, el suelo y el techo.
+            PROFILE_ZONE("Map::render");
+            face_player();
+            entities.transforms.update(); // Solo recalcula las matrices de lo que cambi (las estatuas que giraron).
+
+            for (size_t i = 0; i < entities.renderables.size(); i++)
             {
-                wall.transform.position = pos;
-                wall.draw(shader, camera);
+                Entity entity = entities.renderables.owner(i);
+                entities.renderables[i].model->draw(shader, camera, entities.transforms.world(entity), entities.transforms.normal(entity));
             }
 
-            cage.draw(shader, camera);
-            statue.draw(shader, camera);
-            statue2.draw(shader, camera);
-            statue3.draw(shader, camera);
-            statue4.draw(shader, camera);
-            brother.draw(shader, camera);
-
             floor.transform.position = floor_position;
             floor.render(shader2, camera);
             floor.transform.position = roof_position;
             floor.render(shader2, camera);
-            
-            glm::vec3 direction_to_player = glm::normalize(player_position - statue_position);
-            float angle = atan2(direction_to_player.x, direction_to_player.z) - M_PI / 2.0f;
-            statue.transform.rotation.y = angle;
-        
-            glm::vec3 direction_to_player2 = glm::normalize(player_position - statue2_position);
-            float angle2 = atan2(direction_to_player2.x, direction_to_player2.z);
-            statue2.transform.rotation.y = angle2;
-
-            glm::vec3 direction_to_player3 = glm::normalize(player_position - statue3_position);
-            float angle3 = atan2(direction_to_player3.x, direction_to_player3.z) - M_PI;
-            statue3.transform.rotation.y = angle3;
-
-            glm::vec3 direction_to_player4 = glm::normalize(player_position - statue4_position);
-            float angle4 = atan2(direction_to_player4.x, direction_to_player4.z) - M_PI / 2;
-            statue4.transform.rotation.y = angle4;
         }
 
         // Carga el mapa desde el archivo de texto y configura las posiciones iniciales de los elementos.
         void load_map() 
         {
-            // Configura las posiciones iniciales de paredes, estatuas, enemigos, etc; basndose en el archivo de mapa.
+            // Crea las entidades de paredes, estatuas y meta y configura las posiciones iniciales, basndose en el archivo de mapa.
+            PROFILE_ZONE("Map::load_map");
             glm::vec3 position = {0.0f, 0.0f, 0.0f};
             floor.add_texture("./assets/textures/seamless_soil.jpg", floor.diffuse_texture);
-            floor.transform.scale.x *= txt_map[0].size();
-            floor.transform.scale.z *= txt_map.size();
+            floor.transform.scale.x *= grid.cols();
+            floor.transform.scale.z *= grid.rows();
             floor.transform.scale.y *= 0.1f;
-            floor.transform.position.x += txt_map[0].size() / 2;
-            floor.transform.position.z += txt_map.size() / 2;
+            floor.transform.position.x += grid.cols() / 2;
+            floor.transform.position.z += grid.rows() / 2;
             floor_position = {floor.transform.position.x, floor.transform.position.y, floor.transform.position.z};
             roof_position = {floor.transform.position.x, floor.transform.position.y + 2.0f, floor.transform.position.z};
 
-            for (const auto &row : txt_map)
+            for (int row = 0; row < grid.rows(); row++)
             {  
-               for (const auto &element : row)
+               for (int col = 0; col < grid.cols(); col++)
                {
-                    switch (element)
+                    Tile tile = grid.tile(row, col);
+                    spawn(tile, position);
+                    switch (tile)
                     {
-                        case '#':
-                            walls_position.push_back(position);
-                            break;
-                        case '@':
+                        case Tile::PlayerStart:
                             player_start_position = {position.x, player_position.y, position.z};
                             break;
-                        case 'w':
+                        case Tile::Goal:
                             win_position = position;
                             break;
-                        case 'A':
-                            statue_position = {position.x, 0.03f, position.z};
-                            break;
-                        case 'B':
-                            statue2_position = {position.x, 0.03f, position.z};
-                            break;
-                        case 'C':
-                            statue3_position = {position.x, 0.03f, position.z};
-                            break;
-                        case 'D':
-                            statue4_position = {position.x, 0.05f, position.z};
-                            break;
-                        case '&':
+                        case Tile::EnemyStart:
                             enemy_start_position = {position.x, 0.3, position.z};
                             break;
+                        default:
+                            break;
                     }
                     position.x += 1.0f;
                }
                position.x = 0.0f;
                position.z += 1.0f;
             }
+            check_goal_reachable();
 
-            cage.transform.position = win_position;
-            cage.transform.scale *= 0.5f;
-
-            brother.transform.position = win_position;
-            brother.transform.position.y = 0.06;
-            brother.transform.scale *= 0.006f;
-
-            statue.transform.position = statue_position;
-            statue.transform.scale *= 0.4f;
-
-            statue2.transform.position = statue2_position;
-            statue2.transform.scale *= 0.5f;
-
-            statue3.transform.position = statue3_position;
-
-            statue4.transform.position = statue4_position;
-            statue4.transform.scale *= 0.5f;
+            collision.build(grid);
+            goal_body = collision.add_body(win_position, glm::vec2(0.4f), BodyTag::Goal);
+            entities.transforms.update();
         }
 
         // Imprime la representacin en texto del mapa en la consola.
         void print_map_txt()
         {
-            for (int i = 0; i < txt_map.size(); i++)
+            for (int i = 0; i < grid.rows(); i++)
             {
-                for (int j = 0; j < txt_map[i].size(); j++)
+                for (int j = 0; j < grid.cols(); j++)
                 {
-                    std::cout << txt_map[i][j];
+                    std::cout << tile_glyph(grid.tile(i, j));
                 }
                 std::cout << std::endl;
             }
@@ -166,36 +250,228 @@ class Map {
         // Devuelve una posicin aleatoria transitable en el mapa.
         glm::ivec2 random_walkable_pos()
         {
-            srand (time(NULL));
-            int rows = txt_map.size();
-            int cols = txt_map[0].size();
-            int x, y;
-            do {
-                x = (rand() % rows);
-                y = (rand() % cols);
-            } while (txt_map[x][y] != ' ');
+            return walkable.random_tile(random);
+        }
+
+        // Devuelve una posicin aleatoria transitable a la que se puede llegar desde 'from', o {-1, -1} si no hay.
+        glm::ivec2 random_reachable_pos(glm::ivec2 from)
+        {
+            return walkable.random_reachable(from, random);
+        }
+
+        // Desplazamiento en el plano xz que saca de los objetos slidos a un cuerpo vertical de radio 'radius' cuyo
+        // punto ms alto es 'position' (la cmara, en el caso del jugador). Cero si no toca ninguno.
+        // Solo se prueban las mallas de los objetos cuyo cuerpo en 'collision' toca al del jugador.
+        glm::vec3 prop_push(glm::vec3 position, float radius)
+        {
+            PROFILE_ZONE("Map::prop_push");
+            glm::vec3 push(0.0f);
+            for (int iteration = 0; iteration < 3; iteration++)
+            {
+                glm::vec3 top = position + push;
+                glm::vec3 bottom = { top.x, radius, top.z };
+                bool touched = false;
+                collision.query(top, glm::vec2(radius), [&](int body) {
+                    if (collision.body_tag(body) != BodyTag::Prop)
+                        return true;
+                    Entity entity = collision.body_user(body);
+                    MeshBvh* shape = entities.colliders.get(entity).shape;
+                    shape->set_transform(entities.transforms.world(entity));
+                    MeshContact contact;
+                    if (!shape->capsule_contact(bottom, top, radius, contact))
+                        return true;
+                    glm::vec2 away(contact.normal.x, contact.normal.z);
+                    if (glm::length(away) < 1e-3f)
+                        return true; // Contacto por encima o por debajo: no frena el paso.
+                    away = glm::normalize(away) * contact.depth;
+                    push += glm::vec3(away.x, 0.0f, away.y);
+                    touched = true;
+                    return true;
+                });
+                if (!touched)
+                    break;
+            }
+            return push;
+        }
+
+        // Objeto slido ms cercano que cruza el rayo (por ejemplo, el que ilumina la linterna), o NoEntity.
+        Entity pick(glm::vec3 origin, glm::vec3 direction, float max_distance, RayHit &hit)
+        {
+            PROFILE_ZONE("Map::pick");
+            Entity picked = NoEntity;
+            for (size_t i = 0; i < entities.colliders.size(); i++)
+            {
+                Entity entity = entities.colliders.owner(i);
+                MeshBvh* shape = entities.colliders[i].shape;
+                shape->set_transform(entities.transforms.world(entity));
+                RayHit entity_hit;
+                if (shape->raycast(origin, direction, max_distance, entity_hit))
+                {
+                    max_distance = entity_hit.distance;
+                    hit = entity_hit;
+                    picked = entity;
+                }
+            }
+            return picked;
+        }
+
+        // Construye la malla de navegacin con la geometra de un nivel hecho con modelos (ver NavMeshInput::add_model).
+        // Los enemigos la usan en lugar de la grilla cuando el nivel no tiene archivo de mapa.
+        bool build_navmesh(const NavMeshInput &input, const NavMeshConfig &config = NavMeshConfig())
+        {
+            return NavMeshBuilder::build(input, config, navmesh);
+        }
+
+        // Punto al azar de la malla de navegacin.
+        glm::vec3 random_nav_point()
+        {
+            return navmesh.random_point(random);
+        }
+
+        // Registra un ruido de intensidad 'loudness' en la casilla de la posicin del mundo 'position'.
+        void emit_noise(glm::vec3 position, float loudness)
+        {
+            hearing.emit(grid, { int(std::round(position.z)), int(std::round(position.x)) }, loudness);
+        }
 
-            return glm::ivec2 {x, y};
+        // Fija la semilla del generador de posiciones aleatorias (para repetir una partida).
+        void seed(uint32_t value)
+        {
+            random.seed(value);
         }
 
     private:
-        // Modelos 3D para los elementos del mapa.
-        Model cage;
-        Model wall;
-        Model statue;
-        Model statue2;
-        Model statue3;
-        Model statue4;
-        Model brother;
+        // Avisa si desde el inicio del jugador no se llega a la meta. La meta no es transitable: basta con que se
+        // alcance alguna de sus vecinas.
+        void check_goal_reachable()
+        {
+            glm::ivec2 start = { int(std::round(player_start_position.z)), int(std::round(player_start_position.x)) };
+            glm::ivec2 goal = { int(std::round(win_position.z)), int(std::round(win_position.x)) };
+            std::vector<uint64_t> reached;
+            int count = bits.reachable(grid, { start }, reached);
+            const glm::ivec2 sides[4] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+            for (glm::ivec2 side : sides)
+            {
+                if (bits.contains(grid, reached, goal + side))
+                    return;
+            }
+            std::cout << "Map: la meta no es alcanzable desde el inicio (" << count << " casillas alcanzables)" << std::endl;
+        }
+
+        // Gira hacia el jugador las entidades con FacePlayer.
+        void face_player()
+        {
+            for (size_t i = 0; i < entities.face_player.size(); i++)
+            {
+                Entity entity = entities.face_player.owner(i);
+                glm::vec3 to_player = player_position - entities.transforms.position(entity);
+                entities.transforms.set_yaw(entity, std::atan2(to_player.x, to_player.z) + entities.face_player[i].yaw_offset);
+            }
+        }
+
+        // Crea las entidades de todos los tipos que genera la casilla 'tile' en 'position'.
+        void spawn(Tile tile, glm::vec3 position)
+        {
+            const std::vector<PropType> &types = prop_types();
+            for (size_t k = 0; k < types.size(); k++)
+            {
+                const PropType &type = types[k];
+                if (type.tile != tile)
+                    continue;
+                Entity entity = entities.create();
+                Transform transform;
+                transform.position = { position.x, type.height, position.z };
+                transform.scale *= type.scale;
+                entities.transforms.add(entity, transform);
+                entities.renderables.add(entity, { models[type_models[k]].get() });
+                if (type.faces_player)
+                    entities.face_player.add(entity, { type.yaw_offset });
+                if (type.solid)
+                    entities.colliders.add(entity, { &shapes[type_models[k]], -1 });
+            }
+        }
+
+        // Construye las mallas de colisin de los modelos de tipos slidos y agrega al CollisionWorld un cuerpo
+        // por entidad slida, del tamao del crculo que barre su modelo al girar. Corre en un trabajador, con
+        // los modelos ya importados y las entidades creadas.
+        void build_colliders()
+        {
+            PROFILE_ZONE("Map::build_colliders");
+            const std::vector<PropType> &types = prop_types();
+            for (size_t k = 0; k < types.size(); k++)
+            {
+                MeshBvh &shape = shapes[type_models[k]];
+                if (!types[k].solid || !shape.empty())
+                    continue;
+                shape.add_model(*models[type_models[k]]);
+                shape.build();
+            }
+
+            for (size_t i = 0; i < entities.colliders.size(); i++)
+            {
+                Collider &collider = entities.colliders[i];
+                Entity entity = entities.colliders.owner(i);
+                glm::vec3 min, max;
+                collider.shape->local_bounds(min, max);
+                float reach = std::max(glm::length(glm::vec2(min.x, min.z)), glm::length(glm::vec2(max.x, max.z)));
+                reach = std::max(reach, std::max(glm::length(glm::vec2(min.x, max.z)), glm::length(glm::vec2(max.x, min.z))));
+                float scale = entities.transforms.scale(entity).x;
+                collider.body = collision.add_body(entities.transforms.position(entity), glm::vec2(reach * scale), BodyTag::Prop, entity);
+            }
+        }
+
+        // Programa la carga de los modelos de la tabla de tipos en paralelo, uno por archivo distinto, y devuelve
+        // sus trabajos de subida. Cada importacin (Assimp y decodificacin de texturas) corre en un hilo
+        // trabajador y su subida a la GPU se programa en el hilo principal en cuanto termina, mientras los dems
+        // modelos siguen importndose. Esa subida solo reserva los recursos: los datos llegan a la GPU en los
+        // frames siguientes a travs de la UploadQueue.
+        std::vector<JobHandle> load_models()
+        {
+            PROFILE_ZONE("Map::load_models");
+
+            const std::vector<PropType> &types = prop_types();
+            std::vector<const PropType*> sources; // Primer tipo que usa cada modelo.
+            type_models.clear();
+            for (const PropType &type : types)
+            {
+                size_t m = 0;
+                while (m < sources.size() && std::string(sources[m]->model) != type.model)
+                    m++;
+                if (m == sources.size())
+                    sources.push_back(&type);
+                type_models.push_back((int)m);
+            }
+            models.clear();
+            for (size_t m = 0; m < sources.size(); m++)
+                models.push_back(std::make_unique<Model>());
+            shapes.assign(sources.size(), MeshBvh());
+
+            JobSystem &jobs = JobSystem::get();
+            std::vector<JobHandle> uploads;
+            for (size_t m = 0; m < sources.size(); m++)
+            {
+                Model* model = models[m].get();
+                const PropType* type = sources[m];
+                JobHandle import = jobs.schedule([model, type] { model->import(type->model, type->flip); });
+                uploads.push_back(jobs.schedule([model] { model->upload(); }, { import }, JobAffinity::Main));
+            }
+            return uploads;
+        }
+
+        std::vector<std::unique_ptr<Model>> models; // Un modelo por archivo distinto de la tabla de tipos.
+        std::vector<MeshBvh> shapes; // Malla de colisin de cada modelo; vaca si ningn tipo slido lo usa.
+        std::vector<int> type_models; // ndice en 'models' del modelo de cada tipo de la tabla.
 
         Cube floor; // Representa el suelo y el techo.
         glm::vec3 floor_position; // Posicin del suelo.
         glm::vec3 roof_position; // Posicin del techo.
         Shader floor_shader; // Shader para el suelo y el techo.
+        std::mt19937 random{ std::random_device{}() }; // Generador de posiciones aleatorias.
   
-        // Lee el archivo de mapa y lo almacena en txt_map.
+        // Lee el archivo de mapa y lo almacena en la grilla.
         void read_map_file(const char *path)
         {
+            PROFILE_ZONE_TEXT("Map::read_map_file", path);
             std::string line;
             std::ifstream infile(path);
 
@@ -205,14 +481,14 @@ class Map {
                 exit(-1);
             }
 
-            while (std::getline(infile, line)) {
-                std::vector<char> row;
+            std::vector<std::string> lines;
+            while (std::getline(infile, line))
+                lines.push_back(std::move(line));
 
-                for (char &c : line) {
-                    row.push_back(c);
-                }
-
-                txt_map.push_back(row);
-            }
+            grid.load(lines);
+            clusters.build(grid);
+            walkable.build(grid);
+            bits.build(grid);
+            paths.build(grid, walkable);
         }
 };
\ No newline at end of file
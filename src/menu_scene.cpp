@@ -20,11 +20,14 @@ MenuScene::MenuScene(Context &ctx) : ctx(ctx)
     stbi_set_flip_vertically_on_load(true);
 
     // Carga de texturas para el fondo y los botones del men desde archivos.
-    load_texture("./assets/textures/menu.png", bg.texture); // Textura de fondo.
-    load_texture("./assets/textures/play_button.png", play_btn.texture); // Textura del botn de jugar.
-    load_texture("./assets/textures/instructions_button.png", instructions_btn.texture); // Textura del botn de instrucciones.
-    load_texture("./assets/textures/credits_button.png", credit_btn.texture); // Textura del botn de crditos.
-    load_texture("./assets/textures/quit_button.png", quit_btn.texture); // Textura del botn de salir.
+    // Las texturas se decodifican en paralelo y se suben juntas en el hilo principal.
+    load_textures({
+        {"./assets/textures/menu.png", &bg.texture}, // Textura de fondo.
+        {"./assets/textures/play_button.png", &play_btn.texture}, // Textura del botn de jugar.
+        {"./assets/textures/instructions_button.png", &instructions_btn.texture}, // Textura del botn de instrucciones.
+        {"./assets/textures/credits_button.png", &credit_btn.texture}, // Textura del botn de crditos.
+        {"./assets/textures/quit_button.png", &quit_btn.texture}, // Textura del botn de salir.
+    }, true);
 
     bg.transform.scale.x = ctx.win_width;
     bg.transform.scale.y = ctx.win_height;
@@ -38,12 +41,12 @@ MenuScene::MenuScene(Context &ctx) : ctx(ctx)
 }
 
 // Almacena la escena actual en el contexto de la aplicacin para su gestin.
-void MenuScene::store_scene_in_ctx() { ctx.scenes.push_back(this); }
+void MenuScene::store_scene_in_ctx() { ctx.store_scene(this); }
 
 // Prepara la escena para ser mostrada, habilitando el modo de cursor normal y deshabilitando el test de profundidad.
 void MenuScene::open_scene()
 {
-    start_time = clock.current_time; // Inicializa el tiempo de inicio de la escena.
+    start_time = ctx.clock.current_time; // Inicializa el tiempo de inicio de la escena.
     glDisable(GL_DEPTH_TEST); // Desactiva el test de profundidad para el renderizado 2D.
     glfwSetInputMode(ctx.window, GLFW_CURSOR, GLFW_CURSOR_NORMAL); // Establece el cursor como visible.
 }
@@ -51,9 +54,11 @@ void MenuScene::open_scene()
 // Funcin vaca, podra usarse para realizar tareas al cerrar la escena.
 void MenuScene::close_scene() { return; }
 
+// El men no tiene simulacin.
+void MenuScene::fixed_update(float delta_time) {}
+
 void MenuScene::update()
 {
-    clock.update(); // Actualiza el reloj de la escena.
     glActiveTexture(GL_TEXTURE0); // Activa la unidad de textura 0.
 
     // Renderiza el fondo.
@@ -4,7 +4,6 @@
 #include "mygl/iscene.hpp"
 #include "mygl/context.hpp"
 #include "mygl/button.hpp"
-#include "mygl/clock.hpp"
 #include "texture.hpp"
 #include "stb_image.h"
 
@@ -18,6 +17,7 @@ class MenuScene : public IScene {
         void store_scene_in_ctx() override;
         void open_scene() override;
         void close_scene() override;
+        void fixed_update(float delta_time) override;
         void update() override;
         void scene_clear() override;
         void process_input() override;
@@ -32,8 +32,6 @@ class MenuScene : public IScene {
         Context& ctx; // Referencia al contexto de la aplicacin.
 
     private:
-        Clock clock; // Reloj para controlar el tiempo dentro de la escena.
-
         CameraOrtho camera; // Cmara ortogrfica para la renderizacin 2D.
         Shader btn_shader; // Shader para los botones.
         Shader bg_shader; // Shader para el fondo.
@@ -0,0 +1,783 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mygl/job_system.hpp"
+#include "mygl/profiler.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MESH_BVH_SSE
+#include <emmintrin.h>
+#endif
+
+// Impacto de un rayo contra una malla.
+struct RayHit {
+    float distance = FLT_MAX; // Parmetro t del rayo (en unidades del mundo si la direccin es unitaria).
+    uint32_t triangle = 0; // ndice del tringulo en la malla.
+    glm::vec3 point = glm::vec3(0.0f);
+    glm::vec3 normal = glm::vec3(0.0f); // Normal unitaria del tringulo, hacia el lado del que viene el rayo.
+};
+
+// Contacto de una esfera o cpsula con una malla: el punto ms cercano de la malla y hacia dnde empujar.
+struct MeshContact {
+    glm::vec3 point = glm::vec3(0.0f); // Punto de la malla ms cercano a la forma.
+    glm::vec3 normal = glm::vec3(0.0f); // Direccin unitaria desde la malla hacia la forma.
+    float depth = 0.0f; // Cunto hay que mover la forma segn 'normal' para dejar de tocar la malla.
+    uint32_t triangle = 0;
+};
+
+// MeshBvh es una jerarqua de volmenes envolventes (cajas alineadas a los ejes) sobre los tringulos de una
+// malla, para consultas de rayo, esfera y cpsula sin recorrer todos los tringulos.
+// - Se construye con la heurstica de rea de superficie (SAH) en 16 cubetas por eje. Los niveles de arriba se
+//   parten en el hilo que llama; los subrboles que quedan se construyen en paralelo en el JobSystem.
+// - Los nodos quedan en un nico arreglo en orden de profundidad, de 32 bytes cada uno (dos por lnea de
+//   cach): el hijo izquierdo de un nodo interno es el siguiente y solo se guarda el ndice del derecho.
+// - El rayo contra caja usa SSE cuando el compilador lo permite (x64 siempre), con la inversa de la direccin
+//   precalculada; los hijos se visitan del ms cercano al ms lejano.
+// - refit recalcula las cajas sin cambiar la jerarqua, para mallas que se deforman. Para objetos rgidos que
+//   se mueven alcanza con set_transform: la malla queda en su espacio local y las consultas se transforman.
+// Las consultas reciben y devuelven coordenadas del mundo. La transformacin debe tener escala uniforme.
+class MeshBvh {
+    public:
+        // Agrega tringulos indexados transformados por 'matrix'. Sirve para cualquier vrtice con miembro 'position'.
+        template <typename VertexType>
+        void add_triangles(const std::vector<VertexType> &mesh_vertices, const std::vector<unsigned int> &mesh_indices,
+                           const glm::mat4 &matrix = glm::mat4(1.0f))
+        {
+            uint32_t base = (uint32_t)positions.size();
+            for (const VertexType &vertex : mesh_vertices)
+                positions.push_back(glm::vec3(matrix * glm::vec4(vertex.position, 1.0f)));
+            for (size_t i = 0; i + 2 < mesh_indices.size(); i += 3)
+                triangles.push_back({ base + mesh_indices[i], base + mesh_indices[i + 1], base + mesh_indices[i + 2] });
+        }
+
+        // Agrega todas las mallas de un modelo en su espacio local (la posicin del modelo va en set_transform).
+        template <typename ModelType>
+        void add_model(const ModelType &model, const glm::mat4 &matrix = glm::mat4(1.0f))
+        {
+            for (const auto &mesh : model.meshes)
+                add_triangles(mesh.vertices, mesh.indices, matrix);
+        }
+
+        // Construye la jerarqua con los tringulos agregados.
+        void build()
+        {
+            PROFILE_ZONE("MeshBvh::build");
+            nodes.clear();
+            order.clear();
+            size_t count = triangles.size();
+            if (count == 0)
+                return;
+
+            bounds.resize(count);
+            centroids.resize(count);
+            order.resize(count);
+            JobSystem::get().parallel_for(0, count, 4096, [this](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    triangle_bounds((uint32_t)i, bounds[i]);
+                    centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+                    order[i] = (uint32_t)i;
+                }
+            });
+
+            // Arriba se parte hasta dejar subrboles de a lo sumo 'task_size' tringulos, que son los trabajos.
+            size_t workers = std::max<size_t>(JobSystem::get().worker_count(), 1);
+            uint32_t task_size = (uint32_t)std::max<size_t>(count / (workers * 4), 1024);
+            std::vector<BuildNode> top;
+            std::vector<Task> tasks;
+            split(top, 0, (uint32_t)count, 0, task_size, &tasks);
+
+            std::vector<std::vector<BuildNode>> subtrees(tasks.size());
+            JobSystem::get().parallel_for(0, tasks.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                    split(subtrees[i], tasks[i].first, tasks[i].count, tasks[i].depth, 0, nullptr);
+            });
+
+            size_t total = top.size();
+            for (const std::vector<BuildNode> &subtree : subtrees)
+                total += subtree.size();
+            nodes.reserve(total);
+            flatten(top, 0, tasks, subtrees);
+            bounds.clear();
+            bounds.shrink_to_fit();
+            centroids.clear();
+            centroids.shrink_to_fit();
+        }
+
+        // Recalcula las cajas de todos los nodos tras mover vrtices (ver vertices), sin cambiar la jerarqua.
+        // Es lineal en la cantidad de nodos; si la malla se deforma mucho conviene volver a construir.
+        void refit()
+        {
+            PROFILE_ZONE("MeshBvh::refit");
+            // En orden de profundidad los hijos estn despus del padre: basta recorrer de atrs hacia adelante.
+            for (size_t i = nodes.size(); i-- > 0;)
+            {
+                Node &node = nodes[i];
+                Box box;
+                if (node.count > 0)
+                {
+                    for (uint32_t k = 0; k < node.count; k++)
+                    {
+                        Box tri;
+                        triangle_bounds(order[node.first + k], tri);
+                        box.grow(tri);
+                    }
+                } else {
+                    box.grow(nodes[i + 1].box());
+                    box.grow(nodes[node.first].box());
+                }
+                node.min = box.min;
+                node.max = box.max;
+            }
+        }
+
+        // Fija la transformacin del espacio local de la malla al mundo (por ejemplo, la matriz del modelo).
+        void set_transform(const glm::mat4 &matrix)
+        {
+            to_world = matrix;
+            to_local = glm::inverse(matrix);
+            scale = glm::length(glm::vec3(matrix[0]));
+        }
+
+        void clear()
+        {
+            positions.clear();
+            triangles.clear();
+            nodes.clear();
+            order.clear();
+            set_transform(glm::mat4(1.0f));
+        }
+
+        bool empty() const { return nodes.empty(); }
+        size_t triangle_count() const { return triangles.size(); }
+        size_t node_count() const { return nodes.size(); }
+
+        // Caja de toda la malla en su espacio local.
+        void local_bounds(glm::vec3 &min, glm::vec3 &max) const
+        {
+            min = nodes.empty() ? glm::vec3(0.0f) : nodes[0].min;
+            max = nodes.empty() ? glm::vec3(0.0f) : nodes[0].max;
+        }
+
+        // Vrtices en espacio local, para deformar la malla antes de refit.
+        std::vector<glm::vec3>& vertices() { return positions; }
+
+        // Impacto ms cercano del rayo 'origin' + t 'direction' con t en [0, max_distance].
+        bool raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, RayHit &hit) const
+        {
+            PROFILE_ZONE("MeshBvh::raycast");
+            if (nodes.empty())
+                return false;
+            glm::vec3 o = glm::vec3(to_local * glm::vec4(origin, 1.0f));
+            glm::vec3 d = glm::vec3(to_local * glm::vec4(direction, 0.0f));
+            Ray ray(o, d);
+
+            float best = max_distance;
+            uint32_t best_triangle = 0;
+            bool found = false;
+            uint32_t stack[max_depth];
+            int top = 0;
+            uint32_t current = 0;
+            if (ray.hits(nodes[0], best) == FLT_MAX)
+                return false;
+            while (true)
+            {
+                const Node &node = nodes[current];
+                if (node.count > 0)
+                {
+                    for (uint32_t k = 0; k < node.count; k++)
+                    {
+                        uint32_t t = order[node.first + k];
+                        float distance;
+                        if (ray_triangle(o, d, t, best, distance))
+                        {
+                            best = distance;
+                            best_triangle = t;
+                            found = true;
+                        }
+                    }
+                } else {
+                    uint32_t near_child = current + 1;
+                    uint32_t far_child = node.first;
+                    float near_t = ray.hits(nodes[near_child], best);
+                    float far_t = ray.hits(nodes[far_child], best);
+                    if (far_t < near_t)
+                    {
+                        std::swap(near_child, far_child);
+                        std::swap(near_t, far_t);
+                    }
+                    if (near_t != FLT_MAX)
+                    {
+                        if (far_t != FLT_MAX)
+                        {
+                            assert(top < max_depth);
+                            stack[top++] = far_child;
+                        }
+                        current = near_child;
+                        continue;
+                    }
+                }
+                if (top == 0)
+                    break;
+                current = stack[--top];
+            }
+            if (!found)
+                return false;
+
+            glm::vec3 a, b, c;
+            corners(best_triangle, a, b, c);
+            glm::vec3 normal = glm::cross(b - a, c - a);
+            if (glm::dot(normal, d) > 0.0f)
+                normal = -normal;
+            hit.distance = best;
+            hit.triangle = best_triangle;
+            hit.point = origin + direction * best;
+            hit.normal = glm::normalize(glm::transpose(glm::mat3(to_local)) * normal);
+            return true;
+        }
+
+        // Llama a 'visit(tringulo)' con cada tringulo que toca la esfera, hasta que devuelva falso.
+        template <typename Visit>
+        void overlap_sphere(glm::vec3 center, float radius, Visit &&visit) const
+        {
+            glm::vec3 c = glm::vec3(to_local * glm::vec4(center, 1.0f));
+            float r = radius / scale;
+            traverse([&](const Node &node) { return box_distance2(node, c) <= r * r; },
+                     [&](uint32_t t) {
+                         glm::vec3 p = closest_on_triangle(t, c);
+                         return glm::dot(p - c, p - c) > r * r || visit(t);
+                     });
+        }
+
+        // Llama a 'visit(tringulo)' con cada tringulo que toca la cpsula de eje [a, b], hasta que devuelva falso.
+        template <typename Visit>
+        void overlap_capsule(glm::vec3 a, glm::vec3 b, float radius, Visit &&visit) const
+        {
+            glm::vec3 la = glm::vec3(to_local * glm::vec4(a, 1.0f));
+            glm::vec3 lb = glm::vec3(to_local * glm::vec4(b, 1.0f));
+            float r = radius / scale;
+            Ray ray(la, lb - la);
+            traverse([&](const Node &node) { return ray.hits_expanded(node, r); },
+                     [&](uint32_t t) {
+                         glm::vec3 on_mesh, on_segment;
+                         segment_triangle(la, lb, t, on_mesh, on_segment);
+                         return glm::dot(on_mesh - on_segment, on_mesh - on_segment) > r * r || visit(t);
+                     });
+        }
+
+        // Contacto ms profundo de la esfera con la malla. Falso si no la toca.
+        bool sphere_contact(glm::vec3 center, float radius, MeshContact &contact) const
+        {
+            PROFILE_ZONE("MeshBvh::sphere_contact");
+            glm::vec3 c = glm::vec3(to_local * glm::vec4(center, 1.0f));
+            float best = FLT_MAX;
+            overlap_sphere(center, radius, [&](uint32_t t) {
+                glm::vec3 p = closest_on_triangle(t, c);
+                float d2 = glm::dot(p - c, p - c);
+                if (d2 < best)
+                {
+                    best = d2;
+                    contact.triangle = t;
+                    contact.point = p;
+                }
+                return true;
+            });
+            if (best == FLT_MAX)
+                return false;
+            finish_contact(c, radius, contact);
+            return true;
+        }
+
+        // Contacto ms profundo de la cpsula de eje [a, b] con la malla. Falso si no la toca.
+        bool capsule_contact(glm::vec3 a, glm::vec3 b, float radius, MeshContact &contact) const
+        {
+            PROFILE_ZONE("MeshBvh::capsule_contact");
+            glm::vec3 la = glm::vec3(to_local * glm::vec4(a, 1.0f));
+            glm::vec3 lb = glm::vec3(to_local * glm::vec4(b, 1.0f));
+            float best = FLT_MAX;
+            glm::vec3 best_segment(0.0f);
+            overlap_capsule(a, b, radius, [&](uint32_t t) {
+                glm::vec3 on_mesh, on_segment;
+                segment_triangle(la, lb, t, on_mesh, on_segment);
+                float d2 = glm::dot(on_mesh - on_segment, on_mesh - on_segment);
+                if (d2 < best)
+                {
+                    best = d2;
+                    best_segment = on_segment;
+                    contact.triangle = t;
+                    contact.point = on_mesh;
+                }
+                return true;
+            });
+            if (best == FLT_MAX)
+                return false;
+            finish_contact(best_segment, radius, contact);
+            return true;
+        }
+
+    private:
+        struct Box {
+            glm::vec3 min = glm::vec3(FLT_MAX);
+            glm::vec3 max = glm::vec3(-FLT_MAX);
+
+            void grow(const Box &other) { min = glm::min(min, other.min); max = glm::max(max, other.max); }
+            void grow(glm::vec3 p) { min = glm::min(min, p); max = glm::max(max, p); }
+            float area() const
+            {
+                glm::vec3 e = max - min;
+                return e.x > 0.0f ? e.x * e.y + e.y * e.z + e.z * e.x : 0.0f;
+            }
+        };
+
+        // Nodo de 32 bytes. Hoja si count > 0: tringulos order[first, first + count).
+        // Nodo interno si count == 0: hijo izquierdo en el ndice siguiente y derecho en 'first'.
+        struct alignas(32) Node {
+            glm::vec3 min;
+            uint32_t first;
+            glm::vec3 max;
+            uint32_t count;
+
+            Box box() const
+            {
+                Box b;
+                b.min = min;
+                b.max = max;
+                return b;
+            }
+        };
+
+        // Nodo de la construccin, antes de aplanar. task >= 0 marca un subrbol construido aparte.
+        struct BuildNode {
+            Box box;
+            uint32_t first = 0;
+            uint32_t count = 0;
+            int left = -1;
+            int right = -1;
+            int task = -1;
+        };
+
+        struct Task {
+            uint32_t first;
+            uint32_t count;
+            int depth; // Profundidad de la raz del subrbol.
+        };
+
+        // Rayo con la inversa de la direccin precalculada, para el test de las tres franjas contra una caja.
+        struct Ray {
+            glm::vec3 origin;
+            glm::vec3 inverse;
+#ifdef MESH_BVH_SSE
+            __m128 o4;
+            __m128 inv4;
+#endif
+
+            Ray(glm::vec3 o, glm::vec3 d) : origin(o)
+            {
+                for (int k = 0; k < 3; k++)
+                    inverse[k] = d[k] != 0.0f ? 1.0f / d[k] : (std::signbit(d[k]) ? -FLT_MAX : FLT_MAX);
+#ifdef MESH_BVH_SSE
+                o4 = _mm_set_ps(0.0f, o.z, o.y, o.x);
+                inv4 = _mm_set_ps(0.0f, inverse.z, inverse.y, inverse.x);
+#endif
+            }
+
+            // Distancia de entrada a la caja del nodo, o FLT_MAX si no la cruza antes de 'limit'.
+            float hits(const Node &node, float limit) const
+            {
+#ifdef MESH_BVH_SSE
+                // El nodo est alineado a 32 bytes: min y max se leen de a cuatro floats. El cuarto carril
+                // (first o count) no interviene en el resultado.
+                return hits(_mm_load_ps(&node.min.x), _mm_load_ps(&node.max.x), limit);
+#else
+                return hits(node.min, node.max, limit);
+#endif
+            }
+
+            // Verdadero si el segmento (t en [0, 1]) cruza la caja del nodo agrandada en 'r'.
+            bool hits_expanded(const Node &node, float r) const
+            {
+#ifdef MESH_BVH_SSE
+                __m128 r4 = _mm_set1_ps(r);
+                return hits(_mm_sub_ps(_mm_load_ps(&node.min.x), r4), _mm_add_ps(_mm_load_ps(&node.max.x), r4), 1.0f) != FLT_MAX;
+#else
+                return hits(node.min - r, node.max + r, 1.0f) != FLT_MAX;
+#endif
+            }
+
+#ifdef MESH_BVH_SSE
+            float hits(__m128 min, __m128 max, float limit) const
+            {
+                __m128 t1 = _mm_mul_ps(_mm_sub_ps(min, o4), inv4);
+                __m128 t2 = _mm_mul_ps(_mm_sub_ps(max, o4), inv4);
+                __m128 lo = _mm_min_ps(t1, t2);
+                __m128 hi = _mm_max_ps(t1, t2);
+                // Mximo de las entradas y mnimo de las salidas de los carriles x, y, z, en el carril 0.
+                __m128 enter = _mm_max_ss(lo, _mm_max_ss(_mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                         _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 2, 2, 2))));
+                __m128 exit = _mm_min_ss(hi, _mm_min_ss(_mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 1, 1, 1)),
+                                                        _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 2, 2, 2))));
+                return finish(_mm_cvtss_f32(enter), _mm_cvtss_f32(exit), limit);
+            }
+#else
+            float hits(glm::vec3 min, glm::vec3 max, float limit) const
+            {
+                glm::vec3 t1 = (min - origin) * inverse;
+                glm::vec3 t2 = (max - origin) * inverse;
+                glm::vec3 lo = glm::min(t1, t2);
+                glm::vec3 hi = glm::max(t1, t2);
+                return finish(std::max(lo.x, std::max(lo.y, lo.z)), std::min(hi.x, std::min(hi.y, hi.z)), limit);
+            }
+#endif
+
+            static float finish(float t_enter, float t_exit, float limit)
+            {
+                t_enter = std::max(t_enter, 0.0f);
+                return t_enter <= t_exit && t_enter <= limit ? t_enter : FLT_MAX;
+            }
+        };
+
+        // Recorre los nodos que 'enter' acepta y llama a 'leaf' con sus tringulos, hasta que devuelva falso.
+        template <typename Enter, typename Leaf>
+        void traverse(Enter &&enter, Leaf &&leaf) const
+        {
+            if (nodes.empty() || !enter(nodes[0]))
+                return;
+            uint32_t stack[max_depth];
+            int top = 0;
+            uint32_t current = 0;
+            while (true)
+            {
+                const Node &node = nodes[current];
+                if (node.count > 0)
+                {
+                    for (uint32_t k = 0; k < node.count; k++)
+                        if (!leaf(order[node.first + k]))
+                            return;
+                } else {
+                    bool left = enter(nodes[current + 1]);
+                    bool right = enter(nodes[node.first]);
+                    if (left || right)
+                    {
+                        if (left && right)
+                        {
+                            assert(top < max_depth);
+                            stack[top++] = node.first;
+                        }
+                        current = left ? current + 1 : node.first;
+                        continue;
+                    }
+                }
+                if (top == 0)
+                    return;
+                current = stack[--top];
+            }
+        }
+
+        // Parte los tringulos order[first, first + count) en 'out' y devuelve el ndice del nodo creado.
+        // Si 'tasks' no es nulo, los rangos de hasta 'task_size' tringulos se dejan como trabajos aparte.
+        // A profundidad max_depth - 1 el nodo queda como hoja, as la pila de los recorridos nunca se llena.
+        int split(std::vector<BuildNode> &out, uint32_t first, uint32_t count, int depth, uint32_t task_size, std::vector<Task>* tasks)
+        {
+            int index = (int)out.size();
+            out.emplace_back();
+            BuildNode node;
+            node.first = first;
+            node.count = count;
+            Box centroid_box;
+            for (uint32_t i = first; i < first + count; i++)
+            {
+                node.box.grow(bounds[order[i]]);
+                centroid_box.grow(centroids[order[i]]);
+            }
+
+            if (tasks && count <= task_size)
+            {
+                node.task = (int)tasks->size();
+                tasks->push_back({ first, count, depth });
+                out[index] = node;
+                return index;
+            }
+
+            int axis;
+            float position;
+            uint32_t middle = first;
+            if (count > leaf_size && depth < max_depth - 1 && best_split(node, centroid_box, axis, position))
+            {
+                uint32_t* begin = order.data() + first;
+                middle = first + (uint32_t)(std::partition(begin, begin + count, [&](uint32_t t) {
+                    return centroids[t][axis] < position;
+                }) - begin);
+            }
+            if (middle == first || middle == first + count)
+            {
+                out[index] = node; // Hoja.
+                return index;
+            }
+
+            out[index] = node;
+            int left = split(out, first, middle - first, depth + 1, task_size, tasks);
+            int right = split(out, middle, first + count - middle, depth + 1, task_size, tasks);
+            out[index].left = left;
+            out[index].right = right;
+            out[index].count = 0;
+            return index;
+        }
+
+        // Elige el plano de corte de menor costo SAH en 16 cubetas por eje. Falso si no conviene partir.
+        bool best_split(const BuildNode &node, const Box &centroid_box, int &best_axis, float &best_position) const
+        {
+            const int bin_count = 16;
+            float best_cost = node.count * node.box.area(); // Costo de dejar una hoja.
+            bool found = false;
+            for (int axis = 0; axis < 3; axis++)
+            {
+                float lo = centroid_box.min[axis];
+                float hi = centroid_box.max[axis];
+                if (hi <= lo)
+                    continue;
+                Box bins[bin_count];
+                uint32_t counts[bin_count] = {};
+                float factor = bin_count / (hi - lo);
+                for (uint32_t i = node.first; i < node.first + node.count; i++)
+                {
+                    uint32_t t = order[i];
+                    int b = std::min(bin_count - 1, (int)((centroids[t][axis] - lo) * factor));
+                    bins[b].grow(bounds[t]);
+                    counts[b]++;
+                }
+
+                // Barrido desde la derecha para tener rea y cantidad de cada lado de los 15 cortes.
+                float right_area[bin_count - 1];
+                uint32_t right_count[bin_count - 1];
+                Box box;
+                uint32_t total = 0;
+                for (int b = bin_count - 1; b > 0; b--)
+                {
+                    box.grow(bins[b]);
+                    total += counts[b];
+                    right_area[b - 1] = box.area();
+                    right_count[b - 1] = total;
+                }
+                box = Box();
+                total = 0;
+                for (int b = 0; b < bin_count - 1; b++)
+                {
+                    box.grow(bins[b]);
+                    total += counts[b];
+                    if (total == 0 || right_count[b] == 0)
+                        continue;
+                    // El costo de recorrer el nodo interno equivale a un tringulo por rea del nodo.
+                    float cost = node.box.area() + total * box.area() + right_count[b] * right_area[b];
+                    if (cost < best_cost)
+                    {
+                        best_cost = cost;
+                        best_axis = axis;
+                        best_position = lo + (b + 1) / factor;
+                        found = true;
+                    }
+                }
+            }
+            return found;
+        }
+
+        // Copia el rbol de construccin a 'nodes' en orden de profundidad, reemplazando los trabajos por sus subrboles.
+        void flatten(const std::vector<BuildNode> &tree, int index, const std::vector<Task> &tasks,
+                     const std::vector<std::vector<BuildNode>> &subtrees)
+        {
+            const BuildNode &node = tree[index];
+            if (node.task >= 0)
+            {
+                flatten(subtrees[node.task], 0, tasks, subtrees);
+                return;
+            }
+            uint32_t at = (uint32_t)nodes.size();
+            nodes.push_back({ node.box.min, node.first, node.box.max, node.count });
+            if (node.left < 0)
+                return;
+            flatten(tree, node.left, tasks, subtrees);
+            nodes[at].first = (uint32_t)nodes.size();
+            flatten(tree, node.right, tasks, subtrees);
+        }
+
+        void corners(uint32_t t, glm::vec3 &a, glm::vec3 &b, glm::vec3 &c) const
+        {
+            const Triangle &tri = triangles[t];
+            a = positions[tri.v[0]];
+            b = positions[tri.v[1]];
+            c = positions[tri.v[2]];
+        }
+
+        void triangle_bounds(uint32_t t, Box &box) const
+        {
+            glm::vec3 a, b, c;
+            corners(t, a, b, c);
+            box.min = glm::min(a, glm::min(b, c));
+            box.max = glm::max(a, glm::max(b, c));
+        }
+
+        // Distancia al cuadrado de 'p' a la caja del nodo.
+        static float box_distance2(const Node &node, glm::vec3 p)
+        {
+            glm::vec3 d = glm::max(glm::max(node.min - p, p - node.max), glm::vec3(0.0f));
+            return glm::dot(d, d);
+        }
+
+        // Rayo contra tringulo de Mller y Trumbore, por las dos caras. 'distance' en [0, limit).
+        bool ray_triangle(glm::vec3 o, glm::vec3 d, uint32_t t, float limit, float &distance) const
+        {
+            glm::vec3 a, b, c;
+            corners(t, a, b, c);
+            glm::vec3 e1 = b - a;
+            glm::vec3 e2 = c - a;
+            glm::vec3 p = glm::cross(d, e2);
+            float det = glm::dot(e1, p);
+            if (std::abs(det) < 1e-12f)
+                return false;
+            float inv = 1.0f / det;
+            glm::vec3 s = o - a;
+            float u = glm::dot(s, p) * inv;
+            if (u < 0.0f || u > 1.0f)
+                return false;
+            glm::vec3 q = glm::cross(s, e1);
+            float v = glm::dot(d, q) * inv;
+            if (v < 0.0f || u + v > 1.0f)
+                return false;
+            distance = glm::dot(e2, q) * inv;
+            return distance >= 0.0f && distance < limit;
+        }
+
+        // Punto del tringulo ms cercano a 'p' (por regiones de Voronoi de vrtices, aristas y cara).
+        glm::vec3 closest_on_triangle(uint32_t t, glm::vec3 p) const
+        {
+            glm::vec3 a, b, c;
+            corners(t, a, b, c);
+            return closest_on_triangle(a, b, c, p);
+        }
+
+        static glm::vec3 closest_on_triangle(glm::vec3 a, glm::vec3 b, glm::vec3 c, glm::vec3 p)
+        {
+            glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+            float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+            if (d1 <= 0.0f && d2 <= 0.0f) return a;
+            glm::vec3 bp = p - b;
+            float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+            if (d3 >= 0.0f && d4 <= d3) return b;
+            float vc = d1 * d4 - d3 * d2;
+            if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) return a + ab * (d1 / (d1 - d3));
+            glm::vec3 cp = p - c;
+            float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+            if (d6 >= 0.0f && d5 <= d6) return c;
+            float vb = d5 * d2 - d1 * d6;
+            if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) return a + ac * (d2 / (d2 - d6));
+            float va = d3 * d6 - d5 * d4;
+            if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+                return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+            if (va + vb + vc == 0.0f) return a; // Tringulo degenerado.
+            float denom = 1.0f / (va + vb + vc);
+            return a + ab * (vb * denom) + ac * (vc * denom);
+        }
+
+        // Puntos ms cercanos entre los segmentos [p1, q1] y [p2, q2].
+        static void closest_segments(glm::vec3 p1, glm::vec3 q1, glm::vec3 p2, glm::vec3 q2, glm::vec3 &c1, glm::vec3 &c2)
+        {
+            glm::vec3 d1 = q1 - p1, d2 = q2 - p2, r = p1 - p2;
+            float a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+            float s, t;
+            if (a <= 1e-12f && e <= 1e-12f) {
+                s = t = 0.0f;
+            } else if (a <= 1e-12f) {
+                s = 0.0f;
+                t = std::clamp(f / e, 0.0f, 1.0f);
+            } else {
+                float c = glm::dot(d1, r);
+                if (e <= 1e-12f) {
+                    t = 0.0f;
+                    s = std::clamp(-c / a, 0.0f, 1.0f);
+                } else {
+                    float b = glm::dot(d1, d2);
+                    float denom = a * e - b * b;
+                    s = denom != 0.0f ? std::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+                    t = (b * s + f) / e;
+                    if (t < 0.0f) {
+                        t = 0.0f;
+                        s = std::clamp(-c / a, 0.0f, 1.0f);
+                    } else if (t > 1.0f) {
+                        t = 1.0f;
+                        s = std::clamp((b - c) / a, 0.0f, 1.0f);
+                    }
+                }
+            }
+            c1 = p1 + d1 * s;
+            c2 = p2 + d2 * t;
+        }
+
+        // Puntos ms cercanos entre el segmento [p, q] y el tringulo 't'. Si el segmento lo cruza, coinciden.
+        // Si no, el mnimo est en un extremo del segmento contra la cara o en el segmento contra una arista.
+        void segment_triangle(glm::vec3 p, glm::vec3 q, uint32_t t, glm::vec3 &on_mesh, glm::vec3 &on_segment) const
+        {
+            glm::vec3 a, b, c;
+            corners(t, a, b, c);
+            float distance;
+            if (ray_triangle(p, q - p, t, 1.0f, distance))
+            {
+                on_segment = on_mesh = p + (q - p) * distance;
+                return;
+            }
+            float best = FLT_MAX;
+            auto consider = [&](glm::vec3 m, glm::vec3 s) {
+                float d2 = glm::dot(m - s, m - s);
+                if (d2 < best) { best = d2; on_mesh = m; on_segment = s; }
+            };
+            consider(closest_on_triangle(a, b, c, p), p);
+            consider(closest_on_triangle(a, b, c, q), q);
+            glm::vec3 edges[3][2] = { { a, b }, { b, c }, { c, a } };
+            for (auto &edge : edges)
+            {
+                glm::vec3 s, m;
+                closest_segments(p, q, edge[0], edge[1], s, m);
+                consider(m, s);
+            }
+        }
+
+        // Pasa al mundo un contacto calculado en espacio local; 'from' es el punto de la forma ms cercano.
+        void finish_contact(glm::vec3 from, float radius, MeshContact &contact) const
+        {
+            glm::vec3 offset = from - contact.point;
+            float distance = glm::length(offset);
+            glm::vec3 normal;
+            if (distance > 1e-6f) {
+                normal = offset / distance;
+            } else {
+                // El centro est sobre la malla: se empuja segn la normal del tringulo.
+                glm::vec3 a, b, c;
+                corners(contact.triangle, a, b, c);
+                normal = glm::normalize(glm::cross(b - a, c - a));
+            }
+            contact.point = glm::vec3(to_world * glm::vec4(contact.point, 1.0f));
+            contact.normal = glm::normalize(glm::vec3(to_world * glm::vec4(normal, 0.0f)));
+            contact.depth = radius - distance * scale;
+        }
+
+        struct Triangle {
+            uint32_t v[3];
+        };
+
+        std::vector<glm::vec3> positions; // Vrtices en espacio local.
+        std::vector<Triangle> triangles;
+        std::vector<Node> nodes; // Jerarqua aplanada en orden de profundidad; la raz es el nodo 0.
+        std::vector<uint32_t> order; // Tringulos ordenados por hoja.
+        std::vector<Box> bounds; // Cajas de los tringulos, solo durante la construccin.
+        std::vector<glm::vec3> centroids; // Centros de esas cajas, solo durante la construccin.
+        glm::mat4 to_world = glm::mat4(1.0f);
+        glm::mat4 to_local = glm::mat4(1.0f);
+        float scale = 1.0f;
+
+        static constexpr uint32_t leaf_size = 4; // Por debajo de esta cantidad de tringulos no se parte.
+        static constexpr int max_depth = 96; // Profundidad mxima del rbol y tamao de la pila de recorrido.
+};
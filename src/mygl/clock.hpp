@@ -1,28 +1,72 @@
 #pragma once
 
 #include <GLFW/glfw3.h> // Incluye la biblioteca GLFW para manejar ventanas y el tiempo.
+#include <chrono> // Para dormir el hilo al limitar los frames por segundo.
+#include <thread>
 
+// Clock es el nico servicio de tiempo de la aplicacin. Lo posee el Context y
+// alimenta un bucle de simulacin de paso fijo: cada frame acumula el tiempo real
+// transcurrido y la simulacin avanza en pasos de 'fixed_delta_time' mientras haya
+// tiempo acumulado. Lo que sobra se expresa como 'alpha' para interpolar al renderizar.
 class Clock
 {
 public:
-    double current_time; // Almacena el tiempo actual en segundos desde el inicio del programa.
-    float delta_time; // Almacena el tiempo transcurrido (en segundos) entre el frame actual y el ltimo frame.
-    float last_frame; // Almacena el tiempo en el que se renderiz el ltimo frame.
+    double current_time = 0.0; // Almacena el tiempo actual en segundos desde el inicio del programa.
+    float delta_time = 0.0f; // Almacena el tiempo transcurrido (en segundos) entre el frame actual y el ltimo frame.
+    double last_frame = 0.0; // Almacena el tiempo en el que se renderiz el ltimo frame.
 
-    // Constructor de la clase Clock. Inicializa el reloj actualizando sus valores.
-    Clock() { update(); };
+    float fixed_delta_time = 1.0f / 60.0f; // Duracin de cada paso de simulacin.
+    float max_frame_time = 0.25f; // Tope del tiempo de frame para evitar una espiral de pasos tras un bloqueo.
+    double simulation_time = 0.0; // Tiempo simulado acumulado (avanza solo en pasos fijos).
+    float alpha = 0.0f; // Fraccin del paso siguiente ya transcurrida, en [0, 1).
 
-    // Funcin update: actualiza el reloj calculando el tiempo transcurrido desde el ltimo frame.
+    // Constructor de la clase Clock. El reloj se inicia con reset() una vez creada la ventana.
+    Clock() {}
+
+    // Funcin update: actualiza el reloj calculando el tiempo transcurrido desde el ltimo frame
+    // y lo suma al acumulador de la simulacin.
     void update() {
         current_time = glfwGetTime(); // Obtiene el tiempo actual en segundos.
         delta_time = current_time - last_frame; // Calcula el delta de tiempo entre frames.
         last_frame = current_time; // Actualiza el tiempo del ltimo frame al tiempo actual.
+
+        if (delta_time > max_frame_time) delta_time = max_frame_time;
+        accumulator += delta_time;
     };
 
-    // Funcin reset: reinicia el reloj. Esencialmente hace lo mismo que update.
+    // Funcin step: consume un paso fijo del acumulador. Devuelve false cuando ya no queda
+    // tiempo para otro paso completo y deja calculado 'alpha' para la interpolacin.
+    bool step() {
+        if (accumulator >= fixed_delta_time)
+        {
+            accumulator -= fixed_delta_time;
+            simulation_time += fixed_delta_time;
+            return true;
+        }
+        alpha = (float)(accumulator / fixed_delta_time);
+        return false;
+    }
+
+    // Funcin reset: reinicia el reloj descartando el tiempo acumulado (por ejemplo, tras cargar una escena).
     void reset() {
         current_time = glfwGetTime(); // Obtiene el tiempo actual en segundos.
-        delta_time = current_time - last_frame; // Calcula el delta de tiempo entre frames.
+        delta_time = 0.0f;
         last_frame = current_time; // Actualiza el tiempo del ltimo frame al tiempo actual.
+        accumulator = 0.0;
+        alpha = 0.0f;
+    }
+
+    // Funcin throttle: si max_fps es mayor que cero, espera hasta completar la duracin mnima del frame.
+    void throttle(int max_fps) const {
+        if (max_fps <= 0)
+            return;
+        double frame_end = last_frame + 1.0 / max_fps;
+        double remaining = frame_end - glfwGetTime();
+        if (remaining > 0.002)
+            std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.001));
+        while (glfwGetTime() < frame_end) {}
     }
+
+private:
+    double accumulator = 0.0; // Tiempo real pendiente de simular.
 };
@@ -2,11 +2,25 @@
 #define CONTEXT_HPP
 
 #include <iostream>
+#include <functional>
+#include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
 #include "sound.hpp"
 #include "iscene.hpp"
+#include "profiler.hpp"
+#include "clock.hpp"
+#include "job_system.hpp"
+#include "upload_queue.hpp"
+
+// Escena registrada en el Context. Se construye con 'factory' la primera vez que se necesita.
+struct SceneSlot {
+    std::function<IScene*()> factory; // Crea la escena (puede estar vaca si la escena se construy por fuera).
+    IScene* scene = nullptr; // Instancia de la escena, nula hasta que se necesita.
+    bool load_started = false; // Verdadero desde que se llam a begin_load hasta que la escena se descarga.
+    bool release_on_close = false; // Si es verdadero, la escena libera sus recursos al cerrarse.
+};
 
 // La clase Context gestiona el contexto de la aplicacin, incluyendo la ventana, la escena actual y el sistema de sonido.
 class Context
@@ -21,6 +35,8 @@ class Context
             window = create_window();
             load_glad();
             set_callbacks();
+            uploads.init(upload_budget);
+            clock.reset();
         };
 
         // Establece los callbacks para eventos de GLFW, como el cambio de tamao de la ventana, movimientos del mouse, etc.
@@ -33,23 +49,90 @@ class Context
             glfwSetScrollCallback(window, scroll_callback_wrapper);  
         }
 
-        // Carga una nueva escena en el contexto, cerrando la escena actual si existe.
-        void load_scene(IScene *scene)
+        // Registra una escena y devuelve su ID. La escena no se construye hasta que se necesita.
+        // Con 'release_on_close' la escena libera sus recursos cada vez que se cierra.
+        int add_scene(std::function<IScene*()> factory, bool release_on_close = false)
         {
-            if (current_scene != nullptr)
-                current_scene->close_scene();
-            current_scene = scene;
-            current_scene->open_scene();
-            framebuffer_size_callback_wrapper(window, win_width, win_height); //because
+            SceneSlot slot;
+            slot.factory = factory;
+            slot.release_on_close = release_on_close;
+            scenes.push_back(slot);
+            return (int)scenes.size() - 1;
+        }
+
+        // Almacena una escena ya construida. Las escenas lo llaman desde store_scene_in_ctx: si la escena
+        // se est construyendo por su fbrica ocupa ese lugar; si no, se agrega al final.
+        void store_scene(IScene *scene)
+        {
+            if (instantiating >= 0)
+            {
+                scenes[instantiating].scene = scene;
+                return;
+            }
+            SceneSlot slot;
+            slot.scene = scene;
+            scenes.push_back(slot);
         }
 
-        // Carga una escena basada en su ID dentro del vector de escenas.
+        // Devuelve la escena con ese ID, construyndola si todava no existe.
+        IScene* get_scene(int id)
+        {
+            if (scenes[id].scene == nullptr && scenes[id].factory)
+            {
+                PROFILE_ZONE("Context::instantiate_scene");
+                instantiating = id;
+                IScene* scene = scenes[id].factory();
+                instantiating = -1;
+                scenes[id].scene = scene;
+            }
+            return scenes[id].scene;
+        }
+
+        // Construye la escena si hace falta e inicia su carga sin abrirla, para que avance en segundo plano.
+        void preload_scene(int id)
+        {
+            IScene* scene = get_scene(id);
+            if (!scenes[id].load_started)
+            {
+                scenes[id].load_started = true;
+                scene->begin_load();
+            }
+        }
+
+        // Carga una escena basada en su ID dentro del vector de escenas. Si sus recursos todava se estn
+        // cargando se abre la pantalla de carga, que cambia a la escena cuando termina.
         void load_scene_id(int id)
         {
-            load_scene(scenes[id]);
+            preload_scene(id);
+            IScene* scene = scenes[id].scene;
+            if (scene->load_progress() < 1.0f)
+            {
+                if (loading_scene != nullptr)
+                {
+                    loading_target = id;
+                    open_scene(loading_scene, -1);
+                    return;
+                }
+                finish_loading(id); // Sin pantalla de carga se espera a que termine.
+            }
+            open_scene(scene, id);
         }
 
-        // Ejecuta el bucle principal del programa, procesando la entrada, actualizando y renderizando la escena actual.
+        // Destruye las escenas construidas. Debe llamarse despus de detener el JobSystem.
+        void delete_scenes()
+        {
+            for (SceneSlot &slot : scenes)
+            {
+                if (slot.factory)
+                    delete slot.scene;
+                slot.scene = nullptr;
+            }
+            current_scene = nullptr;
+        }
+
+        // Ejecuta el bucle principal del programa. Cada frame procesa la entrada, avanza la simulacin
+        // en pasos fijos (fixed_update) segn el tiempo acumulado y luego renderiza la escena (update)
+        // interpolando con clock.alpha. As el costo y el resultado de la simulacin no dependen de la tasa de refresco.
         void run()
         {
             if (current_scene == nullptr) 
@@ -59,12 +142,37 @@ class Context
             }
             while (!glfwWindowShouldClose(window))
             {
+                PROFILE_FRAME();
+                PROFILE_ZONE("Context::run");
+
+                clock.update();
                 current_scene->scene_clear();
-                current_scene->process_input();
-                current_scene->update();
+                {
+                    PROFILE_ZONE("IScene::process_input");
+                    current_scene->process_input();
+                }
+                {
+                    PROFILE_ZONE("JobSystem::run_main_thread_jobs");
+                    jobs.run_main_thread_jobs(main_job_budget);
+                }
+                uploads.process();
+                while (clock.step())
+                {
+                    PROFILE_ZONE("IScene::fixed_update");
+                    current_scene->fixed_update(clock.fixed_delta_time);
+                }
+                {
+                    PROFILE_ZONE("IScene::update");
+                    current_scene->update();
+                }
 
-                glfwSwapBuffers(window);
+                {
+                    PROFILE_ZONE("glfwSwapBuffers");
+                    glfwSwapBuffers(window);
+                }
                 glfwPollEvents();
+                poll_profiler_dump();
+                clock.throttle(max_fps);
             }
             ma_engine_uninit(&sound_manager.engine);
         }
@@ -76,11 +184,64 @@ class Context
         float aspect_ratio = win_width / win_height; // Relacin de aspecto de la ventana.
         const char* win_name;
 
+        Clock clock; // Reloj nico de la aplicacin: tiempo de frame y paso fijo de simulacin.
+        int max_fps = 0; // Lmite de frames por segundo al renderizar; 0 significa sin lmite.
+        JobSystem& jobs = JobSystem::get(); // Sistema de trabajos; sus tareas con afinidad Main se ejecutan en cada frame.
+        double main_job_budget = 0.004; // Tiempo mximo por frame (segundos) para las tareas del hilo principal.
+        UploadQueue& uploads = UploadQueue::get(); // Cola de subidas a la GPU; avanza una vez por frame.
+        size_t upload_budget = 4 << 20; // Bytes mximos que la cola de subidas copia por frame.
+
         IScene* current_scene = nullptr; // Puntero a la escena actual.
-        std::vector<IScene*> scenes; // Vector que almacena todas las escenas disponibles.
+        int current_id = -1; // ID de la escena actual (-1 para la pantalla de carga).
+        std::vector<SceneSlot> scenes; // Vector que almacena todas las escenas disponibles.
+        IScene* loading_scene = nullptr; // Pantalla de carga, fuera del vector de escenas.
+        int loading_target = -1; // ID de la escena que espera la pantalla de carga.
         Sound sound_manager; // Gestor de sonido para la aplicacin.
     
     private:
+        bool dump_key_down = false; // Estado previo de la tecla de volcado del profiler.
+        int instantiating = -1; // ID de la escena que se est construyendo por su fbrica.
+
+        // Abre una escena, cerrando la escena actual si existe (y descargndola si as se registr).
+        void open_scene(IScene *scene, int id)
+        {
+            if (current_scene != nullptr)
+            {
+                current_scene->close_scene();
+                if (current_id >= 0 && current_id != id && scenes[current_id].release_on_close)
+                {
+                    current_scene->unload();
+                    scenes[current_id].load_started = false;
+                }
+            }
+            current_scene = scene;
+            current_id = id;
+            current_scene->open_scene();
+            framebuffer_size_callback_wrapper(window, win_width, win_height); //because
+            clock.reset(); // Descarta el tiempo consumido al abrir la escena para que la simulacin no intente recuperarlo.
+        }
+
+        // Atiende los trabajos del hilo principal y la cola de subidas hasta que la escena termina de cargarse.
+        void finish_loading(int id)
+        {
+            PROFILE_ZONE("Context::finish_loading");
+            while (scenes[id].scene->load_progress() < 1.0f)
+            {
+                jobs.run_main_thread_jobs();
+                uploads.process();
+                std::this_thread::yield();
+            }
+        }
+
+        // Al presionar F12 escribe la traza del profiler (formato Chrome trace_event) en disco.
+        void poll_profiler_dump()
+        {
+            bool pressed = glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+            if (pressed && !dump_key_down)
+                Profiler::get().dump_chrome_trace("./profile_trace.json");
+            dump_key_down = pressed;
+        }
+
         // Crea y devuelve un nuevo objeto GLFWwindow con las especificaciones dadas.
         GLFWwindow *create_window() {
             glfwInit();
@@ -17,10 +17,18 @@ class IScene {
         virtual void store_scene_in_ctx() = 0; // Mtodo para almacenar la instancia de la escena en el contexto global del juego.
         virtual void open_scene() = 0; // Mtodo llamado al abrir la escena. Se utiliza para inicializar recursos.
         virtual void close_scene() = 0; // Mtodo llamado al cerrar la escena. Se utiliza para liberar recursos.
-        virtual void update() = 0; // Mtodo para actualizar la lgica de la escena en cada frame.
+        virtual void fixed_update(float delta_time) = 0; // Mtodo para avanzar la simulacin un paso fijo de 'delta_time' segundos.
+        virtual void update() = 0; // Mtodo para renderizar la escena en cada frame, interpolando entre pasos de simulacin.
         virtual void scene_clear() = 0; // Mtodo para limpiar la escena. Se llama antes de renderizar el siguiente frame.
         virtual void process_input() = 0; // Mtodo para procesar la entrada del usuario.
 
+        // Fase de carga asncrona. El Context llama a begin_load (en el hilo principal) antes de abrir la escena
+        // por primera vez; la escena puede programar su carga en el JobSystem y devolver el control enseguida.
+        // Mientras load_progress sea menor que 1 el Context muestra la pantalla de carga en su lugar.
+        virtual void begin_load() {} // Inicia la carga de los recursos de la escena.
+        virtual float load_progress() { return 1.0f; } // Avance de la carga en [0, 1].
+        virtual void unload() {} // Libera los recursos cargados; la prxima apertura vuelve a llamar a begin_load.
+
         // Callback para manejar
         virtual void mouse_callback(GLFWwindow* window, double xposIn, double yposIn) = 0; // el movimiento del mouse dentro de la ventana de la escena.
         virtual void left_click_callback(GLFWwindow* window, int button, int action, int mods) = 0; // los clics del mouse dentro de la ventana de la escena.
@@ -0,0 +1,262 @@
+#include "job_system.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+
+// ndice del trabajador que ejecuta el hilo actual (-1 fuera de los trabajadores).
+static thread_local int current_worker = -1;
+
+JobSystem& JobSystem::get()
+{
+    static JobSystem jobs(std::max(1u, std::thread::hardware_concurrency() - 1));
+    return jobs;
+}
+
+JobSystem::JobSystem(unsigned int worker_count)
+{
+    if (worker_count == 0) worker_count = 1;
+    for (unsigned int i = 0; i < worker_count; i++)
+        queues.push_back(std::make_unique<WorkerQueue>());
+    for (unsigned int i = 0; i < worker_count; i++)
+        workers.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+JobSystem::~JobSystem() { shutdown(); }
+
+void JobSystem::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        stopping = true;
+    }
+    wake_cv.notify_all();
+    for (auto &worker : workers)
+        if (worker.joinable())
+            worker.join();
+    workers.clear();
+}
+
+bool JobSystem::is_worker_thread() { return current_worker >= 0; }
+
+JobHandle JobSystem::schedule(std::function<void()> fn, std::initializer_list<JobHandle> dependencies, JobAffinity affinity)
+{
+    return schedule(std::move(fn), std::vector<JobHandle>(dependencies), affinity);
+}
+
+JobHandle JobSystem::schedule(std::function<void()> fn, const std::vector<JobHandle> &dependencies, JobAffinity affinity)
+{
+    JobHandle job = std::make_shared<Job>();
+    job->fn = std::move(fn);
+    job->affinity = affinity;
+    job->pending = 1 + (int)dependencies.size();
+
+    for (const JobHandle &dep : dependencies)
+    {
+        if (!dep)
+        {
+            job->pending--;
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(dep->mutex);
+        if (dep->done)
+            job->pending--;
+        else
+            dep->continuations.push_back(job);
+    }
+
+    // Libera la referencia de programacin; si no quedan dependencias el trabajo se encola.
+    release(job);
+    return job;
+}
+
+void JobSystem::release(const JobHandle &job)
+{
+    if (job->pending.fetch_sub(1) == 1)
+        enqueue(job);
+}
+
+void JobSystem::enqueue(const JobHandle &job)
+{
+    if (job->affinity == JobAffinity::Main)
+    {
+        {
+            std::lock_guard<std::mutex> lock(main_mutex);
+            main_jobs.push_back(job);
+        }
+        {
+            std::lock_guard<std::mutex> lock(done_mutex);
+        }
+        done_cv.notify_all(); // Despierta al hilo principal si est esperando.
+        return;
+    }
+
+    // Desde un trabajador se encola en su propia cola; desde fuera, en round-robin.
+    unsigned int index = current_worker >= 0 ? (unsigned int)current_worker : next_queue++ % (unsigned int)queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->jobs.push_back(job);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex);
+        queued++;
+    }
+    wake_cv.notify_one();
+}
+
+JobHandle JobSystem::try_pop(int index)
+{
+    int count = (int)queues.size();
+
+    // Primero la cola propia, por el final (el trabajo ms reciente sigue caliente en cach).
+    if (index >= 0)
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        if (!queues[index]->jobs.empty())
+        {
+            JobHandle job = queues[index]->jobs.back();
+            queues[index]->jobs.pop_back();
+            queued--;
+            return job;
+        }
+    }
+
+    // Luego roba por el frente de las colas de los dems.
+    int start = index >= 0 ? index + 1 : 0;
+    for (int i = 0; i < count; i++)
+    {
+        WorkerQueue &victim = *queues[(start + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty())
+        {
+            JobHandle job = victim.jobs.front();
+            victim.jobs.pop_front();
+            queued--;
+            return job;
+        }
+    }
+    return nullptr;
+}
+
+void JobSystem::execute(const JobHandle &job)
+{
+    {
+        PROFILE_ZONE("Job");
+        job->fn();
+    }
+
+    std::vector<JobHandle> continuations;
+    {
+        std::lock_guard<std::mutex> lock(job->mutex);
+        job->done = true;
+        continuations.swap(job->continuations);
+    }
+    {
+        std::lock_guard<std::mutex> lock(done_mutex);
+    }
+    done_cv.notify_all();
+
+    for (const JobHandle &next : continuations)
+        release(next);
+}
+
+void JobSystem::worker_loop(unsigned int index)
+{
+    current_worker = (int)index;
+    std::string name = "worker " + std::to_string(index);
+    PROFILE_THREAD(name.c_str());
+
+    while (true)
+    {
+        JobHandle job = try_pop((int)index);
+        if (job)
+        {
+            execute(job);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex);
+        wake_cv.wait(lock, [this] { return queued > 0 || stopping; });
+        if (stopping)
+            return;
+    }
+}
+
+void JobSystem::run_main_thread_jobs(double budget_seconds)
+{
+    auto start = std::chrono::steady_clock::now();
+    while (true)
+    {
+        JobHandle job;
+        {
+            std::lock_guard<std::mutex> lock(main_mutex);
+            if (main_jobs.empty())
+                return;
+            job = main_jobs.front();
+            main_jobs.pop_front();
+        }
+        execute(job);
+
+        if (budget_seconds > 0.0)
+        {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= budget_seconds)
+                return;
+        }
+    }
+}
+
+void JobSystem::wait(const JobHandle &job)
+{
+    if (!job)
+        return;
+
+    while (!job->done)
+    {
+        if (current_worker >= 0)
+        {
+            // Un trabajador ayuda con otros trabajos en lugar de bloquearse.
+            JobHandle other = try_pop(current_worker);
+            if (other) execute(other);
+            else std::this_thread::yield();
+            continue;
+        }
+
+        // El hilo principal atiende su cola de afinidad y duerme hasta que algo termine.
+        run_main_thread_jobs();
+        std::unique_lock<std::mutex> lock(done_mutex);
+        done_cv.wait_for(lock, std::chrono::milliseconds(1), [&] {
+            if (job->done) return true;
+            std::lock_guard<std::mutex> main_lock(main_mutex);
+            return !main_jobs.empty();
+        });
+    }
+}
+
+void JobSystem::wait_all(const std::vector<JobHandle> &jobs)
+{
+    for (const JobHandle &job : jobs)
+        wait(job);
+}
+
+void JobSystem::parallel_for(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &fn)
+{
+    if (end <= begin)
+        return;
+    if (grain == 0) grain = 1;
+
+    if (end - begin <= grain)
+    {
+        fn(begin, end);
+        return;
+    }
+
+    std::vector<JobHandle> chunks;
+    for (size_t b = begin; b < end; b += grain)
+    {
+        size_t e = std::min(end, b + grain);
+        chunks.push_back(schedule([&fn, b, e] { fn(b, e); }));
+    }
+    wait_all(chunks);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Afinidad de un trabajo: cualquier hilo trabajador o el hilo principal (el nico con contexto OpenGL).
+enum class JobAffinity {
+    Any,
+    Main
+};
+
+// Trabajo programado en el JobSystem. Se referencia mediante JobHandle.
+struct Job {
+    std::function<void()> fn; // Funcin a ejecutar.
+    JobAffinity affinity = JobAffinity::Any;
+    std::atomic<int> pending{1}; // Dependencias sin terminar (+1 mientras se programa).
+    std::atomic<bool> done{false}; // Verdadero cuando la funcin termin.
+    std::mutex mutex; // Protege 'continuations'.
+    std::vector<std::shared_ptr<Job>> continuations; // Trabajos que dependen de este.
+};
+
+using JobHandle = std::shared_ptr<Job>;
+
+// JobSystem es un planificador de trabajos con robo de tareas (work stealing).
+// Cada hilo trabajador tiene su propia cola: el dueo toma los trabajos por el final (LIFO)
+// y los dems roban por el frente (FIFO). Los trabajos pueden depender de otros y los que
+// tocan OpenGL se encolan con afinidad Main para ejecutarse en el hilo principal.
+class JobSystem {
+    public:
+        // Instancia global. Crea hardware_concurrency - 1 trabajadores (al menos uno).
+        static JobSystem& get();
+
+        JobSystem(unsigned int worker_count);
+        ~JobSystem();
+
+        // Programa un trabajo que se ejecutar cuando terminen todas sus dependencias.
+        JobHandle schedule(std::function<void()> fn, std::initializer_list<JobHandle> dependencies = {}, JobAffinity affinity = JobAffinity::Any);
+
+        // Igual que schedule, pero con las dependencias en un vector.
+        JobHandle schedule(std::function<void()> fn, const std::vector<JobHandle> &dependencies, JobAffinity affinity = JobAffinity::Any);
+
+        // Espera a que termine el trabajo. En un trabajador ayuda ejecutando otros trabajos;
+        // en el hilo principal ejecuta los trabajos con afinidad Main mientras espera.
+        void wait(const JobHandle &job);
+        void wait_all(const std::vector<JobHandle> &jobs);
+
+        // Divide [begin, end) en bloques de 'grain' elementos y los procesa en paralelo.
+        // 'fn' recibe el subrango [b, e). Retorna cuando todos los bloques terminaron.
+        void parallel_for(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+        // Ejecuta los trabajos pendientes con afinidad Main. Debe llamarse desde el hilo principal.
+        // Si 'budget_seconds' es mayor que cero, se detiene al agotar ese tiempo.
+        void run_main_thread_jobs(double budget_seconds = 0.0);
+
+        // Detiene y une los hilos trabajadores. Los trabajos an en cola se descartan.
+        void shutdown();
+
+        // Cantidad de hilos trabajadores.
+        unsigned int worker_count() const { return (unsigned int)workers.size(); }
+
+        // Verdadero si el hilo actual es un trabajador de este sistema.
+        static bool is_worker_thread();
+
+    private:
+        struct WorkerQueue {
+            std::mutex mutex;
+            std::deque<JobHandle> jobs;
+        };
+
+        void worker_loop(unsigned int index);
+        void enqueue(const JobHandle &job);
+        void execute(const JobHandle &job);
+        JobHandle try_pop(int index);
+        void release(const JobHandle &job);
+
+        std::vector<std::thread> workers;
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        std::atomic<unsigned int> next_queue{0}; // Reparto round-robin desde hilos externos.
+
+        std::mutex sleep_mutex; // Para dormir a los trabajadores sin trabajo.
+        std::condition_variable wake_cv;
+        std::atomic<int> queued{0}; // Trabajos encolados an no tomados.
+        std::atomic<bool> stopping{false};
+
+        std::mutex main_mutex; // Protege 'main_jobs'.
+        std::deque<JobHandle> main_jobs; // Cola de afinidad con el hilo principal (OpenGL).
+
+        std::mutex done_mutex; // Para que el hilo principal espere sin consumir CPU.
+        std::condition_variable done_cv;
+};
@@ -10,6 +10,7 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include "shader.h"
+#include "upload_queue.hpp"
 
 using namespace std;
 
@@ -45,16 +46,20 @@ public:
     vector<unsigned int> indices;
     vector<Texture>      textures;
     unsigned int vao;
+    // pending streamed uploads of the vertex and index data (null when uploaded synchronously)
+    UploadHandle vertex_upload, index_upload;
 
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    // constructor. When upload is false the GL buffers are not created yet (the mesh may be built on a worker
+    // thread); setup_mesh() must then be called later from the thread that owns the GL context.
+    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, bool upload = true)
     {
         this->vertices = vertices;
         this->indices = indices;
         this->textures = textures;
 
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
-        setup_mesh();
+        if (upload)
+            setup_mesh();
     }
 
     // render the mesh
@@ -95,12 +100,15 @@ public:
         glActiveTexture(GL_TEXTURE0);
     }
 
-private:
-    // render data 
-    unsigned int vbo, ebo;
+    // true once the vertex and index data is on the GPU
+    bool ready() const
+    {
+        return (!vertex_upload || vertex_upload->ready) && (!index_upload || index_upload->ready);
+    }
 
-    // initializes all the buffer objects/arrays
-    void setup_mesh()
+    // initializes all the buffer objects/arrays. With an upload queue only the storage is allocated here and
+    // the data is streamed through the queue's staging buffer; the mesh must then stay in place until ready().
+    void setup_mesh(UploadQueue *uploads = nullptr)
     {
         // create buffers/arrays
         glGenVertexArrays(1, &vao);
@@ -113,10 +121,14 @@ private:
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);  
+        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), uploads ? nullptr : &vertices[0], GL_STATIC_DRAW);
+        if (uploads)
+            vertex_upload = uploads->upload_buffer(vbo, 0, &vertices[0], vertices.size() * sizeof(Vertex));
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), uploads ? nullptr : &indices[0], GL_STATIC_DRAW);
+        if (uploads)
+            index_upload = uploads->upload_buffer(ebo, 0, &indices[0], indices.size() * sizeof(unsigned int));
 
         // set the vertex attribute pointers
         // vertex Positions
@@ -143,5 +155,17 @@ private:
 		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, m_weights));
         glBindVertexArray(0);
     }
+
+    // releases the vertex array and buffers
+    void release()
+    {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ebo);
+    }
+
+private:
+    // render data 
+    unsigned int vbo, ebo;
 };
 #endif
\ No newline at end of file
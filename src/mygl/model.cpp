@@ -5,38 +5,65 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
 {
     string filename = string(path);
     filename = directory + '/' + filename;
+    PROFILE_ZONE_TEXT("TextureFromFile", filename.c_str());
 
+    TextureImage image;
+    image.path = filename;
+    image.data = stbi_load(filename.c_str(), &image.width, &image.height, &image.components, 0);
+    return TextureFromImage(image, gamma);
+}
+
+unsigned int TextureFromImage(TextureImage &image, bool gamma)
+{
     unsigned int textureID;
     glGenTextures(1, &textureID);
 
-    int width, height, nrComponents;
-    unsigned char *data = stbi_load(filename.c_str(), &width, &height, &nrComponents, 0);
-    if (data)
+    if (image.data)
     {
-        GLenum format;
-        if (nrComponents == 1)
-            format = GL_RED;
-        else if (nrComponents == 3)
-            format = GL_RGB;
-        else if (nrComponents == 4)
-            format = GL_RGBA;
+        GLenum format = image_format(image.components);
 
         glBindTexture(GL_TEXTURE_2D, textureID);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
         glGenerateMipmap(GL_TEXTURE_2D);
 
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        stbi_image_free(data);
     }
     else
     {
-        std::cout << "Texture failed to load at path: " << path << std::endl;
-        stbi_image_free(data);
+        std::cout << "Texture failed to load at path: " << image.path << std::endl;
+    }
+    free_image(image);
+
+    return textureID;
+}
+
+unsigned int TextureFromImage(TextureImage &image, UploadQueue &uploads, UploadHandle &status)
+{
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+
+    if (!image.data)
+    {
+        std::cout << "Texture failed to load at path: " << image.path << std::endl;
+        status = nullptr;
+        return textureID;
     }
 
+    // immutable storage is allocated now; the pixels are streamed by the upload queue and freed once copied.
+    glBindTexture(GL_TEXTURE_2D, textureID);
+    glTexStorage2D(GL_TEXTURE_2D, mip_levels(image.width, image.height), image_internal_format(image.components), image.width, image.height);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    TextureImage pixels = image;
+    image.data = nullptr;
+    status = uploads.upload_texture(textureID, pixels.width, pixels.height, pixels.components, pixels.data, true,
+                                    [pixels]() mutable { free_image(pixels); });
     return textureID;
-}
\ No newline at end of file
+}
@@ -14,6 +14,10 @@
 #include "shader.h"
 #include "icamera.hpp"
 #include "transform.hpp"
+#include "profiler.hpp"
+#include "texture_image.hpp"
+#include "job_system.hpp"
+#include "upload_queue.hpp"
 
 #include <string>
 #include <fstream>
@@ -25,6 +29,8 @@
 using namespace std;
 
 unsigned int TextureFromFile(const char *path, const string &directory, bool gamma = false);
+unsigned int TextureFromImage(TextureImage &image, bool gamma = false);
+unsigned int TextureFromImage(TextureImage &image, UploadQueue &uploads, UploadHandle &status);
 
 class Model 
 {
@@ -42,14 +48,103 @@ class Model
             load_model(path);
         }
         Model() = default;
+
+        // CPU half of the loading: Assimp import, mesh building and texture decoding (in parallel).
+        // Touches no GL state, so it can run on a worker thread. upload() must follow on the main thread.
+        void import(string const &path, bool flip_textures)
+        {
+            deferred = true;
+            this->flip_textures = flip_textures;
+            load_model(path);
+
+            JobSystem::get().parallel_for(0, pending_images.size(), 1, [this](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++)
+                {
+                    if (!decode_image(pending_images[i].path, this->flip_textures, pending_images[i]))
+                        std::cout << "Texture failed to load at path: " << pending_images[i].path << std::endl;
+                }
+            });
+        }
+
+        // GL half of the loading: creates the textures and vertex buffers. Main thread only.
+        // The data itself is streamed through the upload queue over the next frames; the model is not drawn until is_ready().
+        void upload()
+        {
+            PROFILE_ZONE("Model::upload");
+            UploadQueue &uploads = UploadQueue::get();
+            texture_uploads.resize(pending_images.size());
+            for (size_t i = 0; i < pending_images.size(); i++)
+                textures_loaded[i].id = TextureFromImage(pending_images[i], uploads, texture_uploads[i]);
+            pending_images.clear();
+
+            for (Mesh &mesh : meshes)
+            {
+                for (Texture &texture : mesh.textures)
+                {
+                    for (const Texture &loaded : textures_loaded)
+                    {
+                        if (loaded.path == texture.path) { texture.id = loaded.id; break; }
+                    }
+                }
+                mesh.setup_mesh(&uploads);
+            }
+            deferred = false;
+            ready = false;
+        }
+
+        // true once every texture and mesh buffer of the model is on the GPU
+        bool is_ready()
+        {
+            if (ready)
+                return true;
+            for (const UploadHandle &status : texture_uploads)
+            {
+                if (status && !status->ready)
+                    return false;
+            }
+            for (const Mesh &mesh : meshes)
+            {
+                if (!mesh.ready())
+                    return false;
+            }
+            texture_uploads.clear();
+            ready = true;
+            return true;
+        }
+
+        // releases the textures and buffers of the model. The model is empty afterwards and can be loaded again.
+        // Streamed uploads must have finished (is_ready) before releasing.
+        void release()
+        {
+            for (Texture &texture : textures_loaded)
+                glDeleteTextures(1, &texture.id);
+            for (Mesh &mesh : meshes)
+                mesh.release();
+            textures_loaded.clear();
+            meshes.clear();
+            texture_uploads.clear();
+            ready = true;
+        }
+
         // draws the model, and thus all its meshes
         void draw(Shader &shader, const ICamera &camera)
         {
+            if (!is_ready())
+                return;
+            glm::mat4 mat;
+            glm::mat3 normal;
+            transform.matrices(mat, normal);
+            draw(shader, camera, mat, normal);
+        }
+
+        // draws the model with precomputed model and normal matrices (e.g. from a TransformArray) instead of its transform
+        void draw(Shader &shader, const ICamera &camera, const glm::mat4 &mat, const glm::mat3 &normal)
+        {
+            if (!is_ready())
+                return;
             shader.use();
-            glm::mat4 mat = transform.get_model_matrix();
             glm::mat4 projection = camera.get_projection_matrix();
             glm::mat4 view = camera.get_view_matrix();
-            glm::mat3 normal = glm::transpose(glm::inverse(mat));
 
             shader.set_mat4("model", mat);
             shader.set_mat4("projection", projection);
@@ -61,12 +156,23 @@ class Model
         }
     
     private:
+        bool deferred = false; // true while importing without GL access (see import/upload).
+        bool flip_textures = false; // flip decoded textures vertically (deferred loading only).
+        vector<TextureImage> pending_images; // decoded textures waiting for upload, same order as textures_loaded.
+        vector<UploadHandle> texture_uploads; // streamed texture uploads still in flight.
+        bool ready = true; // false until every streamed upload has finished.
+
         // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
         void load_model(string const &path)
         {
+            PROFILE_ZONE_TEXT("Model::load_model", path.c_str());
             // read file via ASSIMP
             Assimp::Importer importer;
-            const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+            const aiScene* scene;
+            {
+                PROFILE_ZONE("Assimp::ReadFile");
+                scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_FlipUVs | aiProcess_CalcTangentSpace);
+            }
             // check for errors
             if(!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
             {
@@ -180,7 +286,7 @@ class Model
             textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
             
             // return a mesh object created from the extracted mesh data
-            return Mesh(vertices, indices, textures);
+            return Mesh(vertices, indices, textures, !deferred);
         }
 
         // checks all material textures of a given type and loads the textures if they're not loaded yet.
@@ -206,7 +312,15 @@ class Model
                 if(!skip)
                 {   // if texture hasn't been loaded already, load it
                     Texture texture;
-                    texture.id = TextureFromFile(str.C_Str(), this->directory);
+                    texture.id = 0;
+                    if (deferred)
+                    {
+                        TextureImage image;
+                        image.path = this->directory + '/' + string(str.C_Str());
+                        pending_images.push_back(image);
+                    }
+                    else
+                        texture.id = TextureFromFile(str.C_Str(), this->directory);
                     texture.type = typeName;
                     texture.path = str.C_Str();
                     textures.push_back(texture);
@@ -0,0 +1,104 @@
+#include "profiler.hpp"
+
+#include <fstream>
+#include <iostream>
+
+// Escribe una cadena escapada para JSON.
+static void write_json_string(std::ofstream &out, const char* text)
+{
+    out << '"';
+    for (const char* c = text; *c != '\0'; c++)
+    {
+        if (*c == '"' || *c == '\\') out << '\\' << *c;
+        else if ((unsigned char)*c < 0x20) out << ' ';
+        else out << *c;
+    }
+    out << '"';
+}
+
+// Escribe un tiempo en nanosegundos como microsegundos con tres decimales (unidad de trace_event).
+static void write_micros(std::ofstream &out, uint64_t ns)
+{
+    uint64_t frac = ns % 1000;
+    out << ns / 1000 << '.' << (char)('0' + frac / 100) << (char)('0' + frac / 10 % 10) << (char)('0' + frac % 10);
+}
+
+Profiler& Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+ProfileRing* Profiler::register_thread()
+{
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    uint32_t id = (uint32_t)rings.size();
+    std::string name = id == 0 ? "main" : "thread " + std::to_string(id);
+    rings.push_back(std::make_unique<ProfileRing>(id, name));
+    return rings.back().get();
+}
+
+void Profiler::set_thread_name(const char* name)
+{
+    ProfileRing &ring = thread_ring();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    ring.thread_name = name;
+}
+
+bool Profiler::dump_chrome_trace(const char* path, uint32_t last_frames)
+{
+    std::ofstream out(path);
+    if (!out.is_open())
+    {
+        std::cout << "Profiler: no se pudo abrir " << path << std::endl;
+        return false;
+    }
+
+    uint32_t current = frame();
+    uint32_t min_frame = (last_frames > 0 && current > last_frames) ? current - last_frames : 0;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    std::vector<ProfileEvent> events;
+    bool first = true;
+    size_t written = 0;
+
+    out << "{\"traceEvents\":[\n";
+    for (auto &ring : rings)
+    {
+        // Metadato con el nombre del hilo.
+        if (!first) out << ",\n";
+        first = false;
+        out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring->thread_id << ",\"args\":{\"name\":";
+        write_json_string(out, ring->thread_name.c_str());
+        out << "}}";
+
+        events.clear();
+        ring->snapshot(events);
+        for (const ProfileEvent &e : events)
+        {
+            if (e.frame < min_frame)
+                continue;
+            uint64_t start = e.start_ns > epoch_ns ? e.start_ns - epoch_ns : 0;
+            uint64_t dur = e.end_ns > e.start_ns ? e.end_ns - e.start_ns : 0;
+
+            out << ",\n{\"name\":";
+            write_json_string(out, e.name);
+            out << ",\"cat\":\"mygl\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring->thread_id << ",\"ts\":";
+            write_micros(out, start);
+            out << ",\"dur\":";
+            write_micros(out, dur);
+            out << ",\"args\":{\"frame\":" << e.frame;
+            if (e.detail[0] != '\0')
+            {
+                out << ",\"detail\":";
+                write_json_string(out, e.detail);
+            }
+            out << "}}";
+            written++;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    std::cout << "Profiler: " << written << " zonas escritas en " << path << std::endl;
+    return true;
+}
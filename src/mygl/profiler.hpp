@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic> // Contadores atmicos para el buffer circular sin bloqueos.
+#include <chrono> // Reloj de alta resolucin (nanosegundos).
+#include <cstdint>
+#include <memory>
+#include <mutex> // Solo se usa al registrar un hilo nuevo, nunca al grabar zonas.
+#include <string>
+#include <vector>
+
+// Evento de perfilado: una zona con su inicio y fin en nanosegundos.
+// 'name' debe apuntar a una cadena esttica (literal), nunca a memoria temporal.
+struct ProfileEvent {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    uint32_t depth; // Profundidad de anidamiento dentro del hilo.
+    uint32_t frame; // Frame en el que se cerr la zona.
+    char detail[48]; // Texto opcional (por ejemplo, la ruta del recurso cargado).
+};
+
+// Buffer circular de eventos de un nico hilo.
+// Solo el hilo dueo escribe; el volcado lee una copia sin bloquear al escritor
+// y descarta los eventos que pudieron sobrescribirse mientras copiaba.
+class ProfileRing {
+    public:
+        static const uint32_t capacity = 1 << 15; // Debe ser potencia de dos.
+
+        ProfileRing(uint32_t thread_id, const std::string &thread_name) : thread_id(thread_id), thread_name(thread_name)
+        {
+            events.resize(capacity);
+        }
+
+        // Agrega un evento al buffer. Llamado solo desde el hilo dueo.
+        void push(const ProfileEvent &event)
+        {
+            uint64_t h = head.load(std::memory_order_relaxed);
+            events[h & (capacity - 1)] = event;
+            head.store(h + 1, std::memory_order_release);
+        }
+
+        // Copia los eventos vigentes al vector de salida.
+        void snapshot(std::vector<ProfileEvent> &out) const
+        {
+            uint64_t end = head.load(std::memory_order_acquire);
+            uint64_t begin = end > capacity ? end - capacity : 0;
+            size_t first = out.size();
+            for (uint64_t i = begin; i < end; i++)
+                out.push_back(events[i & (capacity - 1)]);
+
+            // Si el escritor avanz durante la copia, los primeros eventos copiados ya no son vlidos. Tambin el
+            // de la casilla que puede estar escribiendo en este momento (el evento 'after'), que pisa al 'after - capacity'.
+            uint64_t after = head.load(std::memory_order_acquire);
+            uint64_t overwritten = after + 1 > capacity ? after + 1 - capacity : 0;
+            if (overwritten > begin)
+            {
+                size_t drop = (size_t)std::min<uint64_t>(overwritten - begin, end - begin);
+                out.erase(out.begin() + first, out.begin() + first + drop);
+            }
+        }
+
+        uint32_t thread_id; // Identificador corto del hilo para la traza.
+        std::string thread_name; // Nombre legible del hilo.
+        uint32_t depth = 0; // Profundidad actual de zonas abiertas.
+
+    private:
+        std::vector<ProfileEvent> events;
+        std::atomic<uint64_t> head{0};
+};
+
+// Profiler gestiona los buffers de todos los hilos y exporta la traza en formato Chrome (trace_event).
+class Profiler {
+    public:
+        // Instancia global del profiler.
+        static Profiler& get();
+
+        // Tiempo actual en nanosegundos segn el reloj monotnico.
+        static uint64_t now_ns()
+        {
+            return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // Devuelve el buffer del hilo actual, registrndolo la primera vez.
+        ProfileRing& thread_ring()
+        {
+            thread_local ProfileRing* ring = nullptr;
+            if (ring == nullptr)
+                ring = register_thread();
+            return *ring;
+        }
+
+        // Asigna un nombre legible al hilo actual (aparece en chrome://tracing).
+        void set_thread_name(const char* name);
+
+        // Marca el inicio de un nuevo frame.
+        void begin_frame() { frame_number.fetch_add(1, std::memory_order_relaxed); }
+
+        // Nmero del frame actual.
+        uint32_t frame() const { return frame_number.load(std::memory_order_relaxed); }
+
+        // Escribe los eventos de todos los hilos como JSON de Chrome trace_event.
+        // Si 'last_frames' es mayor que cero solo se exportan los ltimos N frames.
+        bool dump_chrome_trace(const char* path, uint32_t last_frames = 0);
+
+    private:
+        Profiler() : epoch_ns(now_ns()) {}
+        ProfileRing* register_thread();
+
+        std::mutex registry_mutex; // Protege 'rings' al registrar hilos nuevos y al volcar.
+        std::vector<std::unique_ptr<ProfileRing>> rings;
+        std::atomic<uint32_t> frame_number{0};
+        uint64_t epoch_ns; // Referencia para que las marcas de tiempo empiecen cerca de cero.
+};
+
+// Zona RAII: mide el tiempo entre su construccin y su destruccin.
+class ProfileZone {
+    public:
+        ProfileZone(const char* name, const char* detail = nullptr) : ring(Profiler::get().thread_ring())
+        {
+            event.name = name;
+            event.detail[0] = '\0';
+            if (detail != nullptr)
+            {
+                size_t i = 0;
+                for (; detail[i] != '\0' && i < sizeof(event.detail) - 1; i++)
+                    event.detail[i] = detail[i];
+                event.detail[i] = '\0';
+            }
+            event.depth = ring.depth++;
+            event.start_ns = Profiler::now_ns();
+        }
+
+        ~ProfileZone()
+        {
+            event.end_ns = Profiler::now_ns();
+            event.frame = Profiler::get().frame();
+            ring.depth--;
+            ring.push(event);
+        }
+
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        ProfileRing& ring;
+        ProfileEvent event;
+};
+
+// Macros de instrumentacin. Definir MYGL_DISABLE_PROFILER elimina todo el costo.
+#ifndef MYGL_DISABLE_PROFILER
+    #define PROFILE_CONCAT_INNER(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+    #define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+    #define PROFILE_ZONE_TEXT(name, text) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name, text)
+    #define PROFILE_FRAME() Profiler::get().begin_frame()
+    #define PROFILE_THREAD(name) Profiler::get().set_thread_name(name)
+#else
+    #define PROFILE_ZONE(name)
+    #define PROFILE_ZONE_TEXT(name, text)
+    #define PROFILE_FRAME()
+    #define PROFILE_THREAD(name)
+#endif
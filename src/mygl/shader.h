@@ -11,6 +11,8 @@
 #include <iostream>
 #include <filesystem>
 
+#include "profiler.hpp"
+
 namespace fs = std::filesystem;
 
 // La clase Shader se encarga de la creacin y manejo de shaders en OpenGL.
@@ -22,6 +24,7 @@ public:
     // Constructor que carga y compila los shaders desde archivos.
     Shader(const char* vertexPath, const char* fragmentPath)
     {
+        PROFILE_ZONE_TEXT("Shader::Shader", fragmentPath);
         // Construccin de las rutas completas a los archivos de shader.
         fs::path p = fs::current_path() / "shaders";
         fs::path vs = p / vertexPath;
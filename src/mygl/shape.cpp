@@ -1,6 +1,7 @@
 #include "shape.hpp"
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
+#include "profiler.hpp"
 
 // Implementacin de la clase Cube.
 
@@ -49,10 +50,11 @@ void Cube::render(Shader shader, const ICamera& camera)
     }
 
     // Configuracin de las matrices de transformacin y la matriz normal para el shader.
-    glm::mat4 model = transform.get_model_matrix();
+    glm::mat4 model;
+    glm::mat3 normal;
+    transform.matrices(model, normal);
     glm::mat4 projection = camera.get_projection_matrix();
     glm::mat4 view = camera.get_view_matrix();
-    glm::mat3 normal = glm::transpose(glm::inverse(model));
 
     shader.set_mat4("model", model);
     shader.set_mat4("projection", projection);
@@ -67,6 +69,7 @@ void Cube::render(Shader shader, const ICamera& camera)
 // Mtodo add_texture: carga una textura desde un archivo y la asocia a un ID de textura.
 void Cube::add_texture(const char* file, unsigned int& texture)
 {
+    PROFILE_ZONE_TEXT("Cube::add_texture", file);
     glGenTextures(1, &texture); // Generacin del ID de textura.
 
     int width, height, nrComponents;
@@ -0,0 +1,56 @@
+#include "texture_image.hpp"
+#include "job_system.hpp"
+#include "profiler.hpp"
+#include <stb_image.h>
+
+bool decode_image(const std::string &file, bool flip, TextureImage &image)
+{
+    PROFILE_ZONE_TEXT("decode_image", file.c_str());
+
+    // Los trabajadores no deben depender del ajuste global, que el hilo principal puede cambiar en cualquier momento.
+    if (JobSystem::is_worker_thread())
+        stbi_set_flip_vertically_on_load_thread(flip);
+    else
+        stbi_set_flip_vertically_on_load(flip);
+
+    image.path = file;
+    image.data = stbi_load(file.c_str(), &image.width, &image.height, &image.components, 0);
+    return image.data != nullptr;
+}
+
+void free_image(TextureImage &image)
+{
+    if (image.data != nullptr)
+        stbi_image_free(image.data);
+    image.data = nullptr;
+}
+
+GLenum image_format(int components)
+{
+    if (components == 1)
+        return GL_RED;
+    if (components == 4)
+        return GL_RGBA;
+    return GL_RGB;
+}
+
+GLenum image_internal_format(int components)
+{
+    if (components == 1)
+        return GL_R8;
+    if (components == 4)
+        return GL_RGBA8;
+    return GL_RGB8;
+}
+
+int mip_levels(int width, int height)
+{
+    int levels = 1;
+    int size = width > height ? width : height;
+    while (size > 1)
+    {
+        size /= 2;
+        levels++;
+    }
+    return levels;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <string>
+
+// Imagen decodificada en memoria de CPU, lista para subirse a una textura OpenGL.
+// La decodificacin no toca OpenGL, por lo que puede hacerse en cualquier hilo.
+struct TextureImage {
+    std::string path; // Ruta del archivo de origen.
+    int width = 0;
+    int height = 0;
+    int components = 0; // Canales de color (1, 3 o 4).
+    unsigned char* data = nullptr; // Pxeles devueltos por stb_image; se liberan con free_image.
+};
+
+// Decodifica un archivo de imagen. 'flip' invierte la imagen verticalmente.
+// En un hilo trabajador el ajuste de inversin es local al hilo; en el hilo principal es el global de stb_image.
+bool decode_image(const std::string &file, bool flip, TextureImage &image);
+
+// Libera los pxeles de la imagen.
+void free_image(TextureImage &image);
+
+// Formato OpenGL que corresponde a la cantidad de canales de la imagen.
+GLenum image_format(int components);
+
+// Formato interno con tamao (para glTexStorage2D) que corresponde a la cantidad de canales.
+GLenum image_internal_format(int components);
+
+// Cantidad de niveles de mipmap de una textura completa de ese tamao.
+int mip_levels(int width, int height);
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
@@ -9,6 +10,10 @@ struct Transform {
     glm::vec3 rotation = {0, 0, 0};
     glm::vec3 scale = {1, 1, 1};
 
+    // Estado al inicio del ltimo paso de simulacin, usado para interpolar al renderizar.
+    glm::vec3 previous_position = {0, 0, 0};
+    glm::vec3 previous_rotation = {0, 0, 0};
+
     glm::mat4 get_model_matrix() {
         glm::mat4 mat = glm::mat4(1.0f);
         mat = glm::translate(mat, position);
@@ -19,5 +24,60 @@ struct Transform {
         return mat;
     }
 
+    // Matriz de modelo y matriz normal (inversa transpuesta de la parte 3x3), con atajos para los casos comunes:
+    // - solo giro en y con escala uniforme (paredes, estatuas, enemigo): se arman directamente, sin trigonometra
+    //   extra ni productos de matrices, y la normal es la rotacin dividida por la escala;
+    // - cualquier giro con escala uniforme: la normal es la parte 3x3 dividida por la escala al cuadrado.
+    // Solo la escala no uniforme paga la inversa general.
+    void matrices(glm::mat4 &model, glm::mat3 &normal) const {
+        bool uniform = scale.x == scale.y && scale.y == scale.z;
+        if (uniform && rotation.x == 0.0f && rotation.z == 0.0f)
+        {
+            yaw_matrices(position, rotation.y, scale.x, model, normal);
+            return;
+        }
+        model = Transform(*this).get_model_matrix();
+        if (uniform)
+            normal = glm::mat3(model) * (1.0f / (scale.x * scale.x));
+        else
+            normal = glm::transpose(glm::inverse(glm::mat3(model)));
+    }
+
+    // Matrices de una traslacin, un giro 'yaw' en y y una escala uniforme 's' (mismo resultado que get_model_matrix).
+    static void yaw_matrices(glm::vec3 position, float yaw, float s, glm::mat4 &model, glm::mat3 &normal) {
+        float c = std::cos(yaw);
+        float n = std::sin(yaw);
+        model[0] = glm::vec4(s * c, 0.0f, -s * n, 0.0f);
+        model[1] = glm::vec4(0.0f, s, 0.0f, 0.0f);
+        model[2] = glm::vec4(s * n, 0.0f, s * c, 0.0f);
+        model[3] = glm::vec4(position, 1.0f);
+        float inverse = 1.0f / s;
+        normal[0] = glm::vec3(c * inverse, 0.0f, -n * inverse);
+        normal[1] = glm::vec3(0.0f, inverse, 0.0f);
+        normal[2] = glm::vec3(n * inverse, 0.0f, c * inverse);
+    }
+
+    // Guarda el estado actual antes de avanzar un paso de simulacin.
+    void store_previous() {
+        previous_position = position;
+        previous_rotation = rotation;
+    }
+
+    // Descarta la interpolacin (tras un teletransporte o reinicio).
+    void snap() { store_previous(); }
+
+    // Devuelve la transformacin interpolada entre el paso anterior y el actual. Los giros van por el arco ms
+    // corto: de +pi a -pi se pasa por el medio paso que los separa, no por la vuelta entera.
+    Transform interpolated(float alpha) const {
+        Transform t = *this;
+        t.position = glm::mix(previous_position, position, alpha);
+        for (int k = 0; k < 3; k++)
+        {
+            float turn = std::remainder(rotation[k] - previous_rotation[k], 2.0f * glm::pi<float>());
+            t.rotation[k] = previous_rotation[k] + turn * alpha;
+        }
+        return t;
+    }
+
 };
 
@@ -0,0 +1,311 @@
+#pragma once
+
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "transform.hpp"
+#include "profiler.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_ARRAY_SSE
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif
+#if defined(TRANSFORM_ARRAY_SSE) && defined(__AVX2__)
+#define TRANSFORM_ARRAY_AVX2
+#include <immintrin.h>
+#endif
+
+// TransformArray guarda muchas transformaciones como arreglos separados por componente (posicin x, y, z,
+// giro, escala) y las matrices de modelo y normal ya calculadas de cada una. Los cambios marcan un bit de
+// "sucia"; update recalcula solo las marcadas, en lote:
+// - Las de giro solo en y y escala uniforme (casi todas: paredes, estatuas) se compactan en arreglos
+//   contiguos (giro, escala, posicin) y van por un ncleo SIMD: seno, coseno y columnas de 8 (AVX2) o 4 (SSE)
+//   transformaciones a la vez, sin productos de matrices ni inversas. Lo que sobra va por Transform::yaw_matrices.
+// - El resto usa Transform::matrices, que igual evita la inversa general si la escala es uniforme.
+// Las matrices solo son vlidas despus de update.
+class TransformArray {
+    public:
+        uint32_t add(const Transform &transform)
+        {
+            uint32_t i = (uint32_t)size();
+            px.push_back(0.0f); py.push_back(0.0f); pz.push_back(0.0f);
+            rx.push_back(0.0f); ry.push_back(0.0f); rz.push_back(0.0f);
+            sx.push_back(1.0f); sy.push_back(1.0f); sz.push_back(1.0f);
+            worlds.emplace_back(1.0f);
+            normals.emplace_back(1.0f);
+            if (dirty.size() * 64 < size())
+                dirty.push_back(0);
+            set(i, transform);
+            return i;
+        }
+
+        // Quita la transformacin 'i' moviendo la ltima a su lugar.
+        void remove_swap(uint32_t i)
+        {
+            uint32_t last = (uint32_t)size() - 1;
+            if (i != last)
+            {
+                px[i] = px[last]; py[i] = py[last]; pz[i] = pz[last];
+                rx[i] = rx[last]; ry[i] = ry[last]; rz[i] = rz[last];
+                sx[i] = sx[last]; sy[i] = sy[last]; sz[i] = sz[last];
+                worlds[i] = worlds[last];
+                normals[i] = normals[last];
+                if (is_dirty(last))
+                    mark(i);
+            }
+            unmark(last);
+            px.pop_back(); py.pop_back(); pz.pop_back();
+            rx.pop_back(); ry.pop_back(); rz.pop_back();
+            sx.pop_back(); sy.pop_back(); sz.pop_back();
+            worlds.pop_back();
+            normals.pop_back();
+        }
+
+        void clear()
+        {
+            px.clear(); py.clear(); pz.clear();
+            rx.clear(); ry.clear(); rz.clear();
+            sx.clear(); sy.clear(); sz.clear();
+            worlds.clear();
+            normals.clear();
+            dirty.clear();
+            yaw_batch.clear();
+            batch_yaw.clear(); batch_scale.clear();
+            batch_x.clear(); batch_y.clear(); batch_z.clear();
+        }
+
+        size_t size() const { return px.size(); }
+
+        Transform get(uint32_t i) const
+        {
+            Transform transform;
+            transform.position = position(i);
+            transform.rotation = rotation(i);
+            transform.scale = scale(i);
+            return transform;
+        }
+
+        void set(uint32_t i, const Transform &transform)
+        {
+            set_position(i, transform.position);
+            set_rotation(i, transform.rotation);
+            set_scale(i, transform.scale);
+        }
+
+        glm::vec3 position(uint32_t i) const { return { px[i], py[i], pz[i] }; }
+        glm::vec3 rotation(uint32_t i) const { return { rx[i], ry[i], rz[i] }; }
+        glm::vec3 scale(uint32_t i) const { return { sx[i], sy[i], sz[i] }; }
+
+        void set_position(uint32_t i, glm::vec3 p) { px[i] = p.x; py[i] = p.y; pz[i] = p.z; mark(i); }
+        void set_rotation(uint32_t i, glm::vec3 r) { rx[i] = r.x; ry[i] = r.y; rz[i] = r.z; mark(i); }
+        void set_scale(uint32_t i, glm::vec3 s) { sx[i] = s.x; sy[i] = s.y; sz[i] = s.z; mark(i); }
+
+        // Cambia solo el giro en y. No marca nada si no cambi.
+        void set_yaw(uint32_t i, float yaw)
+        {
+            if (ry[i] == yaw)
+                return;
+            ry[i] = yaw;
+            mark(i);
+        }
+
+        // Matrices calculadas en el ltimo update.
+        const glm::mat4& world(uint32_t i) const { return worlds[i]; }
+        const glm::mat3& normal(uint32_t i) const { return normals[i]; }
+
+        // Recalcula las matrices de las transformaciones marcadas y borra las marcas.
+        void update()
+        {
+            PROFILE_ZONE("TransformArray::update");
+            // Los arreglos del lote se dimensionan una vez para el peor caso y se llenan por ndice.
+            if (yaw_batch.size() < size())
+            {
+                yaw_batch.resize(size());
+                batch_yaw.resize(size());
+                batch_scale.resize(size());
+                batch_x.resize(size());
+                batch_y.resize(size());
+                batch_z.resize(size());
+            }
+            size_t n = 0;
+            for (size_t w = 0; w < dirty.size(); w++)
+            {
+                uint64_t bits = dirty[w];
+                dirty[w] = 0;
+                while (bits)
+                {
+                    uint32_t i = (uint32_t)(w * 64 + std::countr_zero(bits));
+                    bits &= bits - 1;
+                    if (rx[i] == 0.0f && rz[i] == 0.0f && sx[i] == sy[i] && sy[i] == sz[i])
+                    {
+                        yaw_batch[n] = i;
+                        batch_yaw[n] = ry[i];
+                        batch_scale[n] = sx[i];
+                        batch_x[n] = px[i];
+                        batch_y[n] = py[i];
+                        batch_z[n] = pz[i];
+                        n++;
+                    }
+                    else
+                        get(i).matrices(worlds[i], normals[i]);
+                }
+            }
+            update_yaw_batch(n);
+        }
+
+        // Cantidad de transformaciones pendientes de recalcular.
+        size_t dirty_count() const
+        {
+            size_t count = 0;
+            for (uint64_t bits : dirty)
+                count += std::popcount(bits);
+            return count;
+        }
+
+    private:
+        // Ncleo de giro en y con escala uniforme sobre las 'n' primeras entradas de los arreglos compactados en
+        // update. Las matrices de la entrada k se escriben en worlds[yaw_batch[k]] y normals[yaw_batch[k]]; la
+        // normal es la rotacin pura: (s c, s sn) / s^2 = (c, sn) / s.
+        void update_yaw_batch(size_t n)
+        {
+            size_t k = 0;
+#ifdef TRANSFORM_ARRAY_AVX2
+            for (; k + 8 <= n; k += 8)
+            {
+                __m256 sn, c;
+                sincos8(_mm256_loadu_ps(&batch_yaw[k]), sn, c);
+                write4(k, _mm256_castps256_ps128(sn), _mm256_castps256_ps128(c));
+                write4(k + 4, _mm256_extractf128_ps(sn, 1), _mm256_extractf128_ps(c, 1));
+            }
+#endif
+#ifdef TRANSFORM_ARRAY_SSE
+            for (; k + 4 <= n; k += 4)
+            {
+                __m128 sn, c;
+                sincos4(_mm_loadu_ps(&batch_yaw[k]), sn, c);
+                write4(k, sn, c);
+            }
+#endif
+            for (; k < n; k++)
+            {
+                uint32_t i = yaw_batch[k];
+                Transform::yaw_matrices(position(i), ry[i], sx[i], worlds[i], normals[i]);
+            }
+        }
+
+#ifdef TRANSFORM_ARRAY_SSE
+        // Escribe las matrices de las transformaciones k a k + 3 a partir de sus senos y cosenos. Cada columna se
+        // arma para las cuatro a la vez (un registro por componente) y se transpone: queda una columna por registro.
+        void write4(size_t k, __m128 sn, __m128 c)
+        {
+            __m128 zero = _mm_setzero_ps();
+            __m128 s = _mm_loadu_ps(&batch_scale[k]);
+            __m128 inv = _mm_div_ps(_mm_set1_ps(1.0f), s);
+            __m128 sc = _mm_mul_ps(s, c), ss = _mm_mul_ps(s, sn);
+            __m128 nc = _mm_mul_ps(c, inv), ns = _mm_mul_ps(sn, inv);
+
+            __m128 c0x = sc, c0y = zero, c0z = _mm_sub_ps(zero, ss), c0w = zero;
+            __m128 c1x = zero, c1y = s, c1z = zero, c1w = zero;
+            __m128 c2x = ss, c2y = zero, c2z = sc, c2w = zero;
+            __m128 c3x = _mm_loadu_ps(&batch_x[k]), c3y = _mm_loadu_ps(&batch_y[k]), c3z = _mm_loadu_ps(&batch_z[k]), c3w = _mm_set1_ps(1.0f);
+            _MM_TRANSPOSE4_PS(c0x, c0y, c0z, c0w);
+            _MM_TRANSPOSE4_PS(c1x, c1y, c1z, c1w);
+            _MM_TRANSPOSE4_PS(c2x, c2y, c2z, c2w);
+            _MM_TRANSPOSE4_PS(c3x, c3y, c3z, c3w);
+            // La normal (9 valores seguidos) va en dos registros, (nc, 0, -ns, 0) y (1/s, 0, ns, 0), ms nc al final.
+            __m128 n0x = nc, n0y = zero, n0z = _mm_sub_ps(zero, ns), n0w = zero;
+            __m128 n1x = inv, n1y = zero, n1z = ns, n1w = zero;
+            _MM_TRANSPOSE4_PS(n0x, n0y, n0z, n0w);
+            _MM_TRANSPOSE4_PS(n1x, n1y, n1z, n1w);
+
+            store(yaw_batch[k + 0], c0x, c1x, c2x, c3x, n0x, n1x);
+            store(yaw_batch[k + 1], c0y, c1y, c2y, c3y, n0y, n1y);
+            store(yaw_batch[k + 2], c0z, c1z, c2z, c3z, n0z, n1z);
+            store(yaw_batch[k + 3], c0w, c1w, c2w, c3w, n0w, n1w);
+        }
+
+        // Guarda las columnas de la matriz de modelo y los dos registros de la normal de la transformacin 'i'.
+        void store(uint32_t i, __m128 c0, __m128 c1, __m128 c2, __m128 c3, __m128 n0, __m128 n1)
+        {
+            float* m = &worlds[i][0][0];
+            _mm_storeu_ps(m + 0, c0);
+            _mm_storeu_ps(m + 4, c1);
+            _mm_storeu_ps(m + 8, c2);
+            _mm_storeu_ps(m + 12, c3);
+            float* q = &normals[i][0][0];
+            _mm_storeu_ps(q + 0, n0);
+            _mm_storeu_ps(q + 4, n1);
+            q[8] = _mm_cvtss_f32(n0);
+        }
+
+        // Seno y coseno de cuatro ngulos. El ngulo se lleva a r en [-pi/4, pi/4] restando q veces pi/2 (q
+        // redondeado, pi/2 en tres partes para no perder precisin) y se evalan los polinomios de Cephes. Los
+        // cuadrantes impares intercambian seno y coseno; el bit 1 de q da el signo del seno y el de q + 1 el del coseno.
+        static void sincos4(__m128 x, __m128 &sn, __m128 &c)
+        {
+            __m128i q = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(0.636619772f)));
+            __m128 qf = _mm_cvtepi32_ps(q);
+            __m128 r = _mm_sub_ps(x, _mm_mul_ps(qf, _mm_set1_ps(1.5703125f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(4.837512969970703125e-4f)));
+            r = _mm_sub_ps(r, _mm_mul_ps(qf, _mm_set1_ps(7.54978995489188216e-8f)));
+            __m128 z = _mm_mul_ps(r, r);
+
+            __m128 ps = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(-1.9515295891e-4f), z), _mm_set1_ps(8.3321608736e-3f));
+            ps = _mm_add_ps(_mm_mul_ps(ps, z), _mm_set1_ps(-1.6666654611e-1f));
+            ps = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(ps, z), r), r);
+            __m128 pc = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(2.443315711809948e-5f), z), _mm_set1_ps(-1.388731625493765e-3f));
+            pc = _mm_add_ps(_mm_mul_ps(pc, z), _mm_set1_ps(4.166664568298827e-2f));
+            pc = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(pc, z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.0f));
+
+            __m128i one = _mm_set1_epi32(1), two = _mm_set1_epi32(2);
+            __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+            __m128 sin_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30));
+            __m128 cos_sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, one), two), 30));
+            sn = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, pc), _mm_andnot_ps(swap, ps)), sin_sign);
+            c = _mm_xor_ps(_mm_or_ps(_mm_and_ps(swap, ps), _mm_andnot_ps(swap, pc)), cos_sign);
+        }
+#endif
+
+#ifdef TRANSFORM_ARRAY_AVX2
+        // Como sincos4, con ocho ngulos.
+        static void sincos8(__m256 x, __m256 &sn, __m256 &c)
+        {
+            __m256i q = _mm256_cvtps_epi32(_mm256_mul_ps(x, _mm256_set1_ps(0.636619772f)));
+            __m256 qf = _mm256_cvtepi32_ps(q);
+            __m256 r = _mm256_sub_ps(x, _mm256_mul_ps(qf, _mm256_set1_ps(1.5703125f)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(qf, _mm256_set1_ps(4.837512969970703125e-4f)));
+            r = _mm256_sub_ps(r, _mm256_mul_ps(qf, _mm256_set1_ps(7.54978995489188216e-8f)));
+            __m256 z = _mm256_mul_ps(r, r);
+
+            __m256 ps = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(-1.9515295891e-4f), z), _mm256_set1_ps(8.3321608736e-3f));
+            ps = _mm256_add_ps(_mm256_mul_ps(ps, z), _mm256_set1_ps(-1.6666654611e-1f));
+            ps = _mm256_add_ps(_mm256_mul_ps(_mm256_mul_ps(ps, z), r), r);
+            __m256 pc = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(2.443315711809948e-5f), z), _mm256_set1_ps(-1.388731625493765e-3f));
+            pc = _mm256_add_ps(_mm256_mul_ps(pc, z), _mm256_set1_ps(4.166664568298827e-2f));
+            pc = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(_mm256_mul_ps(pc, z), z), _mm256_mul_ps(_mm256_set1_ps(0.5f), z)), _mm256_set1_ps(1.0f));
+
+            __m256i one = _mm256_set1_epi32(1), two = _mm256_set1_epi32(2);
+            __m256 swap = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, one), one));
+            __m256 sin_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, two), 30));
+            __m256 cos_sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(_mm256_add_epi32(q, one), two), 30));
+            sn = _mm256_xor_ps(_mm256_blendv_ps(ps, pc, swap), sin_sign);
+            c = _mm256_xor_ps(_mm256_blendv_ps(pc, ps, swap), cos_sign);
+        }
+#endif
+
+        void mark(uint32_t i) { dirty[i >> 6] |= (uint64_t)1 << (i & 63); }
+        void unmark(uint32_t i) { dirty[i >> 6] &= ~((uint64_t)1 << (i & 63)); }
+        bool is_dirty(uint32_t i) const { return (dirty[i >> 6] >> (i & 63)) & 1; }
+
+        std::vector<float> px, py, pz; // Posicin.
+        std::vector<float> rx, ry, rz; // Giro en radianes (x, y, z, aplicado en ese orden como Transform).
+        std::vector<float> sx, sy, sz; // Escala.
+        std::vector<glm::mat4> worlds; // Matriz de modelo.
+        std::vector<glm::mat3> normals; // Matriz normal.
+        std::vector<uint64_t> dirty; // Un bit por transformacin pendiente de recalcular.
+        std::vector<uint32_t> yaw_batch; // Marcadas que van por el ncleo de giro en y, en el update en curso.
+        std::vector<float> batch_yaw, batch_scale, batch_x, batch_y, batch_z; // Sus datos, contiguos, en el mismo orden.
+};
@@ -0,0 +1,286 @@
+#include "upload_queue.hpp"
+#include "texture_image.hpp"
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+// Tiempo mximo de cada espera bloqueante sobre una cerca (nanosegundos).
+static const GLuint64 fence_wait_timeout = 1000000000;
+
+// Redondea hacia arriba a mltiplos de 16 bytes para que cada copia empiece alineada en el staging.
+static size_t align_up(size_t value)
+{
+    return (value + 15) & ~(size_t)15;
+}
+
+UploadQueue& UploadQueue::get()
+{
+    static UploadQueue queue;
+    return queue;
+}
+
+void UploadQueue::init(size_t frame_budget, int frames)
+{
+    if (mapped != nullptr)
+        return;
+    if (!GLAD_GL_VERSION_4_4)
+    {
+        std::cout << "UploadQueue: OpenGL 4.4 no disponible, las subidas sern sncronas" << std::endl;
+        return;
+    }
+    if (frames < 1) frames = 1;
+
+    region_size = align_up(frame_budget);
+    size_t total = region_size * frames;
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &staging);
+    glBindBuffer(GL_COPY_READ_BUFFER, staging);
+    glBufferStorage(GL_COPY_READ_BUFFER, total, nullptr, flags);
+    mapped = (unsigned char*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, total, flags);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+    if (mapped == nullptr)
+    {
+        std::cout << "UploadQueue: no se pudo mapear el buffer de staging" << std::endl;
+        glDeleteBuffers(1, &staging);
+        staging = 0;
+        region_size = 0;
+        return;
+    }
+    regions.assign(frames, StagingRegion());
+    current_region = 0;
+}
+
+void UploadQueue::shutdown()
+{
+    for (UploadRequest &request : requests)
+    {
+        if (request.on_copied)
+            request.on_copied();
+    }
+    requests.clear();
+    queued_bytes = 0;
+
+    for (StagingRegion &region : regions)
+    {
+        if (region.fence != nullptr)
+            glDeleteSync(region.fence);
+    }
+    regions.clear();
+
+    if (staging != 0)
+    {
+        glBindBuffer(GL_COPY_READ_BUFFER, staging);
+        glUnmapBuffer(GL_COPY_READ_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glDeleteBuffers(1, &staging);
+    }
+    staging = 0;
+    mapped = nullptr;
+    region_size = 0;
+}
+
+UploadHandle UploadQueue::upload_buffer(GLuint buffer, size_t offset, const void* data, size_t size, std::function<void()> on_copied)
+{
+    UploadRequest request;
+    request.kind = UploadKind::Buffer;
+    request.target = buffer;
+    request.data = (const unsigned char*)data;
+    request.size = size;
+    request.dst_offset = offset;
+    request.on_copied = std::move(on_copied);
+    request.status = std::make_shared<UploadStatus>();
+
+    UploadHandle status = request.status;
+    queued_bytes += size;
+    if (mapped == nullptr)
+        upload_direct(request);
+    else
+        requests.push_back(std::move(request));
+    return status;
+}
+
+UploadHandle UploadQueue::upload_texture(GLuint texture, int width, int height, int components, const unsigned char* data, bool mipmaps, std::function<void()> on_copied)
+{
+    UploadRequest request;
+    request.kind = UploadKind::Texture;
+    request.target = texture;
+    request.data = data;
+    request.size = (size_t)width * height * components;
+    request.dst_offset = 0;
+    request.width = width;
+    request.height = height;
+    request.components = components;
+    request.mipmaps = mipmaps;
+    request.on_copied = std::move(on_copied);
+    request.status = std::make_shared<UploadStatus>();
+
+    UploadHandle status = request.status;
+    queued_bytes += request.size;
+    // Sin staging, o si una sola fila no entra en el presupuesto, la textura se sube directamente.
+    if (mapped == nullptr || (size_t)width * components > region_size)
+        upload_direct(request);
+    else
+        requests.push_back(std::move(request));
+    return status;
+}
+
+bool UploadQueue::copy_chunk(UploadRequest &request, size_t region_offset, size_t &used)
+{
+    size_t available = region_size - used;
+    size_t staging_offset = region_offset + used;
+
+    if (request.kind == UploadKind::Buffer)
+    {
+        size_t bytes = std::min(request.size - request.done, available);
+        if (bytes > 0)
+        {
+            std::memcpy(mapped + staging_offset, request.data + request.done, bytes);
+            glBindBuffer(GL_COPY_READ_BUFFER, staging);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, request.target);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, staging_offset, request.dst_offset + request.done, bytes);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            request.done += bytes;
+            used = std::min(region_size, used + align_up(bytes));
+        }
+        return request.done == request.size;
+    }
+
+    // Las texturas se copian por bloques de filas completas.
+    size_t row_bytes = (size_t)request.width * request.components;
+    size_t rows = std::min((size_t)request.height - request.done, available / row_bytes);
+    if (rows > 0)
+    {
+        GLenum format = image_format(request.components);
+        std::memcpy(mapped + staging_offset, request.data + request.done * row_bytes, rows * row_bytes);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, request.target);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (GLint)request.done, request.width, (GLsizei)rows, format, GL_UNSIGNED_BYTE, (void*)staging_offset);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        request.done += rows;
+        used = std::min(region_size, used + align_up(rows * row_bytes));
+
+        if (request.done == (size_t)request.height && request.mipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D);
+    }
+    return request.done == (size_t)request.height;
+}
+
+void UploadQueue::upload_direct(UploadRequest &request)
+{
+    if (request.kind == UploadKind::Buffer)
+    {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, request.target);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, request.dst_offset, request.size, request.data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+    else
+    {
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glBindTexture(GL_TEXTURE_2D, request.target);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, request.width, request.height, image_format(request.components), GL_UNSIGNED_BYTE, request.data);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (request.mipmaps)
+            glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    request.status->copied = true;
+    request.status->ready = true;
+    if (request.on_copied)
+        request.on_copied();
+    queued_bytes -= request.size;
+}
+
+void UploadQueue::finish_copy(UploadRequest &request, StagingRegion &region)
+{
+    request.status->copied = true;
+    if (request.on_copied)
+        request.on_copied();
+    queued_bytes -= request.size;
+    region.completing.push_back(request.status);
+}
+
+bool UploadQueue::retire(StagingRegion &region, GLuint64 timeout)
+{
+    if (region.fence == nullptr)
+        return true;
+
+    GLenum result = glClientWaitSync(region.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+    if (result == GL_TIMEOUT_EXPIRED)
+        return false;
+    if (result == GL_WAIT_FAILED)
+        std::cout << "UploadQueue: fallo al esperar la cerca de staging" << std::endl;
+
+    glDeleteSync(region.fence);
+    region.fence = nullptr;
+    for (UploadHandle &status : region.completing)
+        status->ready = true;
+    region.completing.clear();
+    return true;
+}
+
+void UploadQueue::process()
+{
+    if (mapped == nullptr || idle())
+        return;
+    PROFILE_ZONE("UploadQueue::process");
+
+    for (StagingRegion &region : regions)
+        retire(region, 0);
+
+    // Si la GPU todava lee la regin que toca, se espera al prximo frame en lugar de bloquear.
+    StagingRegion &region = regions[current_region];
+    if (region.fence != nullptr)
+        return;
+
+    size_t region_offset = region_size * current_region;
+    size_t used = 0;
+    bool wrote = false;
+    while (!requests.empty())
+    {
+        UploadRequest &request = requests.front();
+        size_t before = used;
+        bool complete = copy_chunk(request, region_offset, used);
+        wrote = wrote || used != before;
+        if (!complete)
+            break;
+        finish_copy(request, region);
+        requests.pop_front();
+    }
+
+    if (wrote || !region.completing.empty())
+    {
+        region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        current_region = (current_region + 1) % (int)regions.size();
+    }
+}
+
+void UploadQueue::flush()
+{
+    PROFILE_ZONE("UploadQueue::flush");
+    while (!requests.empty())
+    {
+        while (!retire(regions[current_region], fence_wait_timeout)) {}
+        process();
+    }
+    for (StagingRegion &region : regions)
+        while (!retire(region, fence_wait_timeout)) {}
+}
+
+bool UploadQueue::idle() const
+{
+    if (!requests.empty())
+        return false;
+    for (const StagingRegion &region : regions)
+    {
+        if (region.fence != nullptr)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// Estado de una subida encolada. 'copied' indica que los datos de origen ya se copiaron al
+// buffer de staging (la memoria de origen puede liberarse) y 'ready' que la GPU termin la copia.
+struct UploadStatus {
+    bool copied = false;
+    bool ready = false;
+};
+
+using UploadHandle = std::shared_ptr<UploadStatus>;
+
+// UploadQueue transfiere datos de vrtices y texturas a la GPU sin bloquear el frame.
+// Usa un buffer de staging mapeado de forma persistente (glBufferStorage con GL_MAP_PERSISTENT_BIT)
+// dividido en 'frames' regiones. En cada frame process() copia en la regin actual hasta
+// 'frame_budget' bytes, emite las copias en la GPU y coloca una cerca (glFenceSync). Una regin
+// solo se reutiliza cuando su cerca se sealiza; ah tambin se marcan como listos los recursos.
+// Las subidas ms grandes que el presupuesto se reparten en varios frames.
+// Todos los mtodos deben llamarse desde el hilo principal (el del contexto OpenGL).
+class UploadQueue {
+    public:
+        // Instancia global.
+        static UploadQueue& get();
+
+        // Crea y mapea el buffer de staging. Requiere un contexto OpenGL 4.4 o superior; si no est
+        // disponible, o si no se llama a init, las subidas se hacen de forma sncrona.
+        void init(size_t frame_budget = 4 << 20, int frames = 3);
+
+        // Libera el buffer de staging y las cercas. Debe llamarse antes de destruir el contexto OpenGL.
+        // Las subidas pendientes se descartan (se llama a su 'on_copied' para liberar el origen).
+        void shutdown();
+
+        // Encola la copia de 'size' bytes de 'data' en 'buffer' a partir de 'offset'. 'buffer' debe tener
+        // ya su almacenamiento reservado. 'data' debe seguir siendo vlido hasta que el estado indique 'copied';
+        // 'on_copied' se llama en ese momento.
+        UploadHandle upload_buffer(GLuint buffer, size_t offset, const void* data, size_t size, std::function<void()> on_copied = nullptr);
+
+        // Encola la copia del nivel 0 de una textura 2D con almacenamiento ya reservado (glTexStorage2D).
+        // Las filas de 'data' estn empaquetadas sin relleno. Si 'mipmaps' es verdadero, los niveles
+        // restantes se generan al terminar la copia.
+        UploadHandle upload_texture(GLuint texture, int width, int height, int components, const unsigned char* data, bool mipmaps, std::function<void()> on_copied = nullptr);
+
+        // Avanza la cola un frame: retira las regiones cuya cerca ya se sealiz y copia nuevos datos
+        // en la regin actual sin superar el presupuesto. Nunca bloquea.
+        void process();
+
+        // Procesa toda la cola y espera a que la GPU termine (por ejemplo, antes de cerrar).
+        void flush();
+
+        // Verdadero si no hay subidas en cola ni copias esperando a la GPU.
+        bool idle() const;
+
+        // Bytes de las subidas en cola que an no terminaron de copiarse al staging.
+        size_t pending_bytes() const { return queued_bytes; }
+
+        // Bytes mximos que se copian por frame.
+        size_t frame_budget() const { return region_size; }
+
+    private:
+        enum class UploadKind { Buffer, Texture };
+
+        struct UploadRequest {
+            UploadKind kind;
+            GLuint target; // Buffer o textura destino.
+            const unsigned char* data;
+            size_t size; // Bytes totales.
+            size_t dst_offset; // Desplazamiento en el buffer destino.
+            size_t done = 0; // Bytes (buffer) o filas (textura) ya copiados.
+            int width = 0, height = 0, components = 0;
+            bool mipmaps = false;
+            std::function<void()> on_copied;
+            UploadHandle status;
+        };
+
+        // Cada regin del staging recuerda la cerca de su ltimo uso y los recursos que complet.
+        struct StagingRegion {
+            GLsync fence = nullptr;
+            std::vector<UploadHandle> completing;
+        };
+
+        UploadQueue() = default;
+
+        bool copy_chunk(UploadRequest &request, size_t region_offset, size_t &used);
+        void upload_direct(UploadRequest &request);
+        void finish_copy(UploadRequest &request, StagingRegion &region);
+        bool retire(StagingRegion &region, GLuint64 timeout);
+
+        GLuint staging = 0;
+        unsigned char* mapped = nullptr; // Puntero persistente al staging.
+        size_t region_size = 0;
+        std::vector<StagingRegion> regions;
+        int current_region = 0;
+
+        std::deque<UploadRequest> requests;
+        size_t queued_bytes = 0;
+};
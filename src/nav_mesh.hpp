@@ -0,0 +1,505 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mygl/profiler.hpp"
+
+// Polgono de la malla de navegacin: un rectngulo de celdas en el plano xz (convexo por construccin), con la
+// altura del suelo en sus cuatro esquinas. Los pasos a sus vecinos estn en NavMesh, a partir de 'first_link'.
+struct NavPoly {
+    int x0 = 0, z0 = 0, x1 = 0, z1 = 0; // Celdas que cubre: [x0, x1)  [z0, z1).
+    glm::vec2 min = glm::vec2(0.0f), max = glm::vec2(0.0f); // Lmites en el mundo, en (x, z).
+    float corner_y[4] = {}; // Altura en (min.x, min.z), (max.x, min.z), (max.x, max.z) y (min.x, max.z).
+    int first_link = 0;
+    int link_count = 0;
+};
+
+// Paso de un polgono a un vecino: el tramo compartido de uno de sus lados.
+struct NavLink {
+    int poly; // Polgono del otro lado.
+    int side; // Lado del polgono: 0 -x, 1 +x, 2 -z, 3 +z.
+    float from, to; // Tramo a lo largo del lado (en z para los lados x, en x para los lados z).
+};
+
+// Piso transitable de una columna de celdas y el polgono que lo cubre.
+struct NavCell {
+    float floor;
+    float ceiling; // Techo libre sobre el piso (infinito si no hay nada encima).
+    int poly;
+};
+
+// Parmetros comunes de la malla: la grilla de celdas sobre la que se construy y las medidas del agente.
+struct NavMeshParams {
+    glm::vec3 origin = glm::vec3(0.0f); // Esquina mnima de la celda (0, 0).
+    float cell_size = 0.1f;
+    int width = 0, depth = 0; // Celdas en x y en z.
+    float climb = 0.2f; // Desnivel mximo entre celdas vecinas.
+    float height = 1.0f; // Altura libre mnima.
+};
+
+// NavMesh guarda la malla de navegacin de un nivel sin grilla de texto (la construye NavMeshBuilder) y responde
+// las consultas de los agentes: polgono ms cercano a un punto, ruta entre dos puntos (A* sobre los polgonos y
+// embudo sobre los pasos entre ellos, as la ruta es una lnea quebrada por las esquinas) y rayos sobre la malla.
+// Un ndice por columna de celdas lleva de un punto a sus polgonos sin recorrerlos todos.
+// Las bsquedas reutilizan sus arreglos, as que una NavMesh no se consulta desde varios hilos a la vez.
+class NavMesh {
+    public:
+        // Instala los polgonos y el ndice por columna ('column_start' tiene widthdepth + 1 entradas y 'cells' los
+        // pisos de cada columna, de abajo hacia arriba) y calcula los pasos entre polgonos vecinos.
+        void assign(const NavMeshParams &params, std::vector<NavPoly> polys, std::vector<int> column_start, std::vector<NavCell> cells)
+        {
+            PROFILE_ZONE("NavMesh::assign");
+            settings = params;
+            poly_list = std::move(polys);
+            columns = std::move(column_start);
+            column_cells = std::move(cells);
+            build_links();
+
+            area_sum.resize(poly_list.size());
+            float total = 0.0f;
+            for (size_t i = 0; i < poly_list.size(); i++)
+            {
+                glm::vec2 size = poly_list[i].max - poly_list[i].min;
+                total += size.x * size.y;
+                area_sum[i] = total;
+            }
+        }
+
+        void clear()
+        {
+            poly_list.clear();
+            links.clear();
+            columns.clear();
+            column_cells.clear();
+            area_sum.clear();
+        }
+
+        bool empty() const { return poly_list.empty(); }
+        int poly_count() const { return (int)poly_list.size(); }
+        int link_count() const { return (int)links.size(); }
+        const NavPoly& poly(int i) const { return poly_list[i]; }
+        const NavLink& link(int i) const { return links[i]; }
+        const NavMeshParams& params() const { return settings; }
+
+        // Altura del suelo del polgono en el punto (x, z), interpolando entre sus esquinas.
+        float height_at(int poly_id, glm::vec2 point) const
+        {
+            const NavPoly &p = poly_list[poly_id];
+            glm::vec2 t = (point - p.min) / glm::max(p.max - p.min, glm::vec2(1e-6f));
+            t = glm::clamp(t, glm::vec2(0.0f), glm::vec2(1.0f));
+            float near_z = glm::mix(p.corner_y[0], p.corner_y[1], t.x);
+            float far_z = glm::mix(p.corner_y[3], p.corner_y[2], t.x);
+            return glm::mix(near_z, far_z, t.y);
+        }
+
+        // Polgono ms cercano a 'point' dentro de 'search_radius' (en xz), o -1. Deja en 'nearest' el punto del
+        // polgono ms cercano. Las columnas se revisan en anillos alrededor del punto hasta que ninguna ms lejana
+        // pueda mejorar el resultado.
+        int find_nearest(glm::vec3 point, glm::vec3 &nearest, float search_radius = 2.0f) const
+        {
+            if (empty())
+                return -1;
+            float cs = settings.cell_size;
+            int cx = (int)std::floor((point.x - settings.origin.x) / cs);
+            int cz = (int)std::floor((point.z - settings.origin.z) / cs);
+            int rings = (int)std::ceil(search_radius / cs);
+            int best = -1;
+            float best_distance = std::numeric_limits<float>::max();
+            for (int ring = 0; ring <= rings; ring++)
+            {
+                float ring_distance = (ring - 1) * cs;
+                if (best >= 0 && ring_distance > 0.0f && ring_distance * ring_distance > best_distance)
+                    break;
+                for (int z = cz - ring; z <= cz + ring; z++)
+                {
+                    for (int x = cx - ring; x <= cx + ring; x++)
+                    {
+                        // Solo el borde del anillo: el interior ya se revis.
+                        if (std::max(std::abs(x - cx), std::abs(z - cz)) != ring)
+                            continue;
+                        if (x < 0 || z < 0 || x >= settings.width || z >= settings.depth)
+                            continue;
+                        glm::vec2 cell_min = glm::vec2(settings.origin.x + x * cs, settings.origin.z + z * cs);
+                        glm::vec2 closest = glm::clamp(glm::vec2(point.x, point.z), cell_min, cell_min + cs);
+                        glm::vec2 offset = closest - glm::vec2(point.x, point.z);
+                        int column = z * settings.width + x;
+                        for (int c = columns[column]; c < columns[column + 1]; c++)
+                        {
+                            float dy = point.y - column_cells[c].floor;
+                            float distance = glm::dot(offset, offset) + dy * dy;
+                            if (distance < best_distance)
+                            {
+                                best_distance = distance;
+                                best = column_cells[c].poly;
+                            }
+                        }
+                    }
+                }
+            }
+            if (best >= 0)
+                nearest = closest_point(best, point);
+            return best;
+        }
+
+        // Punto del polgono ms cercano a 'point' en xz, a la altura del suelo.
+        glm::vec3 closest_point(int poly_id, glm::vec3 point) const
+        {
+            const NavPoly &p = poly_list[poly_id];
+            glm::vec2 xz = glm::clamp(glm::vec2(point.x, point.z), p.min, p.max);
+            return { xz.x, height_at(poly_id, xz), xz.y };
+        }
+
+        // Ruta de 'start' a 'goal' sobre la malla. Como las rutas de la grilla, excluye el inicio e incluye la meta
+        // (llevada al polgono ms cercano); los puntos intermedios son las esquinas donde la ruta dobla.
+        // Devuelve la cantidad de puntos (0 si no hay ruta).
+        int find_path(glm::vec3 start, glm::vec3 goal, std::vector<glm::vec3> &path)
+        {
+            PROFILE_ZONE("NavMesh::find_path");
+            path.clear();
+            glm::vec3 from, to;
+            int start_poly = find_nearest(start, from);
+            int goal_poly = find_nearest(goal, to);
+            if (start_poly < 0 || goal_poly < 0)
+                return 0;
+            if (!search(start_poly, goal_poly, glm::vec2(from.x, from.z), glm::vec2(to.x, to.z)))
+                return 0;
+            funnel(from, to, path);
+            return (int)path.size();
+        }
+
+        // Avanza en lnea recta de 'start' hacia 'end' sobre la malla. Devuelve verdadero si llega; si no, deja en
+        // 'hit' el punto del borde de la malla donde el rayo sale de ella (si llega, 'hit' es 'end' sobre la malla).
+        bool raycast(glm::vec3 start, glm::vec3 end, glm::vec3 &hit) const
+        {
+            PROFILE_ZONE("NavMesh::raycast");
+            glm::vec3 from;
+            int current = find_nearest(start, from);
+            if (current < 0)
+            {
+                hit = start;
+                return false;
+            }
+            glm::vec2 origin = glm::vec2(from.x, from.z);
+            glm::vec2 delta = glm::vec2(end.x, end.z) - origin;
+            // Cada vuelta cruza un polgono: a lo sumo tantas como polgonos.
+            for (size_t guard = 0; guard <= poly_list.size(); guard++)
+            {
+                const NavPoly &p = poly_list[current];
+                // Fraccin del rayo en la que sale del rectngulo y por qu lado.
+                float t_exit = 1.0f;
+                int side = -1;
+                for (int axis = 0; axis < 2; axis++)
+                {
+                    if (std::abs(delta[axis]) < 1e-9f)
+                        continue;
+                    float bound = delta[axis] > 0.0f ? p.max[axis] : p.min[axis];
+                    float t = (bound - origin[axis]) / delta[axis];
+                    if (t < t_exit)
+                    {
+                        t_exit = t;
+                        side = axis * 2 + (delta[axis] > 0.0f ? 1 : 0);
+                    }
+                }
+                glm::vec2 exit = origin + delta * std::max(t_exit, 0.0f);
+                if (side < 0)
+                {
+                    hit = { exit.x, height_at(current, exit), exit.y };
+                    return true;
+                }
+                // El vecino que comparte el tramo del lado donde sale el rayo.
+                float along = side < 2 ? exit.y : exit.x;
+                int next = -1;
+                for (int l = p.first_link; l < p.first_link + p.link_count; l++)
+                {
+                    if (links[l].side == side && along >= links[l].from - 1e-5f && along <= links[l].to + 1e-5f)
+                    {
+                        next = links[l].poly;
+                        break;
+                    }
+                }
+                if (next < 0)
+                {
+                    hit = { exit.x, height_at(current, exit), exit.y };
+                    return false;
+                }
+                current = next;
+            }
+            hit = start;
+            return false;
+        }
+
+        // Punto al azar de la malla, uniforme por rea. Devuelve 'origin' si la malla est vaca.
+        template <typename Random>
+        glm::vec3 random_point(Random &random) const
+        {
+            if (empty())
+                return settings.origin;
+            float pick = std::uniform_real_distribution<float>(0.0f, area_sum.back())(random);
+            int poly_id = (int)(std::upper_bound(area_sum.begin(), area_sum.end(), pick) - area_sum.begin());
+            poly_id = std::min(poly_id, (int)poly_list.size() - 1);
+            const NavPoly &p = poly_list[poly_id];
+            std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+            glm::vec2 xz = glm::mix(p.min, p.max, glm::vec2(unit(random), unit(random)));
+            return { xz.x, height_at(poly_id, xz), xz.y };
+        }
+
+    private:
+        NavMeshParams settings;
+        std::vector<NavPoly> poly_list;
+        std::vector<NavLink> links;
+        std::vector<int> columns; // Primera entrada de cada columna en 'column_cells' (ms una entrada final).
+        std::vector<NavCell> column_cells;
+        std::vector<float> area_sum; // reas acumuladas de los polgonos, para elegir puntos al azar.
+
+        // Estado de la bsqueda, reutilizado entre consultas (un sello por bsqueda evita limpiarlo).
+        std::vector<float> cost;
+        std::vector<int> parent;
+        std::vector<glm::vec2> entry; // Punto por el que la bsqueda entra en cada polgono.
+        std::vector<uint32_t> stamps;
+        uint32_t generation = 0;
+        std::vector<std::pair<float, int>> open;
+        std::vector<int> corridor; // Polgonos de la ruta encontrada, del inicio a la meta.
+
+        // Dos polgonos son vecinos en cada celda de un lado cuyo piso conecta (desnivel y altura libre) con un piso
+        // de la columna de enfrente. Las celdas seguidas con el mismo vecino forman un solo paso.
+        void build_links()
+        {
+            links.clear();
+            float cs = settings.cell_size;
+            for (int poly_id = 0; poly_id < (int)poly_list.size(); poly_id++)
+            {
+                NavPoly &p = poly_list[poly_id];
+                p.first_link = (int)links.size();
+                for (int side = 0; side < 4; side++)
+                {
+                    bool along_z = side < 2; // Los lados -x y +x se recorren a lo largo de z.
+                    int length = along_z ? p.z1 - p.z0 : p.x1 - p.x0;
+                    int open_link = -1;
+                    for (int k = 0; k < length; k++)
+                    {
+                        int x = along_z ? (side == 0 ? p.x0 : p.x1 - 1) : p.x0 + k;
+                        int z = along_z ? p.z0 + k : (side == 2 ? p.z0 : p.z1 - 1);
+                        int nx = x + (side == 0 ? -1 : side == 1 ? 1 : 0);
+                        int nz = z + (side == 2 ? -1 : side == 3 ? 1 : 0);
+                        int neighbour = -1;
+                        const NavCell* own = cell_of(x, z, poly_id);
+                        if (own && nx >= 0 && nz >= 0 && nx < settings.width && nz < settings.depth)
+                        {
+                            int column = nz * settings.width + nx;
+                            for (int c = columns[column]; c < columns[column + 1]; c++)
+                            {
+                                const NavCell &other = column_cells[c];
+                                if (other.poly != poly_id && std::abs(other.floor - own->floor) <= settings.climb
+                                    && std::min(other.ceiling, own->ceiling) - std::max(other.floor, own->floor) >= settings.height)
+                                {
+                                    neighbour = other.poly;
+                                    break;
+                                }
+                            }
+                        }
+                        float origin = along_z ? settings.origin.z : settings.origin.x;
+                        int cell = along_z ? z : x;
+                        if (neighbour >= 0 && open_link >= 0 && links[open_link].poly == neighbour)
+                            links[open_link].to = origin + (cell + 1) * cs;
+                        else if (neighbour >= 0)
+                        {
+                            open_link = (int)links.size();
+                            links.push_back({ neighbour, side, origin + cell * cs, origin + (cell + 1) * cs });
+                        }
+                        else
+                            open_link = -1;
+                    }
+                }
+                p.link_count = (int)links.size() - p.first_link;
+            }
+        }
+
+        // Piso de la columna (x, z) que pertenece al polgono, o nulo.
+        const NavCell* cell_of(int x, int z, int poly_id) const
+        {
+            int column = z * settings.width + x;
+            for (int c = columns[column]; c < columns[column + 1]; c++)
+            {
+                if (column_cells[c].poly == poly_id)
+                    return &column_cells[c];
+            }
+            return nullptr;
+        }
+
+        // Extremos de un paso, en (x, z).
+        void portal(const NavPoly &p, const NavLink &l, glm::vec2 &a, glm::vec2 &b) const
+        {
+            if (l.side < 2)
+            {
+                float x = l.side == 0 ? p.min.x : p.max.x;
+                a = { x, l.from };
+                b = { x, l.to };
+            }
+            else
+            {
+                float z = l.side == 2 ? p.min.y : p.max.y;
+                a = { l.from, z };
+                b = { l.to, z };
+            }
+        }
+
+        // A* sobre los polgonos. El costo de entrar a un vecino es la distancia desde el punto por el que se entr
+        // al polgono actual hasta el punto ms cercano del paso. Deja la secuencia de polgonos en 'corridor'.
+        bool search(int start_poly, int goal_poly, glm::vec2 start, glm::vec2 goal)
+        {
+            size_t count = poly_list.size();
+            if (stamps.size() != count)
+            {
+                cost.assign(count, 0.0f);
+                parent.assign(count, -1);
+                entry.assign(count, glm::vec2(0.0f));
+                stamps.assign(count, 0);
+                generation = 0;
+            }
+            if (++generation == 0)
+            {
+                std::fill(stamps.begin(), stamps.end(), 0);
+                generation = 1;
+            }
+
+            auto by_cost = [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a.first > b.first; };
+            open.clear();
+            stamps[start_poly] = generation;
+            cost[start_poly] = 0.0f;
+            parent[start_poly] = -1;
+            entry[start_poly] = start;
+            open.push_back({ glm::distance(start, goal), start_poly });
+            bool found = false;
+            while (!open.empty())
+            {
+                std::pop_heap(open.begin(), open.end(), by_cost);
+                auto [estimate, current] = open.back();
+                open.pop_back();
+                if (estimate > cost[current] + glm::distance(entry[current], goal) + 1e-4f)
+                    continue; // Entrada vieja: el polgono se mejor despus de encolarla.
+                if (current == goal_poly)
+                {
+                    found = true;
+                    break;
+                }
+                const NavPoly &p = poly_list[current];
+                for (int l = p.first_link; l < p.first_link + p.link_count; l++)
+                {
+                    const NavLink &link = links[l];
+                    glm::vec2 a, b;
+                    portal(p, link, a, b);
+                    glm::vec2 point = glm::clamp(entry[current], glm::min(a, b), glm::max(a, b));
+                    float next_cost = cost[current] + glm::distance(entry[current], point);
+                    int next = link.poly;
+                    if (stamps[next] == generation && cost[next] <= next_cost)
+                        continue;
+                    stamps[next] = generation;
+                    cost[next] = next_cost;
+                    parent[next] = current;
+                    entry[next] = point;
+                    open.push_back({ next_cost + glm::distance(point, goal), next });
+                    std::push_heap(open.begin(), open.end(), by_cost);
+                }
+            }
+            if (!found)
+                return false;
+            corridor.clear();
+            for (int p = goal_poly; p >= 0; p = parent[p])
+                corridor.push_back(p);
+            std::reverse(corridor.begin(), corridor.end());
+            return true;
+        }
+
+        // Producto cruz en el plano (x, z): positivo si 'b' queda a la izquierda de 'a'.
+        static float cross(glm::vec2 a, glm::vec2 b) { return a.x * b.y - a.y * b.x; }
+
+        // Algoritmo del embudo sobre los pasos del corredor: la ruta ms corta dentro de l, con quiebres solo en
+        // los extremos de los pasos.
+        void funnel(glm::vec3 start, glm::vec3 goal, std::vector<glm::vec3> &path) const
+        {
+            // Extremos izquierdo y derecho de cada paso, vistos en el sentido de avance; el ltimo es la meta.
+            std::vector<glm::vec2> lefts, rights;
+            std::vector<int> owners; // Polgono desde el que se cruza cada paso, para la altura de los quiebres.
+            for (size_t i = 0; i + 1 < corridor.size(); i++)
+            {
+                const NavPoly &p = poly_list[corridor[i]];
+                for (int l = p.first_link; l < p.first_link + p.link_count; l++)
+                {
+                    if (links[l].poly != corridor[i + 1])
+                        continue;
+                    glm::vec2 a, b;
+                    portal(p, links[l], a, b);
+                    int side = links[l].side;
+                    glm::vec2 forward = side == 0 ? glm::vec2(-1, 0) : side == 1 ? glm::vec2(1, 0) : side == 2 ? glm::vec2(0, -1) : glm::vec2(0, 1);
+                    bool b_left = cross(forward, b - a) > 0.0f;
+                    lefts.push_back(b_left ? b : a);
+                    rights.push_back(b_left ? a : b);
+                    owners.push_back(corridor[i]);
+                    break;
+                }
+            }
+            glm::vec2 end = glm::vec2(goal.x, goal.z);
+            lefts.push_back(end);
+            rights.push_back(end);
+            owners.push_back(corridor.back());
+
+            glm::vec2 apex = glm::vec2(start.x, start.z), left = apex, right = apex;
+            int left_index = -1, right_index = -1;
+            for (int i = 0; i < (int)lefts.size(); i++)
+            {
+                // Estrecha el lado derecho si el nuevo extremo queda dentro del embudo.
+                if (cross(right - apex, rights[i] - apex) >= 0.0f)
+                {
+                    if (apex == right || cross(left - apex, rights[i] - apex) < 0.0f)
+                    {
+                        right = rights[i];
+                        right_index = i;
+                    }
+                    else
+                    {
+                        // Cruz el lado izquierdo: su extremo es un quiebre de la ruta y el nuevo vrtice del embudo.
+                        apex = left;
+                        add_corner(path, apex, owners[left_index]);
+                        i = left_index;
+                        left = right = apex;
+                        right_index = left_index;
+                        continue;
+                    }
+                }
+                if (cross(left - apex, lefts[i] - apex) <= 0.0f)
+                {
+                    if (apex == left || cross(right - apex, lefts[i] - apex) > 0.0f)
+                    {
+                        left = lefts[i];
+                        left_index = i;
+                    }
+                    else
+                    {
+                        apex = right;
+                        add_corner(path, apex, owners[right_index]);
+                        i = right_index;
+                        left = right = apex;
+                        left_index = right_index;
+                        continue;
+                    }
+                }
+            }
+            // La meta puede haber quedado ya como quiebre del embudo.
+            if (!path.empty() && glm::vec2(path.back().x, path.back().z) == end)
+                path.back() = goal;
+            else
+                path.push_back(goal);
+        }
+
+        void add_corner(std::vector<glm::vec3> &path, glm::vec2 corner, int poly_id) const
+        {
+            if (!path.empty() && glm::vec2(path.back().x, path.back().z) == corner)
+                return;
+            path.push_back({ corner.x, height_at(poly_id, corner), corner.y });
+        }
+};
@@ -0,0 +1,503 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+#include "nav_mesh.hpp"
+#include "mygl/job_system.hpp"
+#include "mygl/profiler.hpp"
+
+// Medidas de la construccin de una malla de navegacin. Las distancias estn en unidades del mundo.
+struct NavMeshConfig {
+    float cell_size = 0.1f; // Lado de las celdas en xz.
+    float cell_height = 0.05f; // Alto de las celdas en y.
+    float agent_height = 1.0f; // Altura libre que necesita el agente.
+    float agent_radius = 0.2f; // La malla queda a esta distancia de paredes y bordes.
+    float agent_climb = 0.2f; // Desnivel que el agente puede subir o bajar de una celda a otra.
+    float max_slope = glm::radians(45.0f); // Pendiente mxima de un tringulo transitable.
+    int tile_size = 32; // Celdas por lado de cada baldosa; las baldosas se construyen en paralelo.
+};
+
+// Tringulos de un nivel en coordenadas del mundo, la entrada de NavMeshBuilder. Se arma con los modelos del
+// nivel: add_model aplica la transformacin del modelo a los vrtices de sus mallas.
+struct NavMeshInput {
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> indices; // Tres por tringulo, en sentido antihorario visto desde arriba.
+
+    // Agrega tringulos indexados transformados por 'matrix'. Sirve para cualquier vrtice con miembro 'position'.
+    template <typename VertexType>
+    void add_triangles(const std::vector<VertexType> &mesh_vertices, const std::vector<unsigned int> &mesh_indices, const glm::mat4 &matrix)
+    {
+        uint32_t base = (uint32_t)vertices.size();
+        for (const VertexType &vertex : mesh_vertices)
+            vertices.push_back(glm::vec3(matrix * glm::vec4(vertex.position, 1.0f)));
+        for (unsigned int index : mesh_indices)
+            indices.push_back(base + index);
+    }
+
+    // Agrega todas las mallas de un modelo con su transformacin actual.
+    template <typename ModelType>
+    void add_model(ModelType &model)
+    {
+        glm::mat4 matrix = model.transform.get_model_matrix();
+        for (const auto &mesh : model.meshes)
+            add_triangles(mesh.vertices, mesh.indices, matrix);
+    }
+
+    void clear()
+    {
+        vertices.clear();
+        indices.clear();
+    }
+
+    size_t triangle_count() const { return indices.size() / 3; }
+};
+
+// NavMeshBuilder arma una NavMesh a partir de los tringulos de un nivel, en baldosas de 'tile_size' celdas que
+// se construyen en paralelo en el JobSystem. Cada baldosa, con un borde extra para no depender de sus vecinas:
+//   1. Voxeliza los tringulos que la tocan en columnas de tramos slidos (recortando cada tringulo por celda).
+//   2. Marca transitables los tramos con pendiente suave y altura libre suficiente encima; un escaln bajo sobre
+//      un tramo transitable tambin lo es.
+//   3. Une los pisos de columnas vecinas que el agente puede cruzar (desnivel y altura libre) y erosiona los
+//      pisos a menos de 'agent_radius' de un borde, con un campo de distancias de dos pasadas.
+//   4. Reparte los pisos en rectngulos de celdas conectadas (crecen en x y luego en z), que son los polgonos.
+// Al final se juntan los polgonos de todas las baldosas y NavMesh calcula los pasos entre vecinos, tambin entre
+// baldosas distintas.
+class NavMeshBuilder {
+    public:
+        // Construye 'mesh'. Devuelve falso si la entrada est vaca o no queda ningn piso transitable.
+        static bool build(const NavMeshInput &input, const NavMeshConfig &config, NavMesh &mesh)
+        {
+            PROFILE_ZONE("NavMeshBuilder::build");
+            mesh.clear();
+            if (input.triangle_count() == 0)
+                return false;
+
+            Context context(input, config);
+            std::vector<TileResult> results(context.tiles_x * context.tiles_z);
+            JobSystem::get().parallel_for(0, results.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t t = begin; t < end; t++)
+                    build_tile(context, (int)t % context.tiles_x, (int)t / context.tiles_x, results[t]);
+            });
+
+            // Junta los polgonos y arma el ndice por columna (conteo, prefijos y llenado).
+            std::vector<NavPoly> polys;
+            std::vector<int> column_start(context.params.width * context.params.depth + 1, 0);
+            for (TileResult &result : results)
+            {
+                for (const auto &[column, cell] : result.cells)
+                    column_start[column + 1]++;
+            }
+            for (size_t c = 1; c < column_start.size(); c++)
+                column_start[c] += column_start[c - 1];
+            std::vector<NavCell> cells(column_start.back());
+            std::vector<int> fill(column_start.begin(), column_start.end() - 1);
+            for (TileResult &result : results)
+            {
+                int offset = (int)polys.size();
+                polys.insert(polys.end(), result.polys.begin(), result.polys.end());
+                for (auto [column, cell] : result.cells)
+                {
+                    cell.poly += offset;
+                    cells[fill[column]++] = cell;
+                }
+            }
+            for (size_t c = 0; c + 1 < column_start.size(); c++)
+            {
+                std::sort(cells.begin() + column_start[c], cells.begin() + column_start[c + 1],
+                    [](const NavCell &a, const NavCell &b) { return a.floor < b.floor; });
+            }
+            if (polys.empty())
+                return false;
+            mesh.assign(context.params, std::move(polys), std::move(column_start), std::move(cells));
+            return true;
+        }
+
+    private:
+        // Datos comunes a todas las baldosas, de solo lectura durante la construccin.
+        struct Context {
+            const NavMeshInput &input;
+            NavMeshConfig config;
+            NavMeshParams params;
+            int tile_size, border, tiles_x, tiles_z;
+            int climb_cells, height_cells, radius_cells;
+            float walkable_normal_y;
+            std::vector<std::vector<int>> tile_triangles; // Tringulos que tocan cada baldosa (con su borde).
+
+            Context(const NavMeshInput &input, const NavMeshConfig &config) : input(input), config(config)
+            {
+                glm::vec3 low = input.vertices[input.indices[0]], high = low;
+                for (uint32_t index : input.indices)
+                {
+                    low = glm::min(low, input.vertices[index]);
+                    high = glm::max(high, input.vertices[index]);
+                }
+                params.origin = low;
+                params.cell_size = config.cell_size;
+                params.width = std::max(1, (int)std::ceil((high.x - low.x) / config.cell_size));
+                params.depth = std::max(1, (int)std::ceil((high.z - low.z) / config.cell_size));
+                params.climb = config.agent_climb;
+                params.height = config.agent_height;
+
+                tile_size = std::max(8, config.tile_size);
+                radius_cells = (int)std::ceil(config.agent_radius / config.cell_size);
+                border = radius_cells + 3;
+                tiles_x = (params.width + tile_size - 1) / tile_size;
+                tiles_z = (params.depth + tile_size - 1) / tile_size;
+                climb_cells = (int)std::floor(config.agent_climb / config.cell_height);
+                height_cells = (int)std::ceil(config.agent_height / config.cell_height);
+                walkable_normal_y = std::cos(config.max_slope);
+
+                // Reparte los tringulos en las baldosas que tocan sus lmites en xz, contando el borde.
+                tile_triangles.resize(tiles_x * tiles_z);
+                for (size_t t = 0; t + 2 < input.indices.size(); t += 3)
+                {
+                    glm::vec3 a = input.vertices[input.indices[t]], b = input.vertices[input.indices[t + 1]];
+                    glm::vec3 c = input.vertices[input.indices[t + 2]];
+                    glm::vec3 tri_low = glm::min(a, glm::min(b, c)), tri_high = glm::max(a, glm::max(b, c));
+                    int x0 = (int)std::floor((tri_low.x - low.x) / config.cell_size) - border;
+                    int x1 = (int)std::floor((tri_high.x - low.x) / config.cell_size) + border;
+                    int z0 = (int)std::floor((tri_low.z - low.z) / config.cell_size) - border;
+                    int z1 = (int)std::floor((tri_high.z - low.z) / config.cell_size) + border;
+                    int tx0 = std::max(0, floor_div(x0, tile_size)), tx1 = std::min(tiles_x - 1, floor_div(x1, tile_size));
+                    int tz0 = std::max(0, floor_div(z0, tile_size)), tz1 = std::min(tiles_z - 1, floor_div(z1, tile_size));
+                    for (int tz = tz0; tz <= tz1; tz++)
+                        for (int tx = tx0; tx <= tx1; tx++)
+                            tile_triangles[tz * tiles_x + tx].push_back((int)t);
+                }
+            }
+        };
+
+        // Tramo slido de una columna, en celdas de altura.
+        struct Span {
+            int min, max;
+            bool walkable;
+        };
+
+        // Piso transitable de una columna: el techo de un tramo y el espacio libre sobre l.
+        struct Floor {
+            int floor, ceiling;
+            int neighbour[4]; // Piso conectado en cada direccin (-x, +x, -z, +z), o -1.
+            int distance; // Distancia al borde, en medias celdas (2 por paso recto, 3 en diagonal).
+            int poly;
+            bool removed;
+        };
+
+        struct TileResult {
+            std::vector<NavPoly> polys;
+            std::vector<std::pair<int, NavCell>> cells; // Columna global y piso de cada celda de los polgonos.
+        };
+
+        static int floor_div(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+        // Corta el polgono 'in' con la recta 'axis' = 'line' (0: x, 2: z): lo que queda debajo va a 'below' y lo
+        // que queda encima a 'above'.
+        static void split(const std::vector<glm::vec3> &in, float line, int axis, std::vector<glm::vec3> &below, std::vector<glm::vec3> &above)
+        {
+            below.clear();
+            above.clear();
+            for (size_t i = 0, j = in.size() - 1; i < in.size(); j = i, i++)
+            {
+                float di = line - in[i][axis], dj = line - in[j][axis];
+                if ((di >= 0.0f) != (dj >= 0.0f))
+                {
+                    glm::vec3 cut = in[j] + (in[i] - in[j]) * (dj / (dj - di));
+                    below.push_back(cut);
+                    above.push_back(cut);
+                }
+                if (di > 0.0f)
+                    below.push_back(in[i]);
+                else if (di < 0.0f)
+                    above.push_back(in[i]);
+                else
+                {
+                    below.push_back(in[i]);
+                    above.push_back(in[i]);
+                }
+            }
+        }
+
+        // Agrega un tramo a una columna ordenada, unindolo con los que se solapan. Si los techos quedan a menos de
+        // 'climb' se conserva la marca transitable de cualquiera de los dos; si no, la del tramo ms alto.
+        static void add_span(std::vector<Span> &column, Span span, int climb)
+        {
+            size_t k = 0;
+            while (k < column.size())
+            {
+                const Span &other = column[k];
+                if (other.max < span.min)
+                {
+                    k++;
+                    continue;
+                }
+                if (other.min > span.max)
+                    break;
+                if (std::abs(span.max - other.max) <= climb)
+                    span.walkable = span.walkable || other.walkable;
+                else if (other.max > span.max)
+                    span.walkable = other.walkable;
+                span.min = std::min(span.min, other.min);
+                span.max = std::max(span.max, other.max);
+                column.erase(column.begin() + k);
+            }
+            column.insert(column.begin() + k, span);
+        }
+
+        static void build_tile(const Context &context, int tile_x, int tile_z, TileResult &result)
+        {
+            PROFILE_ZONE("NavMeshBuilder::build_tile");
+            const NavMeshConfig &config = context.config;
+            const NavMeshParams &params = context.params;
+            const NavMeshInput &input = context.input;
+            int size = context.tile_size + 2 * context.border; // Celdas por lado, con el borde.
+            int base_x = tile_x * context.tile_size - context.border;
+            int base_z = tile_z * context.tile_size - context.border;
+            float cs = config.cell_size, ch = config.cell_height;
+
+            // 1. Voxelizacin: cada tringulo se corta en filas de celdas y cada fila en celdas.
+            std::vector<std::vector<Span>> columns((size_t)size * size);
+            std::vector<glm::vec3> polygon, row, rest, cell, next;
+            for (int t : context.tile_triangles[tile_z * context.tiles_x + tile_x])
+            {
+                glm::vec3 a = input.vertices[input.indices[t]], b = input.vertices[input.indices[t + 1]];
+                glm::vec3 c = input.vertices[input.indices[t + 2]];
+                glm::vec3 normal = glm::cross(b - a, c - a);
+                float length = glm::length(normal);
+                if (length < 1e-12f)
+                    continue;
+                bool walkable = normal.y / length >= context.walkable_normal_y;
+
+                polygon = { a, b, c };
+                float low_z = std::min(a.z, std::min(b.z, c.z)), high_z = std::max(a.z, std::max(b.z, c.z));
+                int z0 = std::max(0, (int)std::floor((low_z - params.origin.z) / cs) - base_z);
+                int z1 = std::min(size - 1, (int)std::floor((high_z - params.origin.z) / cs) - base_z);
+                // Descarta lo que queda antes de la primera fila de la baldosa.
+                split(polygon, params.origin.z + (base_z + z0) * cs, 2, rest, next);
+                polygon.swap(next);
+                for (int z = z0; z <= z1 && polygon.size() >= 3; z++)
+                {
+                    split(polygon, params.origin.z + (base_z + z + 1) * cs, 2, row, rest);
+                    polygon.swap(rest);
+                    if (row.size() < 3)
+                        continue;
+                    float low_x = row[0].x, high_x = row[0].x;
+                    for (const glm::vec3 &v : row)
+                    {
+                        low_x = std::min(low_x, v.x);
+                        high_x = std::max(high_x, v.x);
+                    }
+                    int x0 = std::max(0, (int)std::floor((low_x - params.origin.x) / cs) - base_x);
+                    int x1 = std::min(size - 1, (int)std::floor((high_x - params.origin.x) / cs) - base_x);
+                    split(row, params.origin.x + (base_x + x0) * cs, 0, rest, next);
+                    row.swap(next);
+                    for (int x = x0; x <= x1 && row.size() >= 3; x++)
+                    {
+                        split(row, params.origin.x + (base_x + x + 1) * cs, 0, cell, rest);
+                        row.swap(rest);
+                        if (cell.size() < 3)
+                            continue;
+                        float low_y = cell[0].y, high_y = cell[0].y;
+                        for (const glm::vec3 &v : cell)
+                        {
+                            low_y = std::min(low_y, v.y);
+                            high_y = std::max(high_y, v.y);
+                        }
+                        int span_min = std::max(0, (int)std::floor((low_y - params.origin.y) / ch));
+                        int span_max = std::max(span_min + 1, (int)std::ceil((high_y - params.origin.y) / ch));
+                        add_span(columns[z * size + x], { span_min, span_max, walkable }, context.climb_cells);
+                    }
+                }
+            }
+
+            // 2. Filtros: escalones bajos sobre un piso transitable y altura libre.
+            std::vector<Floor> floors;
+            std::vector<int> column_first((size_t)size * size + 1, 0);
+            for (int i = 0; i < size * size; i++)
+            {
+                std::vector<Span> &spans = columns[i];
+                bool below_walkable = false;
+                int below_max = 0;
+                for (Span &span : spans)
+                {
+                    bool was_walkable = span.walkable;
+                    if (!span.walkable && below_walkable && span.max - below_max <= context.climb_cells)
+                        span.walkable = true;
+                    below_walkable = was_walkable;
+                    below_max = span.max;
+                }
+                column_first[i] = (int)floors.size();
+                for (size_t s = 0; s < spans.size(); s++)
+                {
+                    int ceiling = s + 1 < spans.size() ? spans[s + 1].min : INT_MAX;
+                    if (spans[s].walkable && ceiling - spans[s].max >= context.height_cells)
+                        floors.push_back({ spans[s].max, ceiling, { -1, -1, -1, -1 }, 0, -1, false });
+                }
+            }
+            column_first[size * size] = (int)floors.size();
+
+            // 3. Conexiones con las columnas vecinas y erosin por el radio del agente.
+            const int dx[4] = { -1, 1, 0, 0 }, dz[4] = { 0, 0, -1, 1 };
+            for (int z = 0; z < size; z++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    for (int f = column_first[z * size + x]; f < column_first[z * size + x + 1]; f++)
+                    {
+                        Floor &floor = floors[f];
+                        for (int dir = 0; dir < 4; dir++)
+                        {
+                            int nx = x + dx[dir], nz = z + dz[dir];
+                            if (nx < 0 || nz < 0 || nx >= size || nz >= size)
+                                continue;
+                            int n = nz * size + nx;
+                            for (int g = column_first[n]; g < column_first[n + 1]; g++)
+                            {
+                                const Floor &other = floors[g];
+                                if (std::abs(other.floor - floor.floor) <= context.climb_cells
+                                    && (int64_t)std::min(other.ceiling, floor.ceiling) - std::max(other.floor, floor.floor) >= context.height_cells)
+                                {
+                                    floor.neighbour[dir] = g;
+                                    break;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+            erode(floors, column_first, size, context.radius_cells);
+
+            // 4. Rectngulos sobre las celdas propias de la baldosa (sin el borde).
+            int begin = context.border, end_x = std::min(size, begin + std::min(context.tile_size, params.width - tile_x * context.tile_size));
+            int end_z = std::min(size, begin + std::min(context.tile_size, params.depth - tile_z * context.tile_size));
+            auto usable = [&](int f) { return f >= 0 && !floors[f].removed && floors[f].poly < 0; };
+            std::vector<int> first_row, row_floors, candidate;
+            for (int z = begin; z < end_z; z++)
+            {
+                for (int x = begin; x < end_x; x++)
+                {
+                    for (int f = column_first[z * size + x]; f < column_first[z * size + x + 1]; f++)
+                    {
+                        if (!usable(f))
+                            continue;
+                        // Crece en x mientras el piso siguiente est conectado y libre.
+                        row_floors = { f };
+                        while (x + (int)row_floors.size() < end_x && usable(floors[row_floors.back()].neighbour[1]))
+                            row_floors.push_back(floors[row_floors.back()].neighbour[1]);
+                        int poly_id = (int)result.polys.size();
+                        for (int g : row_floors)
+                            floors[g].poly = poly_id;
+                        first_row = row_floors;
+                        // Crece en z mientras la fila siguiente entera est conectada con esta y entre s.
+                        int height = 1;
+                        while (z + height < end_z)
+                        {
+                            candidate.clear();
+                            for (int g : row_floors)
+                            {
+                                int up = floors[g].neighbour[3];
+                                if (!usable(up))
+                                    break;
+                                if (!candidate.empty() && floors[candidate.back()].neighbour[1] != up)
+                                    break;
+                                candidate.push_back(up);
+                            }
+                            if (candidate.size() != row_floors.size())
+                                break;
+                            for (int g : candidate)
+                                floors[g].poly = poly_id;
+                            row_floors.swap(candidate);
+                            height++;
+                        }
+
+                        NavPoly poly;
+                        poly.x0 = base_x + x;
+                        poly.z0 = base_z + z;
+                        poly.x1 = poly.x0 + (int)row_floors.size();
+                        poly.z1 = poly.z0 + height;
+                        poly.min = { params.origin.x + poly.x0 * cs, params.origin.z + poly.z0 * cs };
+                        poly.max = { params.origin.x + poly.x1 * cs, params.origin.z + poly.z1 * cs };
+                        poly.corner_y[0] = params.origin.y + floors[first_row.front()].floor * ch;
+                        poly.corner_y[1] = params.origin.y + floors[first_row.back()].floor * ch;
+                        poly.corner_y[2] = params.origin.y + floors[row_floors.back()].floor * ch;
+                        poly.corner_y[3] = params.origin.y + floors[row_floors.front()].floor * ch;
+                        result.polys.push_back(poly);
+                    }
+                }
+            }
+
+            // Pisos de las celdas propias, para el ndice por columna de la malla.
+            for (int z = begin; z < end_z; z++)
+            {
+                for (int x = begin; x < end_x; x++)
+                {
+                    int column = (base_z + z) * params.width + base_x + x;
+                    for (int f = column_first[z * size + x]; f < column_first[z * size + x + 1]; f++)
+                    {
+                        const Floor &floor = floors[f];
+                        if (floor.removed || floor.poly < 0)
+                            continue;
+                        float ceiling = floor.ceiling == INT_MAX ? std::numeric_limits<float>::infinity() : params.origin.y + floor.ceiling * ch;
+                        result.cells.push_back({ column, { params.origin.y + floor.floor * ch, ceiling, floor.poly } });
+                    }
+                }
+            }
+        }
+
+        // Quita los pisos a menos de 'radius' celdas de un borde (un piso sin alguno de sus cuatro vecinos). La
+        // distancia se propaga en dos pasadas, hacia adelante y hacia atrs, con pasos rectos y diagonales.
+        static void erode(std::vector<Floor> &floors, const std::vector<int> &column_first, int size, int radius)
+        {
+            for (Floor &floor : floors)
+            {
+                bool edge = false;
+                for (int dir = 0; dir < 4; dir++)
+                    edge |= floor.neighbour[dir] < 0;
+                floor.distance = edge ? 0 : INT_MAX / 2;
+            }
+            auto relax = [&](Floor &floor, int dir, int diagonal_dir) {
+                int n = floor.neighbour[dir];
+                if (n < 0)
+                    return;
+                floor.distance = std::min(floor.distance, floors[n].distance + 2);
+                int d = floors[n].neighbour[diagonal_dir];
+                if (d >= 0)
+                    floor.distance = std::min(floor.distance, floors[d].distance + 3);
+            };
+            for (int z = 0; z < size; z++)
+            {
+                for (int x = 0; x < size; x++)
+                {
+                    for (int f = column_first[z * size + x]; f < column_first[z * size + x + 1]; f++)
+                    {
+                        relax(floors[f], 0, 2); // -x, y desde ah -z.
+                        relax(floors[f], 2, 1); // -z, y desde ah +x.
+                    }
+                }
+            }
+            for (int z = size - 1; z >= 0; z--)
+            {
+                for (int x = size - 1; x >= 0; x--)
+                {
+                    for (int f = column_first[z * size + x]; f < column_first[z * size + x + 1]; f++)
+                    {
+                        relax(floors[f], 1, 3); // +x, y desde ah +z.
+                        relax(floors[f], 3, 0); // +z, y desde ah -x.
+                    }
+                }
+            }
+            for (Floor &floor : floors)
+                floor.removed = floor.distance < radius * 2;
+            for (Floor &floor : floors)
+            {
+                for (int dir = 0; dir < 4; dir++)
+                {
+                    if (floor.neighbour[dir] >= 0 && floors[floor.neighbour[dir]].removed)
+                        floor.neighbour[dir] = -1;
+                }
+            }
+        }
+};
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// Ruido que un enemigo oy: de dnde vino, con qu intensidad le lleg y qu evento fue.
+struct HeardNoise {
+    glm::ivec2 source = { -1, -1 }; // Casilla (fila, columna) donde se produjo.
+    float intensity = 0.0f; // Intensidad restante al llegar, en casillas de alcance.
+    uint32_t event = 0; // Identificador del evento, para reaccionar una sola vez a cada uno.
+};
+
+// NoiseMap propaga por la grilla los ruidos del jugador (pasos, la linterna, la radio) para que los enemigos
+// los oigan. Cada ruido tiene una intensidad medida en casillas de alcance; el sonido avanza por las casillas
+// que no son pared y pierde una casilla de alcance por paso y 'corner_cost' ms por cada giro, as se oye menos
+// a la vuelta de una esquina que en lnea recta.
+// La propagacin es un Dijkstra acotado por 'max_range' sobre estados (casilla, direccin) y se hace al emitir,
+// no al escuchar: su resultado se guarda por casilla de origen y se reutiliza mientras el mapa no cambie.
+// Escuchar es, por cada ruido vigente, una bsqueda binaria en la lista de casillas alcanzadas.
+class NoiseMap {
+    public:
+        float max_range = 12.0f; // Alcance mximo de cualquier ruido, en casillas.
+        float corner_cost = 1.5f; // Alcance que se pierde en cada giro.
+        float memory = 1.0f; // Segundos que un ruido sigue vigente.
+        float footstep = 6.0f; // Intensidad de un paso del jugador.
+        float torch_click = 4.0f; // Intensidad del clic de la linterna.
+        float radio = 10.0f; // Intensidad de la radio encendida.
+
+        // Registra un ruido en la casilla (fila, columna) 'source'. Si ya hay uno vigente en la misma casilla, lo
+        // renueva en vez de agregar otro (la radio encendida emite en cada paso).
+        void emit(const Grid &grid, glm::ivec2 source, float loudness)
+        {
+            if (!grid.in_bounds(source.x, source.y))
+                return;
+            int index = grid.index(source.x, source.y);
+            field(grid, index);
+            for (Event &event : events)
+            {
+                if (event.source == index)
+                {
+                    event.loudness = std::max(event.loudness, std::min(loudness, max_range));
+                    event.age = 0.0f;
+                    return;
+                }
+            }
+            events.push_back({ index, std::min(loudness, max_range), 0.0f, ++next_event });
+        }
+
+        // Envejece los ruidos y descarta los que ya no estn vigentes. Se llama una vez por paso de simulacin.
+        void update(float delta_time)
+        {
+            for (Event &event : events)
+                event.age += delta_time;
+            std::erase_if(events, [this](const Event &event) { return event.age > memory; });
+        }
+
+        // Busca el ruido vigente que llega con ms intensidad a la casilla (fila, columna) 'listener'. Devuelve
+        // falso si no llega ninguno. Si la propagacin de un ruido vigente se descart (invalidate), se recalcula.
+        bool hear(const Grid &grid, glm::ivec2 listener, HeardNoise &heard)
+        {
+            if (!grid.in_bounds(listener.x, listener.y))
+                return false;
+            int index = grid.index(listener.x, listener.y);
+            bool any = false;
+            for (const Event &event : events)
+            {
+                const std::vector<std::pair<int, float>> &reached = field(grid, event.source);
+                auto it = std::lower_bound(reached.begin(), reached.end(), std::make_pair(index, 0.0f));
+                if (it == reached.end() || it->first != index)
+                    continue;
+                float intensity = event.loudness - it->second;
+                if (intensity > 0.0f && (!any || intensity > heard.intensity))
+                {
+                    heard.source = grid.cell(event.source);
+                    heard.intensity = intensity;
+                    heard.event = event.id;
+                    any = true;
+                }
+            }
+            return any;
+        }
+
+        // Descarta las propagaciones guardadas (por ejemplo, al cambiar una casilla del mapa).
+        void invalidate() { fields.clear(); }
+
+        // Descarta tambin los ruidos vigentes.
+        void clear()
+        {
+            fields.clear();
+            events.clear();
+        }
+
+        size_t cached_sources() const { return fields.size(); }
+
+    private:
+        struct Event {
+            int source; // ndice de la casilla de origen en la grilla.
+            float loudness;
+            float age;
+            uint32_t id;
+        };
+
+        std::vector<Event> events;
+        uint32_t next_event = 0;
+        // Por casilla de origen: casillas alcanzadas (ndice en la grilla) con el alcance gastado, ordenadas por ndice.
+        std::unordered_map<int, std::vector<std::pair<int, float>>> fields;
+
+        // Arreglos reutilizados por la propagacin: costo por (casilla, direccin) y la frontera.
+        std::vector<float> cost;
+        std::vector<uint32_t> stamps;
+        std::vector<uint32_t> tile_stamps; // Casillas ya agregadas a la propagacin en curso.
+        uint32_t generation = 0;
+        std::vector<std::pair<float, int>> frontier;
+
+        static constexpr size_t max_cached_sources = 256;
+
+        // Devuelve la propagacin desde 'source', calculndola si no estaba guardada.
+        const std::vector<std::pair<int, float>>& field(const Grid &grid, int source)
+        {
+            auto cached = fields.find(source);
+            if (cached != fields.end())
+                return cached->second;
+            if (fields.size() >= max_cached_sources)
+            {
+                // Se descartan las propagaciones de los orgenes sin ruidos vigentes; las dems se siguen usando.
+                std::erase_if(fields, [this](const auto &entry) {
+                    return std::none_of(events.begin(), events.end(), [&](const Event &event) { return event.source == entry.first; });
+                });
+            }
+            std::vector<std::pair<int, float>> &reached = fields[source];
+            propagate(grid, source, reached);
+            return reached;
+        }
+
+        // Dijkstra acotado sobre estados (casilla, direccin de llegada). El origen parte en las cuatro direcciones.
+        void propagate(const Grid &grid, int source, std::vector<std::pair<int, float>> &reached)
+        {
+            PROFILE_ZONE("NoiseMap::propagate");
+            size_t states = grid.size() * 4;
+            if (stamps.size() != states)
+            {
+                cost.assign(states, 0.0f);
+                stamps.assign(states, 0);
+                tile_stamps.assign(grid.size(), 0);
+                generation = 0;
+            }
+            if (++generation == 0)
+            {
+                std::fill(stamps.begin(), stamps.end(), 0);
+                std::fill(tile_stamps.begin(), tile_stamps.end(), 0);
+                generation = 1;
+            }
+
+            int offsets[4];
+            grid.neighbour_offsets(offsets);
+            auto by_cost = [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a.first > b.first; };
+            frontier.clear();
+            for (int dir = 0; dir < 4; dir++)
+            {
+                cost[source * 4 + dir] = 0.0f;
+                stamps[source * 4 + dir] = generation;
+                frontier.push_back({ 0.0f, source * 4 + dir });
+            }
+            std::make_heap(frontier.begin(), frontier.end(), by_cost);
+
+            reached.clear();
+            while (!frontier.empty())
+            {
+                std::pop_heap(frontier.begin(), frontier.end(), by_cost);
+                auto [state_cost, state] = frontier.back();
+                frontier.pop_back();
+                if (state_cost > cost[state])
+                    continue;
+                int tile = state / 4, dir = state % 4;
+                // Los estados salen en orden de costo: el primero de cada casilla trae su menor costo.
+                if (tile_stamps[tile] != generation)
+                {
+                    tile_stamps[tile] = generation;
+                    reached.push_back({ tile, state_cost });
+                }
+
+                for (int next_dir = 0; next_dir < 4; next_dir++)
+                {
+                    int next = tile + offsets[next_dir];
+                    // El borde Void rodea la grilla: el sonido nunca sale del arreglo.
+                    if (grid.tile_at(next) == Tile::Void || grid.test(Grid::Wall, next))
+                        continue;
+                    float next_cost = state_cost + 1.0f + (tile != source && next_dir != dir ? corner_cost : 0.0f);
+                    if (next_cost > max_range)
+                        continue;
+                    int next_state = next * 4 + next_dir;
+                    if (stamps[next_state] == generation && cost[next_state] <= next_cost)
+                        continue;
+                    stamps[next_state] = generation;
+                    cost[next_state] = next_cost;
+                    frontier.push_back({ next_cost, next_state });
+                    std::push_heap(frontier.begin(), frontier.end(), by_cost);
+                }
+            }
+
+            std::sort(reached.begin(), reached.end());
+        }
+};
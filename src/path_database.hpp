@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "walkable_index.hpp"
+#include "mygl/job_system.hpp"
+#include "mygl/profiler.hpp"
+
+// PathDatabase precalcula, para cada par (origen, destino) de casillas transitables, el primer paso de una
+// ruta mnima: 2 bits (arriba, abajo, izquierda o derecha, en el orden de Grid::neighbour_offsets).
+// Los destinos se numeran en orden de Morton, de modo que destinos cercanos comparten primer paso, y la
+// fila de cada origen se guarda comprimida en tramos (run-length): cada tramo es el ndice del primer
+// destino con su paso. Los destinos inalcanzables no importan y se funden con el tramo anterior.
+// Una ruta se obtiene caminando la tabla paso a paso, sin bsqueda: O(largo de la ruta  log(tramos)).
+// Pensado para mapas chicos y medianos: la construccin hace una bsqueda en anchura por casilla.
+class PathDatabase {
+    public:
+        // Construye la tabla para 'grid', repartiendo los orgenes entre los hilos del JobSystem. Las componentes
+        // conexas salen de 'regions', que debe estar construido sobre la misma grilla. Si el mapa tiene ms de
+        // 'max_tiles' casillas transitables no construye nada y devuelve falso.
+        bool build(const Grid &grid, const WalkableIndex &regions, int max_tiles = 8192)
+        {
+            PROFILE_ZONE("PathDatabase::build");
+            clear();
+            if (!regions.matches(grid))
+                return false;
+            grid.neighbour_offsets(offsets);
+
+            ordinal.assign(grid.size(), -1);
+            for (int i : grid.morton_order())
+            {
+                if (grid.walkable_at(i))
+                {
+                    ordinal[i] = (int)cells.size();
+                    cells.push_back(i);
+                }
+            }
+            int count = (int)cells.size();
+            if (count > max_tiles)
+            {
+                clear();
+                return false;
+            }
+            grid_size = grid.size();
+            neighbours.resize((size_t)count * 4);
+            for (int tile = 0; tile < count; tile++)
+            {
+                for (int i = 0; i < 4; i++)
+                    neighbours[tile * 4 + i] = ordinal[cells[tile] + offsets[i]];
+            }
+            component.resize(count);
+            for (int tile = 0; tile < count; tile++)
+                component[tile] = regions.region_at(cells[tile]);
+
+            std::vector<std::vector<uint32_t>> rows(count);
+            JobSystem::get().parallel_for(0, count, 64, [&](size_t begin, size_t end) {
+                std::vector<uint8_t> moves(count);
+                std::vector<int> frontier(count);
+                for (size_t source = begin; source < end; source++)
+                    build_row((int)source, moves, frontier, rows[source]);
+            });
+
+            row_start.resize(count + 1);
+            for (int source = 0; source < count; source++)
+            {
+                row_start[source] = (uint32_t)runs.size();
+                runs.insert(runs.end(), rows[source].begin(), rows[source].end());
+            }
+            row_start[count] = (uint32_t)runs.size();
+            return true;
+        }
+
+        // Descarta la tabla (por ejemplo, si cambi el mapa).
+        void clear()
+        {
+            cells.clear();
+            ordinal.clear();
+            neighbours.clear();
+            component.clear();
+            row_start.clear();
+            runs.clear();
+            grid_size = 0;
+        }
+
+        // Verdadero si la tabla se construy para una grilla de este tamao.
+        bool matches(const Grid &grid) const { return !cells.empty() && grid_size == grid.size(); }
+
+        // Ruta desde 'start' (excluido) hasta 'goal' (incluido) en 'path'. Devuelve su largo, o 0 si no hay ruta.
+        // 'start' puede no ser transitable (la casilla inicial del enemigo): se sale por el vecino ms cercano a la meta.
+        int find_path(const Grid &grid, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2> &path) const
+        {
+            PROFILE_ZONE("PathDatabase::find_path");
+            path.clear();
+            if (!matches(grid) || !grid.in_bounds(start.x, start.y) || !grid.in_bounds(goal.x, goal.y) || start == goal)
+                return 0;
+            int target = ordinal[grid.index(goal.x, goal.y)];
+            if (target < 0)
+                return 0;
+
+            int source = ordinal[grid.index(start.x, start.y)];
+            if (source < 0)
+            {
+                // Se prueba cada vecino transitable y se queda con el que da la ruta ms corta.
+                int best = -1, best_length = 0;
+                int start_index = grid.index(start.x, start.y);
+                for (int i = 0; i < 4; i++)
+                {
+                    int neighbour = ordinal[start_index + offsets[i]]; // El inicio no tiene nmero: se usa la grilla.
+                    if (neighbour < 0 || component[neighbour] != component[target])
+                        continue;
+                    int length = walk_length(neighbour, target);
+                    if (best < 0 || length < best_length)
+                    {
+                        best = neighbour;
+                        best_length = length;
+                    }
+                }
+                if (best < 0)
+                    return 0;
+                path.push_back(grid.cell(cells[best]));
+                source = best;
+            }
+            else if (component[source] != component[target])
+                return 0;
+
+            for (int current = source; current != target; )
+            {
+                current = neighbours[current * 4 + first_move(current, target)];
+                path.push_back(grid.cell(cells[current]));
+            }
+            return (int)path.size();
+        }
+
+        // Primer paso (ndice en Grid::neighbour_offsets) desde la casilla (fila, columna) 'from' hacia 'to', o
+        // -1 si alguna no es transitable, son la misma o no estn conectadas.
+        int next_move(const Grid &grid, glm::ivec2 from, glm::ivec2 to) const
+        {
+            if (!matches(grid) || !grid.in_bounds(from.x, from.y) || !grid.in_bounds(to.x, to.y))
+                return -1;
+            int source = ordinal[grid.index(from.x, from.y)];
+            int target = ordinal[grid.index(to.x, to.y)];
+            if (source < 0 || target < 0 || source == target || component[source] != component[target])
+                return -1;
+            return first_move(source, target);
+        }
+
+        int tile_count() const { return (int)cells.size(); }
+        size_t run_count() const { return runs.size(); }
+
+        // Memoria ocupada por la tabla comprimida y los ndices auxiliares, en bytes.
+        size_t memory_bytes() const
+        {
+            return runs.size() * sizeof(uint32_t) + row_start.size() * sizeof(uint32_t)
+                + cells.size() * sizeof(int) + ordinal.size() * sizeof(int) + neighbours.size() * sizeof(int)
+                + component.size() * sizeof(int);
+        }
+
+    private:
+        size_t grid_size = 0;
+        int offsets[4] = {};
+        std::vector<int> cells; // ndice en la grilla de cada casilla transitable, en orden de Morton.
+        std::vector<int> ordinal; // Nmero de cada casilla de la grilla en 'cells', o -1.
+        std::vector<int> neighbours; // Nmero de los cuatro vecinos de cada casilla transitable, o -1.
+        std::vector<int> component; // Componente conexa de cada casilla transitable (regin de WalkableIndex).
+        std::vector<uint32_t> row_start; // Primer tramo de cada origen en 'runs'.
+        std::vector<uint32_t> runs; // Tramos: (primer destino << 2) | paso.
+
+        int first_move(int source, int target) const
+        {
+            const uint32_t* begin = runs.data() + row_start[source];
+            const uint32_t* end = runs.data() + row_start[source + 1];
+            const uint32_t* run = std::upper_bound(begin, end, ((uint32_t)target << 2) | 3) - 1;
+            return *run & 3;
+        }
+
+        int walk_length(int source, int target) const
+        {
+            int length = 0;
+            for (int current = source; current != target; length++)
+                current = neighbours[current * 4 + first_move(current, target)];
+            return length;
+        }
+
+        // Bsqueda en anchura desde 'source': cada casilla hereda el primer paso de la casilla desde la que se
+        // alcanz. Luego comprime la fila en tramos.
+        void build_row(int source, std::vector<uint8_t> &moves, std::vector<int> &frontier, std::vector<uint32_t> &row) const
+        {
+            const uint8_t unreached = 0xFF;
+            std::fill(moves.begin(), moves.end(), unreached);
+            moves[source] = 0;
+
+            int head = 0, tail = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                int next = neighbours[source * 4 + i];
+                if (next >= 0 && moves[next] == unreached)
+                {
+                    moves[next] = (uint8_t)i;
+                    frontier[tail++] = next;
+                }
+            }
+            while (head < tail)
+            {
+                int current = frontier[head++];
+                for (int i = 0; i < 4; i++)
+                {
+                    int next = neighbours[current * 4 + i];
+                    if (next >= 0 && moves[next] == unreached)
+                    {
+                        moves[next] = moves[current];
+                        frontier[tail++] = next;
+                    }
+                }
+            }
+
+            // El origen y los destinos inalcanzables aceptan cualquier paso: se unen al tramo en curso.
+            int current_move = -1;
+            for (int target = 0; target < (int)moves.size(); target++)
+            {
+                if (target == source || moves[target] == unreached || moves[target] == current_move)
+                    continue;
+                current_move = moves[target];
+                row.push_back(((uint32_t)(row.empty() ? 0 : target) << 2) | (uint32_t)current_move);
+            }
+            if (row.empty())
+                row.push_back(0);
+        }
+};
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "grid_search.hpp"
+#include "cluster_graph.hpp"
+#include "path_database.hpp"
+#include "path_smoothing.hpp"
+#include "mygl/job_system.hpp"
+#include "mygl/profiler.hpp"
+
+// Calcula en 'path' una ruta de 'start' a 'goal' con el algoritmo indicado y los contextos de bsqueda dados.
+// Devuelve su largo (0 si no hay ruta). Sin tabla precalculada, NextHop se resuelve con GridSearch.
+inline int solve_route(PathAlgorithm algorithm, const Grid &grid, const ClusterGraph &clusters, const PathDatabase &paths,
+    GridSearch &search, ClusterSearch &cluster_search, glm::ivec2 start, glm::ivec2 goal, std::vector<glm::ivec2> &path)
+{
+    if (algorithm == PathAlgorithm::Hierarchical)
+        return cluster_search.find_path(clusters, grid, start, goal, path);
+    if (algorithm == PathAlgorithm::NextHop && paths.matches(grid))
+        return paths.find_path(grid, start, goal, path);
+    return search.find_path(algorithm, grid, start, goal, path);
+}
+
+// Dnde resuelve PathService las bsquedas.
+enum class PathServiceMode {
+    Workers, // En paralelo en los hilos del JobSystem; los resultados llegan en el paso siguiente.
+    TimeSliced // En el hilo principal, con A* por tramos dentro de un presupuesto de tiempo por paso.
+};
+
+// Estadsticas del ltimo lote de un PathService.
+struct PathBatchStats {
+    int requests = 0; // Pedidos recibidos en el paso.
+    int unique = 0; // Bsquedas distintas tras unir los pedidos con igual inicio, meta y algoritmo.
+    double milliseconds = 0.0; // Desde que se despach el lote hasta que termin la ltima bsqueda (por tramos:
+                               // tiempo de bsqueda gastado en el paso).
+};
+
+// PathService resuelve pedidos de rutas de forma asncrona. Durante un paso de simulacin los agentes piden
+// rutas con request y reciben un ticket; al final del paso dispatch une los pedidos repetidos (mismo inicio,
+// meta y algoritmo) y reparte las bsquedas entre los hilos del JobSystem, cada uno con sus contextos de
+// bsqueda propios del hilo. Al comienzo del paso siguiente deliver espera el lote y publica los resultados,
+// que cada agente retira con take. As el hilo principal no paga las bsquedas y los enemigos que piden la
+// misma ruta en el mismo paso comparten una sola.
+// Mientras hay un lote en curso los trabajadores leen la grilla y las estructuras de bsqueda del mapa: antes
+// de modificarlas hay que llamar a invalidate. Todas las funciones se llaman desde el hilo principal.
+// En modo TimeSliced las bsquedas no usan hilos: forman una cola y cada dispatch avanza la primera con A* por
+// tramos de 'expansions_per_slice' casillas hasta agotar 'budget_microseconds', un presupuesto comn a todos
+// los agentes. Una bsqueda larga se reparte entre varios pasos en vez de producir un pico; las rutas de la
+// tabla de primeros pasos (NextHop) se resuelven enseguida porque no buscan. Las dems se resuelven con A*.
+// Con 'any_angle' las rutas se publican ya reducidas a sus puntos de giro, en el mismo trabajo que las busca.
+class PathService {
+    public:
+        using Ticket = uint32_t; // 0 no es un ticket vlido.
+
+        PathServiceMode mode = PathServiceMode::Workers;
+        int expansions_per_slice = 256; // Casillas expandidas entre consultas del reloj (modo TimeSliced).
+        double budget_microseconds = 500.0; // Tiempo de bsqueda por paso para todos los agentes (modo TimeSliced).
+        bool any_angle = true; // Publica las rutas reducidas a sus puntos de giro (ver smooth_path).
+        float clearance = 0.2f; // Radio de los agentes que siguen las rutas, para los tramos rectos (el de Crowd).
+
+        ~PathService() { clear(); }
+
+        // Pide una ruta de 'start' a 'goal'. Se resuelve en el lote del paso en curso.
+        Ticket request(glm::ivec2 start, glm::ivec2 goal, PathAlgorithm algorithm)
+        {
+            if (++next_ticket == 0)
+                next_ticket = 1;
+            pending.push_back({ start, goal, algorithm, next_ticket });
+            return next_ticket;
+        }
+
+        // Si la ruta del ticket ya se public, la deja en 'path' y devuelve su largo (0 si no hay ruta); el ticket
+        // deja de ser vlido. Si todava no est lista, o el ticket no existe, devuelve -1.
+        int take(Ticket ticket, std::vector<glm::ivec2> &path)
+        {
+            auto result = results.find(ticket);
+            if (result == results.end())
+                return -1;
+            path.swap(result->second);
+            results.erase(result);
+            return (int)path.size();
+        }
+
+        // Descarta un pedido o su resultado (por ejemplo, si el agente se destruye antes de retirarlo).
+        void cancel(Ticket ticket)
+        {
+            results.erase(ticket);
+            std::erase_if(pending, [ticket](const Request &request) { return request.ticket == ticket; });
+            std::erase_if(waiting, [ticket](const std::pair<Ticket, int> &wait) { return wait.first == ticket; });
+            for (SlicedQuery &query : sliced)
+                std::erase(query.tickets, ticket);
+        }
+
+        // Espera el lote en curso, si lo hay, y publica sus resultados.
+        void deliver()
+        {
+            if (jobs.empty())
+                return;
+            PROFILE_ZONE("PathService::deliver");
+            JobSystem::get().wait_all(jobs);
+            jobs.clear();
+            for (const auto &[ticket, query] : waiting)
+                results[ticket] = queries[query].path;
+            waiting.clear();
+        }
+
+        // Despacha los pedidos del paso a los hilos trabajadores. Publica antes el lote anterior si segua en curso.
+        void dispatch(const Grid &grid, const ClusterGraph &clusters, const PathDatabase &paths)
+        {
+            deliver();
+            if (mode == PathServiceMode::TimeSliced)
+            {
+                advance_sliced(grid, paths);
+                return;
+            }
+            if (pending.empty())
+                return;
+            PROFILE_ZONE("PathService::dispatch");
+
+            // Une los pedidos iguales: ordenados por (inicio, meta, algoritmo), los repetidos quedan juntos.
+            std::sort(pending.begin(), pending.end(), [](const Request &a, const Request &b) { return key(a) < key(b); });
+            int unique = 0;
+            for (size_t i = 0; i < pending.size(); i++)
+            {
+                if (i == 0 || key(pending[i]) != key(pending[i - 1]))
+                {
+                    if (unique == (int)queries.size())
+                        queries.emplace_back();
+                    Query &query = queries[unique++];
+                    query.start = pending[i].start;
+                    query.goal = pending[i].goal;
+                    query.algorithm = pending[i].algorithm;
+                }
+                waiting.push_back({ pending[i].ticket, unique - 1 });
+            }
+            last_stats.requests = (int)pending.size();
+            last_stats.unique = unique;
+            pending.clear();
+
+            // Un trabajo por bloque de bsquedas; cada bsqueda escribe solo en su propia consulta.
+            auto started = std::chrono::steady_clock::now();
+            const Grid* grid_ptr = &grid;
+            const ClusterGraph* clusters_ptr = &clusters;
+            const PathDatabase* paths_ptr = &paths;
+            const int grain = 4;
+            for (int begin = 0; begin < unique; begin += grain)
+            {
+                int end = std::min(begin + grain, unique);
+                jobs.push_back(JobSystem::get().schedule([this, begin, end, grid_ptr, clusters_ptr, paths_ptr] {
+                    PROFILE_ZONE("PathService::solve");
+                    static thread_local GridSearch search;
+                    static thread_local ClusterSearch cluster_search;
+                    for (int i = begin; i < end; i++)
+                    {
+                        Query &query = queries[i];
+                        solve_route(query.algorithm, *grid_ptr, *clusters_ptr, *paths_ptr, search, cluster_search,
+                            query.start, query.goal, query.path);
+                        if (any_angle)
+                            smooth_path(*grid_ptr, query.start, query.path, clearance);
+                    }
+                }));
+            }
+            jobs.push_back(JobSystem::get().schedule([this, started] {
+                last_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+            }, std::vector<JobHandle>(jobs)));
+        }
+
+        // Espera el lote en curso y reinicia la bsqueda por tramos a medias: llamar antes de cambiar el mapa.
+        void invalidate()
+        {
+            deliver();
+            if (!sliced.empty())
+                sliced.front().started = false;
+        }
+
+        // Espera el lote en curso y descarta todos los pedidos y resultados.
+        void clear()
+        {
+            deliver();
+            pending.clear();
+            sliced.clear();
+            results.clear();
+        }
+
+        // Pedidos an no despachados o en curso.
+        bool busy() const { return !pending.empty() || !jobs.empty() || !sliced.empty(); }
+
+        // Estadsticas del ltimo lote despachado (la duracin es vlida despus de deliver).
+        const PathBatchStats& stats() const { return last_stats; }
+
+    private:
+        struct Request {
+            glm::ivec2 start;
+            glm::ivec2 goal;
+            PathAlgorithm algorithm;
+            Ticket ticket;
+        };
+
+        struct Query {
+            glm::ivec2 start = { 0, 0 };
+            glm::ivec2 goal = { 0, 0 };
+            PathAlgorithm algorithm = PathAlgorithm::Breadth;
+            std::vector<glm::ivec2> path; // Se reutiliza entre lotes.
+        };
+
+        // Clave de orden de un pedido: inicio, meta y algoritmo en 64 bits (filas y columnas menores a 2^15).
+        static uint64_t key(const Request &request)
+        {
+            return ((uint64_t)(request.start.x & 0x7FFF) << 49) | ((uint64_t)(request.start.y & 0x7FFF) << 34)
+                | ((uint64_t)(request.goal.x & 0x7FFF) << 19) | ((uint64_t)(request.goal.y & 0x7FFF) << 4)
+                | (uint64_t)request.algorithm;
+        }
+
+        // Bsqueda en la cola del modo TimeSliced, con los tickets que la esperan.
+        struct SlicedQuery {
+            uint64_t key;
+            glm::ivec2 start;
+            glm::ivec2 goal;
+            PathAlgorithm algorithm;
+            std::vector<Ticket> tickets;
+            bool started = false;
+        };
+
+        std::vector<Request> pending; // Pedidos del paso en curso.
+        std::vector<Query> queries; // Bsquedas distintas del lote en curso.
+        std::vector<std::pair<Ticket, int>> waiting; // Ticket y bsqueda de cada pedido del lote en curso.
+        std::unordered_map<Ticket, std::vector<glm::ivec2>> results; // Rutas publicadas an no retiradas.
+        std::vector<JobHandle> jobs; // Trabajos del lote en curso.
+        std::deque<SlicedQuery> sliced; // Cola del modo TimeSliced; solo la primera est empezada.
+        GridSearch sliced_search; // Contexto de la bsqueda por tramos.
+        Ticket next_ticket = 0;
+        PathBatchStats last_stats;
+
+        // Pasa los pedidos del paso a la cola (uniendo los iguales, tambin con los ya encolados) y avanza las
+        // bsquedas en orden hasta agotar el presupuesto.
+        void advance_sliced(const Grid &grid, const PathDatabase &paths)
+        {
+            last_stats.requests = (int)pending.size();
+            last_stats.unique = 0;
+            for (const Request &request : pending)
+            {
+                uint64_t request_key = key(request);
+                auto same = std::find_if(sliced.begin(), sliced.end(), [request_key](const SlicedQuery &query) { return query.key == request_key; });
+                if (same == sliced.end())
+                {
+                    sliced.push_back({ request_key, request.start, request.goal, request.algorithm, {}, false });
+                    same = sliced.end() - 1;
+                    last_stats.unique++;
+                }
+                same->tickets.push_back(request.ticket);
+            }
+            pending.clear();
+            if (sliced.empty())
+            {
+                last_stats.milliseconds = 0.0;
+                return;
+            }
+
+            PROFILE_ZONE("PathService::advance_sliced");
+            auto started = std::chrono::steady_clock::now();
+            auto deadline = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::micro>(budget_microseconds));
+            std::vector<glm::ivec2> path;
+            while (!sliced.empty())
+            {
+                SlicedQuery &query = sliced.front();
+                SearchStatus status;
+                if (query.tickets.empty())
+                    status = SearchStatus::NotFound; // Todos los pedidos se cancelaron.
+                else if (query.algorithm == PathAlgorithm::NextHop && paths.matches(grid))
+                {
+                    paths.find_path(grid, query.start, query.goal, path);
+                    status = SearchStatus::Found;
+                }
+                else
+                {
+                    if (!query.started)
+                    {
+                        sliced_search.start_astar(grid, query.start, query.goal);
+                        query.started = true;
+                    }
+                    status = sliced_search.advance_astar(grid, expansions_per_slice);
+                    if (status != SearchStatus::Running)
+                        sliced_search.astar_result(grid, path);
+                }
+
+                if (status != SearchStatus::Running)
+                {
+                    if (status == SearchStatus::NotFound)
+                        path.clear();
+                    else if (any_angle)
+                        smooth_path(grid, query.start, path, clearance);
+                    for (Ticket ticket : query.tickets)
+                        results[ticket] = path;
+                    sliced.pop_front();
+                }
+                if (std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+            last_stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+        }
+};
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// Recorre las casillas que cruza el rayo de 'from' a 'to' (posiciones en casillas fila, columna; cada casilla
+// abarca 0.5 alrededor de su centro) y devuelve falso si alguna no es transitable. La casilla de partida no se
+// comprueba: puede ser la inicial del enemigo, que no es transitable.
+inline bool walkable_ray(const Grid &grid, glm::vec2 from, glm::vec2 to)
+{
+    int row = (int)std::round(from.x), col = (int)std::round(from.y);
+    int steps = std::abs((int)std::round(to.x) - row) + std::abs((int)std::round(to.y) - col);
+    glm::vec2 delta = to - from;
+    int row_step = delta.x > 0.0f ? 1 : -1;
+    int col_step = delta.y > 0.0f ? 1 : -1;
+    const float never = std::numeric_limits<float>::infinity();
+    // Fraccin del rayo recorrida hasta el prximo borde de fila y de columna, y lo que avanza por casilla.
+    float next_row = delta.x != 0.0f ? (row + 0.5f * row_step - from.x) / delta.x : never;
+    float next_col = delta.y != 0.0f ? (col + 0.5f * col_step - from.y) / delta.y : never;
+    float row_advance = delta.x != 0.0f ? 1.0f / std::abs(delta.x) : never;
+    float col_advance = delta.y != 0.0f ? 1.0f / std::abs(delta.y) : never;
+    for (; steps > 0; steps--)
+    {
+        if (next_row < next_col)
+        {
+            row += row_step;
+            next_row += row_advance;
+        }
+        else
+        {
+            col += col_step;
+            next_col += col_advance;
+        }
+        if (!grid.walkable(row, col))
+            return false;
+    }
+    return true;
+}
+
+// Verdadero si un agente de radio 'clearance' puede ir en lnea recta de 'from' a 'to' sin pisar casillas no
+// transitables. Adems del rayo central se recorren dos paralelos desplazados 'clearance' a cada lado, que
+// cubren el ancho del agente y las dos casillas de una esquina que el rayo central roza.
+inline bool walkable_segment(const Grid &grid, glm::vec2 from, glm::vec2 to, float clearance)
+{
+    glm::vec2 delta = to - from;
+    float length = glm::length(delta);
+    if (length < 1e-6f)
+        return true;
+    glm::vec2 side = glm::vec2(-delta.y, delta.x) * (clearance / length);
+    return walkable_ray(grid, from, to) && walkable_ray(grid, from + side, to + side)
+        && walkable_ray(grid, from - side, to - side);
+}
+
+// Tira de la ruta como de una cuerda: deja en 'path' (que excluye 'start' e incluye la meta) solo los puntos de
+// giro, de modo que entre cada punto y el siguiente haya un tramo recto transitable para un agente de radio
+// 'clearance'. La meta siempre se conserva. Recorre la ruta una vez, con un tramo comprobado por casilla.
+// Devuelve el nuevo largo.
+inline int smooth_path(const Grid &grid, glm::ivec2 start, std::vector<glm::ivec2> &path, float clearance)
+{
+    PROFILE_ZONE("smooth_path");
+    if (path.size() < 2)
+        return (int)path.size();
+    size_t kept = 0;
+    glm::ivec2 anchor = start;
+    for (size_t i = 0; i + 1 < path.size(); i++)
+    {
+        // Si desde el ltimo punto conservado no se ve el siguiente, la casilla actual es un giro.
+        if (!walkable_segment(grid, anchor, path[i + 1], clearance))
+        {
+            anchor = path[i];
+            path[kept++] = anchor;
+        }
+    }
+    path[kept++] = path.back();
+    path.resize(kept);
+    return (int)kept;
+}
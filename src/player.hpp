@@ -23,13 +23,25 @@ class Player
         Player(Map &map, Sound &sound_manager, float win_width = 800, float win_height = 600) : map(map), sound_manager(sound_manager)
         {
             // Carga sonidos y configura la cmara y la radio.
+            PROFILE_ZONE("Player::Player");
 
             load_sounds();
-            ma_fence_wait(&sound_manager.fence);
+            {
+                PROFILE_ZONE("ma_fence_wait");
+                ma_fence_wait(&sound_manager.fence);
+            }
             player_camera = Camera3D(map.player_position, 860.0f, 520.0f, 1.0f, true);
             radio = new Radio(sound_manager, map.player_position, map.win_position);
         }
 
+        // Destructor: libera los sonidos de pasos y la radio.
+        ~Player()
+        {
+            for (int i = 0; i < 8; i += 1)
+                ma_sound_uninit(&step_sounds[i]);
+            delete radio;
+        }
+
         // Inicializa o reinicia el estado del jugador.
         void init()
         {
@@ -40,20 +52,26 @@ class Player
             radio->listening_time = 0.0f;
             radio->activation_number = 0;
             player_camera.position = map.player_start_position;
+            previous_position = player_camera.position;
             torchlight_on = true;
             map.player_position = map.player_start_position;
         }
 
-        // Actualiza el estado del jugador cada frame.
-        void update()
+        // Guarda la posicin actual antes de avanzar un paso de simulacin (para interpolar al renderizar).
+        void begin_step() { previous_position = player_camera.position; }
+
+        // Devuelve la posicin de la cmara interpolada entre el paso anterior y el actual.
+        glm::vec3 render_position(float alpha) const { return glm::mix(previous_position, player_camera.position, alpha); }
+
+        // Avanza el estado del jugador un paso fijo de simulacin.
+        void update(float delta_time, double time)
         {
-            // Actualiza el reloj, la radio, y verifica condiciones de victoria o muerte.
+            // Actualiza la radio y verifica condiciones de victoria o muerte.
 
-            clock.update();
-            radio->update();
+            radio->update(delta_time);
             if (velocity > 0.0f)
             {
-                player_camera.position.y = headbob(clock.delta_time, clock.current_time) + player_camera.initial_pos.y;
+                player_camera.position.y = headbob(delta_time, time) + player_camera.initial_pos.y;
             }
 
             is_victory();
@@ -61,37 +79,38 @@ class Player
         }
 
         // Actualiza la velocidad del jugador basada en la entrada del teclado.
-        void update_velocity(bool k_pressed)
+        void update_velocity(bool k_pressed, float delta_time)
         {
-            // Ajusta la velocidad del jugador basada en si una tecla est presionada.
+            // La velocidad es la distancia que el jugador avanz de verdad en el paso (en el plano xz): contra una
+            // pared es cero, as no hay balanceo de cabeza ni pasos sin moverse.
 
             if (!k_pressed) {
                 velocity = 0.0f;
             } else {
-                velocity = player_camera.movement_speed * clock.delta_time;
+                glm::vec3 moved = player_camera.position - previous_position;
+                velocity = glm::length(glm::vec2(moved.x, moved.z));
             }
         }
 
         // Procesa la entrada del teclado para mover al jugador.
         void process_keyboard(Camera3D_Movement direction, float delta_time, bool k_pressed)
         {
-            // Mueve al jugador basado en la direccin y detecta colisiones.
-
-            if (collide(direction))
-            {
-                velocity = 0 * delta_time;
-            } else {
-               velocity = player_camera.movement_speed * delta_time; 
-            }
-
-            if (direction == FORWARD)
-                player_camera.position += player_camera.front * velocity;
-            if (direction == BACKWARD)
-                player_camera.position -= player_camera.front * velocity;
-            if (direction == LEFT)
-                player_camera.position -= player_camera.right * velocity;
-            if (direction == RIGHT)
-                player_camera.position += player_camera.right * velocity;
+            // Mueve al jugador basado en la direccin; contra una pared se desliza a lo largo de ella.
+            PROFILE_ZONE("Player::process_keyboard");
+
+            float distance = player_camera.movement_speed * delta_time;
+
+            glm::vec3 delta(0.0f);
+            if (direction == FORWARD) delta = player_camera.front * distance;
+            if (direction == BACKWARD) delta = -player_camera.front * distance;
+            if (direction == LEFT) delta = -player_camera.right * distance;
+            if (direction == RIGHT) delta = player_camera.right * distance;
+
+            glm::vec3 position = map.collision.move(map.grid, player_camera.position, delta, radius);
+            glm::vec3 push = map.prop_push(position, radius); // Las estatuas empujan hacia afuera, sin atravesar paredes.
+            if (push != glm::vec3(0.0f))
+                position = map.collision.move(map.grid, position, push, radius);
+            player_camera.position = position;
             if (player_camera.fps)
                 player_camera.position.y = player_camera.initial_pos.y;
 
@@ -99,10 +118,11 @@ class Player
         }
 
     private:
-        Clock clock; // Reloj para manejar el tiempo.
+        glm::vec3 previous_position = glm::vec3(0.0f); // Posicin al inicio del ltimo paso de simulacin.
         Sound& sound_manager; // Referencia al manejador de sonidos.
         ma_sound step_sounds[8]; // Array de sonidos para los pasos del jugador.
         float velocity; // Velocidad actual del jugador.
+        float radius = 0.11f; // Semilado de la caja de colisin del jugador en el plano xz.
 
         // Archivos de sonido para los pasos del jugador.
         const char *sound_files[8] = {
@@ -129,6 +149,7 @@ class Player
             if (bobbing >= 0.005 && step){ step = false; }
             if (bobbing <= 0.005 && !step) {
                 step = true;
+                map.emit_noise(player_camera.position, map.hearing.footstep);
                 int rand = random_int(0, 7);
                 ma_sound_seek_to_pcm_frame(&step_sounds[rand], 0);
                 ma_sound_start(&step_sounds[rand]);
@@ -140,53 +161,15 @@ class Player
         // Verifica si el jugador ha alcanzado la condicin de victoria.
         void is_victory()
         {
-            // Verifica si la posicin del jugador coincide con la posicin de victoria en el mapa.
-
-            float offset = 0.11f;
-            float min_x = map.win_position.x - 0.4f - offset;
-            float max_x = map.win_position.x + 0.4f + offset;
-            float min_z = map.win_position.z - 0.4f - offset;
-            float max_z = map.win_position.z + 0.4f + offset;
-    
-            if (player_camera.position.x >= min_x && player_camera.position.x <= max_x && player_camera.position.z >= min_z && player_camera.position.z <= max_z)
-            {
+            // Verifica si la caja del jugador toca la de la meta.
+
+            if (map.collision.find_body(player_camera.position, glm::vec2(radius), BodyTag::Goal) != -1)
                 victory = true;
-            }
         }
 
         // Verifica si el jugador est muerto.
         void is_dead() { dead = radio->player_dead; } // Actualiza el estado de muerte del jugador basado en la radio.
 
-        // Detecta colisiones con las paredes del mapa.
-        bool collide(Camera3D_Movement direction)
-        {
-            // Verifica si la posicin futura del jugador colisionara con alguna pared.
-
-            glm::vec3 future_pos = player_camera.position;
-            if (direction == FORWARD) future_pos += player_camera.front * velocity;
-            if (direction == BACKWARD) future_pos -= player_camera.front * velocity;
-            if (direction == LEFT) future_pos -= player_camera.right * velocity;
-            if (direction == RIGHT) future_pos += player_camera.right * velocity;
-
-            for (auto &wall_pos : map.walls_position)
-            {
-                float offset = 0.11f;
-                float min_x = wall_pos.x - 0.5f - offset;
-                float max_x = wall_pos.x + 0.5f + offset;
-                float min_z = wall_pos.z - 0.5f - offset;
-                float max_z = wall_pos.z + 0.5f + offset;
-
-                if (future_pos.x >= min_x &&
-                    future_pos.x <= max_x &&
-                    future_pos.z >= min_z &&
-                    future_pos.z <= max_z)
-                {
-                    return true;
-                }
-            }
-            return false;
-        }
-
         // Carga los sonidos de los pasos del jugador.
         void load_sounds()
         {
@@ -2,8 +2,8 @@
 
 #include <glm/gtc/random.hpp>
 
-#include "mygl/clock.hpp"
 #include "mygl/sound.hpp"
+#include "mygl/profiler.hpp"
 
 class Radio 
 {
@@ -32,14 +32,20 @@ class Radio
             max_activation = random_int(7, 10); // Establece un nmero mximo de activaciones aleatorio entre 7 y 10
         };
 
-        // Funcin que actualiza el estado de la radio
-        void update()
+        // Destructor de la clase Radio: libera los sonidos cargados
+        ~Radio()
+        {
+            for (int i = 0; i < 3; i += 1)
+                ma_sound_uninit(&radio_sounds[i]);
+        }
+
+        // Funcin que actualiza el estado de la radio un paso de simulacin
+        void update(float delta_time)
         {
             if (activation_number > max_activation) game_over(); // Si se supera el nmero mximo de activaciones, el juego termina
-            clock.update(); // Actualiza el reloj
             if (radio_on)
             {
-                listening_time += clock.delta_time; // Aumenta el tiempo de escucha basado en el tiempo delta del reloj
+                listening_time += delta_time; // Aumenta el tiempo de escucha segn la duracin del paso
                 if (listening_time > max_listening_time) { game_over(); } // Si se supera el tiempo mximo de escucha, el juego termina
             }
         }
@@ -84,7 +90,6 @@ class Radio
         }
         
     private:
-        Clock clock; // Reloj para controlar el tiempo
         Sound& sound_manager; // Referencia al gestor de sonidos
         ma_sound radio_sounds[3]; // Array de sonidos de la radio
         const char* sound_files[3] = { // Archivos de sonido para cada estado de distancia
@@ -96,6 +101,7 @@ class Radio
         // Funcin para cargar los sonidos de la radio
         void load_sounds()
         {
+            PROFILE_ZONE("Radio::load_sounds");
             for (int i = 0; i < 3; i += 1)
             {
                 ma_sound_init_from_file(&sound_manager.engine, sound_files[i],
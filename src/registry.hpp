@@ -0,0 +1,224 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+#include "mygl/transform_array.hpp"
+#include "collision_world.hpp"
+
+class Model;
+class MeshBvh;
+
+// Identificador de una entidad: ndice en los arreglos dispersos del Registry. Se reutiliza al destruirla.
+using Entity = uint32_t;
+const Entity NoEntity = UINT32_MAX;
+
+// Componentes. Cada uno vive en su propio arreglo denso dentro del Registry.
+
+// Se dibuja con 'model' (compartido entre todas las entidades del mismo tipo) y la Transform de la entidad.
+struct Renderable {
+    Model* model = nullptr;
+};
+
+// Gira sobre el eje y para mirar al jugador. 'yaw_offset' corrige hacia dnde mira el modelo sin girar.
+struct FacePlayer {
+    float yaw_offset = 0.0f;
+};
+
+// Slido: la malla 'shape' (en el espacio local del modelo) y su cuerpo en el CollisionWorld del mapa.
+struct Collider {
+    MeshBvh* shape = nullptr;
+    int body = -1;
+};
+
+// SparseSet lleva de cada entidad a su posicin en un arreglo denso, sin huecos, y de vuelta. Agregar, quitar
+// y buscar cuestan O(1); al quitar, el ltimo elemento ocupa el hueco. Los pools de componentes guardan sus
+// datos en el mismo orden que 'owners'.
+class SparseSet {
+    public:
+        bool has(Entity entity) const { return entity < sparse.size() && sparse[entity] != NoEntity; }
+        uint32_t index(Entity entity) const { return sparse[entity]; }
+
+        // Recorrido lineal: el elemento i pertenece a la entidad owner(i).
+        size_t size() const { return owners.size(); }
+        Entity owner(size_t i) const { return owners[i]; }
+
+    protected:
+        // Agrega la entidad al final del arreglo denso y devuelve su posicin. No debe estar ya.
+        uint32_t insert(Entity entity)
+        {
+            if (entity >= sparse.size())
+                sparse.resize(entity + 1, NoEntity);
+            sparse[entity] = (uint32_t)owners.size();
+            owners.push_back(entity);
+            return sparse[entity];
+        }
+
+        // Quita la entidad moviendo la ltima a su lugar. Devuelve la posicin que qued libre ('at'); el
+        // llamador mueve ah los datos de la posicin 'last' y luego descarta la ltima.
+        void erase(Entity entity, uint32_t &at, uint32_t &last)
+        {
+            at = sparse[entity];
+            last = (uint32_t)owners.size() - 1;
+            if (at != last)
+            {
+                owners[at] = owners[last];
+                sparse[owners[at]] = at;
+            }
+            owners.pop_back();
+            sparse[entity] = NoEntity;
+        }
+
+        void clear_set()
+        {
+            sparse.clear();
+            owners.clear();
+        }
+
+    private:
+        std::vector<uint32_t> sparse; // Posicin densa de cada entidad, NoEntity si no est.
+        std::vector<Entity> owners; // Entidad de cada posicin densa.
+};
+
+// ComponentPool guarda un tipo de componente contiguo, en el orden de su SparseSet.
+template <typename Component>
+class ComponentPool : public SparseSet {
+    public:
+        Component& add(Entity entity, const Component &component = Component())
+        {
+            if (has(entity))
+                return dense[index(entity)] = component;
+            insert(entity);
+            dense.push_back(component);
+            return dense.back();
+        }
+
+        void remove(Entity entity)
+        {
+            if (!has(entity))
+                return;
+            uint32_t at, last;
+            erase(entity, at, last);
+            if (at != last)
+                dense[at] = dense[last];
+            dense.pop_back();
+        }
+
+        Component& get(Entity entity) { return dense[index(entity)]; }
+        const Component& get(Entity entity) const { return dense[index(entity)]; }
+        Component& operator[](size_t i) { return dense[i]; }
+        const Component& operator[](size_t i) const { return dense[i]; }
+
+        void clear()
+        {
+            clear_set();
+            dense.clear();
+        }
+
+    private:
+        std::vector<Component> dense;
+};
+
+// TransformPool guarda las transformaciones en un TransformArray (arreglos por componente, matrices calculadas
+// en lote solo para las que cambiaron). Se modifican con los set_*; world y normal valen tras update.
+class TransformPool : public SparseSet {
+    public:
+        void add(Entity entity, const Transform &transform)
+        {
+            if (has(entity))
+            {
+                array.set(index(entity), transform);
+                return;
+            }
+            insert(entity);
+            array.add(transform);
+        }
+
+        void remove(Entity entity)
+        {
+            if (!has(entity))
+                return;
+            uint32_t at, last;
+            erase(entity, at, last);
+            array.remove_swap(at);
+        }
+
+        Transform get(Entity entity) const { return array.get(index(entity)); }
+        glm::vec3 position(Entity entity) const { return array.position(index(entity)); }
+        glm::vec3 scale(Entity entity) const { return array.scale(index(entity)); }
+        void set_position(Entity entity, glm::vec3 position) { array.set_position(index(entity), position); }
+        void set_yaw(Entity entity, float yaw) { array.set_yaw(index(entity), yaw); }
+
+        // Recalcula las matrices de las transformaciones que cambiaron desde el ltimo update.
+        void update() { array.update(); }
+        const glm::mat4& world(Entity entity) const { return array.world(index(entity)); }
+        const glm::mat3& normal(Entity entity) const { return array.normal(index(entity)); }
+
+        void clear()
+        {
+            clear_set();
+            array.clear();
+        }
+
+    private:
+        TransformArray array;
+};
+
+// Registry guarda las entidades del mapa (paredes, estatuas, meta) y un arreglo denso por componente.
+// Los sistemas recorren el arreglo del componente que les interesa y buscan los dems por entidad.
+// Para agregar un tipo de objeto al juego alcanza con una fila en la tabla de tipos del mapa; para agregar
+// objetos, con poner su carcter en el archivo de mapa.
+class Registry {
+    public:
+        TransformPool transforms;
+        ComponentPool<Renderable> renderables;
+        ComponentPool<FacePlayer> face_player;
+        ComponentPool<Collider> colliders;
+        CollisionWorld* collision = nullptr; // Mundo donde viven los cuerpos de los Collider.
+
+        Entity create()
+        {
+            if (!free_entities.empty())
+            {
+                Entity entity = free_entities.back();
+                free_entities.pop_back();
+                alive_flags[entity] = true;
+                return entity;
+            }
+            alive_flags.push_back(true);
+            return (Entity)alive_flags.size() - 1;
+        }
+
+        // Destruye la entidad y quita todos sus componentes, y su cuerpo del mundo de colisiones: como los
+        // identificadores se reutilizan, un cuerpo que quedara apuntara a otra entidad.
+        void destroy(Entity entity)
+        {
+            if (!alive(entity))
+                return;
+            if (collision && colliders.has(entity) && colliders.get(entity).body >= 0)
+                collision->remove_body(colliders.get(entity).body);
+            transforms.remove(entity);
+            renderables.remove(entity);
+            face_player.remove(entity);
+            colliders.remove(entity);
+            alive_flags[entity] = false;
+            free_entities.push_back(entity);
+        }
+
+        bool alive(Entity entity) const { return entity < alive_flags.size() && alive_flags[entity]; }
+        size_t count() const { return alive_flags.size() - free_entities.size(); }
+
+        void clear()
+        {
+            transforms.clear();
+            renderables.clear();
+            face_player.clear();
+            colliders.clear();
+            alive_flags.clear();
+            free_entities.clear();
+        }
+
+    private:
+        std::vector<bool> alive_flags;
+        std::vector<Entity> free_entities;
+};
@@ -1,29 +1,23 @@
 #include "texture.hpp"
 #include <stb_image.h> // Incluye la biblioteca stb_image para la carga de imgenes.
+#include "mygl/profiler.hpp" // Zonas de perfilado para medir la carga de recursos.
+#include "mygl/texture_image.hpp" // Imagen decodificada en CPU.
+#include "mygl/job_system.hpp" // Decodificacin en paralelo.
 
-// Funcin para cargar una textura desde un archivo.
-void load_texture(const char* file, unsigned int& texture)
+// Sube una imagen ya decodificada a una textura 2D y libera sus pxeles.
+static void upload_texture(TextureImage &image, unsigned int &texture)
 {
     glGenTextures(1, &texture); // Genera un ID de textura.
 
-    int width, height, nrComponents;
-    // Carga la imagen desde el archivo y obtiene sus dimensiones y el nmero de componentes de color.
-    unsigned char* data = stbi_load(file, &width, &height, &nrComponents, 0);
-    if (data) // Verifica si la imagen se carg correctamente.
+    if (image.data) // Verifica si la imagen se carg correctamente.
     {
-        GLenum format;
         // Determina el formato de la imagen basado en el nmero de componentes de color.
-        if (nrComponents == 1)
-            format = GL_RED; // Imagen en escala de grises.
-        else if (nrComponents == 3)
-            format = GL_RGB; // Imagen RGB.
-        else if (nrComponents == 4)
-            format = GL_RGBA; // Imagen RGBA.
+        GLenum format = image_format(image.components);
 
         // Vincula la textura como una textura 2D.
         glBindTexture(GL_TEXTURE_2D, texture);
         // Carga la imagen en la textura 2D.
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, image.data);
         // Genera mipmaps para la textura.
         glGenerateMipmap(GL_TEXTURE_2D);
 
@@ -32,12 +26,38 @@ void load_texture(const char* file, unsigned int& texture)
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER); // Configura el modo de envoltura T a CLAMP_TO_BORDER.
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // Filtro de minificacin.
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Filtro de magnificacin.
-
-        stbi_image_free(data); // Libera la memoria de la imagen cargada.
     }
     else
     {
-        std::cout << "Texture failed to load at path: " << file << std::endl;
-        stbi_image_free(data); // Libera la memoria de la imagen cargada en caso de error.
+        std::cout << "Texture failed to load at path: " << image.path << std::endl;
     }
+    free_image(image); // Libera la memoria de la imagen cargada.
+}
+
+// Funcin para cargar una textura desde un archivo.
+void load_texture(const char* file, unsigned int& texture)
+{
+    PROFILE_ZONE_TEXT("load_texture", file);
+
+    TextureImage image;
+    image.path = file;
+    // Carga la imagen desde el archivo y obtiene sus dimensiones y el nmero de componentes de color.
+    image.data = stbi_load(file, &image.width, &image.height, &image.components, 0);
+    upload_texture(image, texture);
+}
+
+// Funcin para cargar varias texturas: los archivos se decodifican en paralelo en los hilos
+// trabajadores y luego se suben a la GPU en el hilo principal.
+void load_textures(const std::vector<TextureRequest> &requests, bool flip)
+{
+    PROFILE_ZONE("load_textures");
+
+    std::vector<TextureImage> images(requests.size());
+    JobSystem::get().parallel_for(0, requests.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++)
+            decode_image(requests[i].file, flip, images[i]);
+    });
+
+    for (size_t i = 0; i < requests.size(); i++)
+        upload_texture(images[i], *requests[i].texture);
 }
@@ -1,6 +1,14 @@
 #pragma once
 
 #include <iostream>
+#include <vector>
 #include <glad/glad.h>
 
-void load_texture(const char *file, unsigned int &texture);
\ No newline at end of file
+// Pedido de carga de textura: archivo de origen y destino del ID de textura.
+struct TextureRequest {
+    const char* file;
+    unsigned int* texture;
+};
+
+void load_texture(const char *file, unsigned int &texture);
+void load_textures(const std::vector<TextureRequest> &requests, bool flip);
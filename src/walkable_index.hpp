@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <vector>
+#include <glm/glm.hpp>
+#include "grid.hpp"
+#include "mygl/profiler.hpp"
+
+// WalkableIndex numera las regiones conexas de casillas transitables (4 vecinos) y guarda las casillas de
+// cada regin juntas en un solo arreglo, una regin tras otra. As elegir una casilla al azar, de todo el mapa
+// o de la regin a la que se puede llegar desde una casilla dada, es un ndice aleatorio: O(1) y sin bsquedas
+// que fallen por elegir una meta inalcanzable.
+// Es el etiquetado de regiones del mapa: PathDatabase toma de aqu las suyas (ver region_at).
+class WalkableIndex {
+    public:
+        // Etiqueta las regiones de 'grid'. Recorre cada casilla una vez.
+        void build(const Grid &grid)
+        {
+            PROFILE_ZONE("WalkableIndex::build");
+            source = &grid;
+            grid.neighbour_offsets(offsets);
+            labels.assign(grid.size(), -1);
+            tiles.clear();
+            region_start.clear();
+
+            for (int row = 0; row < grid.rows(); row++)
+            {
+                for (int col = 0; col < grid.cols(); col++)
+                {
+                    int seed = grid.index(row, col);
+                    if (!grid.walkable_at(seed) || labels[seed] >= 0)
+                        continue;
+
+                    // Las casillas de la regin se agregan a 'tiles' al etiquetarlas y ese mismo tramo sirve de frontera FIFO.
+                    int region = (int)region_start.size();
+                    region_start.push_back((int)tiles.size());
+                    labels[seed] = region;
+                    tiles.push_back(seed);
+                    for (size_t head = region_start.back(); head < tiles.size(); head++)
+                    {
+                        for (int i = 0; i < 4; i++)
+                        {
+                            int next = tiles[head] + offsets[i];
+                            // El borde de la grilla no es transitable, as que 'next' nunca sale del arreglo.
+                            if (grid.walkable_at(next) && labels[next] < 0)
+                            {
+                                labels[next] = region;
+                                tiles.push_back(next);
+                            }
+                        }
+                    }
+                }
+            }
+            region_start.push_back((int)tiles.size());
+        }
+
+        void clear()
+        {
+            source = nullptr;
+            labels.clear();
+            tiles.clear();
+            region_start.clear();
+        }
+
+        int region_count() const { return region_start.empty() ? 0 : (int)region_start.size() - 1; }
+        int tile_count() const { return (int)tiles.size(); }
+        int region_size(int region) const { return region_start[region + 1] - region_start[region]; }
+
+        // Regin de la casilla de ndice 'index' en la grilla (ver Grid::index), o -1 si no es transitable.
+        int region_at(int index) const { return labels[index]; }
+
+        // Verdadero si las regiones se etiquetaron sobre 'grid' tal como est ahora.
+        bool matches(const Grid &grid) const { return source == &grid && labels.size() == grid.size(); }
+
+        // Regin de la casilla (fila, columna), o -1. Una casilla no transitable (como la inicial del enemigo)
+        // pertenece a la regin de su vecino transitable ms grande, que es a donde se puede salir desde ella.
+        int region_of(glm::ivec2 cell) const
+        {
+            if (source == nullptr || !source->in_bounds(cell.x, cell.y))
+                return -1;
+            int index = source->index(cell.x, cell.y);
+            if (labels[index] >= 0)
+                return labels[index];
+            int best = -1;
+            for (int i = 0; i < 4; i++)
+            {
+                int region = labels[index + offsets[i]];
+                if (region >= 0 && (best < 0 || region_size(region) > region_size(best)))
+                    best = region;
+            }
+            return best;
+        }
+
+        // Verdadero si hay una ruta entre las dos casillas.
+        bool connected(glm::ivec2 a, glm::ivec2 b) const
+        {
+            int region = region_of(a);
+            return region >= 0 && region == region_of(b);
+        }
+
+        // Casilla transitable al azar de todo el mapa. Devuelve {-1, -1} si no hay ninguna.
+        template <typename Random>
+        glm::ivec2 random_tile(Random &random) const
+        {
+            if (tiles.empty())
+                return { -1, -1 };
+            return source->cell(tiles[std::uniform_int_distribution<int>(0, (int)tiles.size() - 1)(random)]);
+        }
+
+        // Casilla transitable al azar alcanzable desde 'from'. Devuelve {-1, -1} si desde 'from' no se llega a ninguna.
+        template <typename Random>
+        glm::ivec2 random_reachable(glm::ivec2 from, Random &random) const
+        {
+            int region = region_of(from);
+            if (region < 0)
+                return { -1, -1 };
+            int pick = std::uniform_int_distribution<int>(region_start[region], region_start[region + 1] - 1)(random);
+            return source->cell(tiles[pick]);
+        }
+
+    private:
+        const Grid* source = nullptr; // Grilla etiquetada en el ltimo build.
+        int offsets[4] = {};
+        std::vector<int> labels; // Regin de cada casilla de la grilla, o -1.
+        std::vector<int> tiles; // ndices de las casillas transitables, agrupados por regin.
+        std::vector<int> region_start; // Primera casilla de cada regin en 'tiles' (ms una entrada final).
+};